@@ -0,0 +1,144 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+// C++ Standard Library
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+using namespace OpenNos;
+
+BenchmarkRunner::State::State(const size_t iterations)
+    : _iterations { iterations } {
+    _samplesNs.reserve(iterations);
+}
+
+void BenchmarkRunner::State::start() {
+    _startedAt = std::chrono::steady_clock::now();
+}
+
+void BenchmarkRunner::State::stop() {
+    addSample(std::chrono::steady_clock::now() - _startedAt);
+}
+
+void BenchmarkRunner::State::setMetric(const std::string& name, const double value) {
+    _metrics[name] = value;
+}
+
+void BenchmarkRunner::State::addSample(const std::chrono::nanoseconds sample) {
+    _samplesNs.push_back(sample.count());
+}
+
+BenchmarkRunner::BenchmarkRunner(const std::string& filter)
+    : _filter { filter } {
+    // Nothing more to do
+}
+
+void BenchmarkRunner::run(const std::string& name, const std::vector<Parameters>& parametersSet,
+                          const size_t iterations, const Case& benchmarkCase) {
+    if ((not _filter.empty()) && (name.find(_filter) == std::string::npos)) {
+        return;
+    }
+
+    for (const auto& parameters : parametersSet) {
+        State state { iterations };
+        benchmarkCase(state, parameters);
+        auto& samples = state._samplesNs;
+        if (samples.empty()) {
+            continue;
+        }
+
+        std::sort(std::begin(samples), std::end(samples));
+        Result result {};
+        result.name = name;
+        result.parameters = parameters;
+        result.iterations = samples.size();
+        for (const auto sample : samples) {
+            result.totalNs += sample;
+        }
+
+        result.minNs = samples.front();
+        result.p50Ns = samples[samples.size() / 2];
+        result.p99Ns = samples[std::min(samples.size() - 1, (samples.size() * 99) / 100)];
+        result.maxNs = samples.back();
+        result.metrics = std::move(state._metrics);
+        std::cerr << name << ": p50 " << result.p50Ns << " ns, p99 " << result.p99Ns << " ns" << std::endl;
+        _results.emplace_back(std::move(result));
+    }
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out) const {
+    out << "{\n  \"benchmarks\": [";
+    bool firstResult = true;
+    for (const auto& result : _results) {
+        out << (firstResult ? "\n" : ",\n");
+        firstResult = false;
+        out << "    { \"name\": \"" << result.name << "\", \"parameters\": {";
+        bool firstParameter = true;
+        for (const auto& parameter : result.parameters) {
+            out << (firstParameter ? " " : ", ") << "\"" << parameter.first << "\": " << parameter.second;
+            firstParameter = false;
+        }
+
+        out << " }, \"iterations\": " << result.iterations
+            << ", \"mean_ns\": " << (result.totalNs / static_cast<int64_t>(result.iterations))
+            << ", \"min_ns\": " << result.minNs
+            << ", \"p50_ns\": " << result.p50Ns
+            << ", \"p99_ns\": " << result.p99Ns
+            << ", \"max_ns\": " << result.maxNs
+            << ", \"metrics\": {";
+        bool firstMetric = true;
+        for (const auto& metric : result.metrics) {
+            out << (firstMetric ? " " : ", ") << "\"" << metric.first << "\": " << metric.second;
+            firstMetric = false;
+        }
+
+        out << " } }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+size_t BenchmarkRunner::getResidentMemory() {
+    std::ifstream statm { "/proc/self/statm" };
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    statm >> totalPages >> residentPages;
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/// Usage: ControlPlaneBenchmark [filter] [output.json]
+int main(int argc, char* argv[]) {
+    BenchmarkRunner runner { argc > 1 ? argv[1] : "" };
+    registerCommandManagerBenchmarks(runner);
+    registerCommitBenchmarks(runner);
+    registerObserverBenchmarks(runner);
+    registerHandleLookupBenchmarks(runner);
+    registerLinkScanBenchmarks(runner);
+    registerPortBringUpBenchmarks(runner);
+    registerPortMappingBenchmarks(runner);
+    registerVlanBenchmarks(runner);
+    if (argc > 2) {
+        std::ofstream out { argv[2] };
+        runner.writeJson(out);
+    } else {
+        runner.writeJson(std::cout);
+    }
+
+    return 0;
+}
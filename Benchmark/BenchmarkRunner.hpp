@@ -0,0 +1,99 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+// C++ Standard Library
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace OpenNos {
+
+/// Runs control plane microbenchmarks and reports results as JSON, so they can be compared
+/// between releases by scripts. Benchmark executable is linked with Simulator/OpenNslSimulator.cpp
+/// in place of OpenNSL library.
+class BenchmarkRunner final {
+  public:
+    using Parameters = std::map<std::string, int64_t>;
+    using Metrics = std::map<std::string, double>;
+
+    /// Context of one benchmark case. Case measures only code between start() and stop().
+    class State {
+      public:
+        explicit State(const size_t iterations);
+        size_t getIterations() const { return _iterations; }
+        void start();
+        void stop();
+        /// Adds custom result, e.g. SDK calls count or resident memory
+        void setMetric(const std::string& name, const double value);
+        /// Adds externally measured sample, e.g. latency recorded in other thread
+        void addSample(const std::chrono::nanoseconds sample);
+
+      private:
+        friend class BenchmarkRunner;
+        size_t _iterations;
+        std::chrono::steady_clock::time_point _startedAt;
+        std::vector<int64_t> _samplesNs;
+        Metrics _metrics;
+    };
+
+    using Case = std::function<void(State& state, const Parameters& parameters)>;
+
+    explicit BenchmarkRunner(const std::string& filter = "");
+    /// Runs @p benchmarkCase for each of @p parametersSet
+    void run(const std::string& name, const std::vector<Parameters>& parametersSet,
+             const size_t iterations, const Case& benchmarkCase);
+    void writeJson(std::ostream& out) const;
+
+    /// Returns resident set size of current process
+    static size_t getResidentMemory();
+
+  private:
+    struct Result {
+        std::string name;
+        Parameters parameters;
+        size_t iterations;
+        int64_t totalNs;
+        int64_t minNs;
+        int64_t p50Ns;
+        int64_t p99Ns;
+        int64_t maxNs;
+        Metrics metrics;
+    };
+
+    std::string _filter;
+    std::vector<Result> _results;
+};
+
+/// Prevents compiler from optimizing out computed value
+template <typename TYPE>
+inline void doNotOptimize(const TYPE& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void registerCommandManagerBenchmarks(BenchmarkRunner& runner);
+void registerCommitBenchmarks(BenchmarkRunner& runner);
+void registerObserverBenchmarks(BenchmarkRunner& runner);
+void registerHandleLookupBenchmarks(BenchmarkRunner& runner);
+void registerLinkScanBenchmarks(BenchmarkRunner& runner);
+void registerPortBringUpBenchmarks(BenchmarkRunner& runner);
+void registerPortMappingBenchmarks(BenchmarkRunner& runner);
+void registerVlanBenchmarks(BenchmarkRunner& runner);
+
+} // namespace OpenNos
@@ -0,0 +1,119 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Command.hpp"
+#include "Types.hpp"
+
+// C++ Standard Library
+#include <memory>
+
+using namespace OpenNos;
+
+namespace {
+
+class BenchmarkVlan final {
+  public:
+    explicit BenchmarkVlan(const VlanId vid) : _vid { vid } { /* Nothing more to do */ }
+    VlanId id() const { return _vid; }
+
+  private:
+    VlanId _vid;
+};
+
+template <typename STORAGE>
+class BenchmarkVlanManager final : public CommandManager<BenchmarkVlan, VlanId, STORAGE> {
+  public:
+    using Base = CommandManager<BenchmarkVlan, VlanId, STORAGE>;
+    using Base::execute;
+    using Base::undo;
+};
+
+enum class Storage : int64_t {
+    Ordered,
+    Dense
+};
+
+template <typename STORAGE>
+void runExecuteAndUndo(BenchmarkRunner::State& state, const VlanId vlansCount, const bool measureUndo) {
+    ResultCallback::Handle callback = gNullResultCallback;
+    const size_t residentMemoryBefore = BenchmarkRunner::getResidentMemory();
+    BenchmarkVlanManager<STORAGE> manager {};
+    for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+        for (VlanId vid = 1; vid <= vlansCount; ++vid) {
+            manager.add(vid);
+        }
+
+        if (not measureUndo) {
+            state.start();
+        }
+
+        manager.execute(callback);
+        if (not measureUndo) {
+            state.stop();
+        }
+
+        if (measureUndo) {
+            state.start();
+        }
+
+        manager.undo(callback);
+        if (measureUndo) {
+            state.stop();
+        }
+    }
+
+    for (VlanId vid = 1; vid <= vlansCount; ++vid) {
+        manager.add(vid);
+    }
+
+    manager.execute(callback);
+    state.setMetric("resident_bytes_delta",
+                    static_cast<double>(BenchmarkRunner::getResidentMemory()) - static_cast<double>(residentMemoryBefore));
+}
+
+std::vector<BenchmarkRunner::Parameters> getStorageAndVlansCountParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const auto storage : { Storage::Ordered, Storage::Dense }) {
+        for (const int64_t vlansCount : { 1, 64, 512, 1024, 4094 }) {
+            parametersSet.push_back({ { "storage", static_cast<int64_t>(storage) }, { "vlans", vlansCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+void runCase(BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters, const bool measureUndo) {
+    const auto vlansCount = static_cast<VlanId>(parameters.at("vlans"));
+    if (static_cast<int64_t>(Storage::Dense) == parameters.at("storage")) {
+        runExecuteAndUndo<DenseCommandStorage<MaxVlans>>(state, vlansCount, measureUndo);
+    } else {
+        runExecuteAndUndo<OrderedCommandStorage>(state, vlansCount, measureUndo);
+    }
+}
+
+} // namespace
+
+/// Measures commit and rollback of VLAN set; storage: 0 - ordered, 1 - dense
+void OpenNos::registerCommandManagerBenchmarks(BenchmarkRunner& runner) {
+    runner.run("CommandManager.execute", getStorageAndVlansCountParameters(), 200,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   runCase(state, parameters, false);
+               });
+    runner.run("CommandManager.undo", getStorageAndVlansCountParameters(), 200,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   runCase(state, parameters, true);
+               });
+}
@@ -0,0 +1,165 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Asic.hpp"
+#include "CommitScheduler.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwVlan.hpp"
+#include "Simulator/OpenNslSimulator.hpp"
+
+// C++ Standard Library
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace OpenNos;
+
+namespace {
+
+constexpr int PushedPortsCount = 128;
+constexpr VlanId PushedVlansCount = 2048;
+
+std::vector<BenchmarkRunner::Parameters> getBatchSizeParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t batchVlans : { int64_t { 1 }, int64_t { 16 }, int64_t { 256 }, int64_t { PushedVlansCount } }) {
+        parametersSet.push_back({ { "batch_vlans", batchVlans } });
+    }
+
+    return parametersSet;
+}
+
+/// Each VLAN of config push is created and gets all ports as tagged members. Commands of VLAN are added
+/// member ports first, scheduler has to put creation of VLAN before them.
+void addVlanCommands(CommitScheduler& commitScheduler, const VlanId vid) {
+    VlanMemberPorts memberPorts {};
+    memberPorts.tagged.setRange(1, PushedPortsCount);
+    commitScheduler.addCommand(std::make_shared<HwVlanMemberPortsSetting>(
+                                   std::vector<HwVlanMemberPortsSetting::Change> { { vid, VlanMemberPorts {}, memberPorts } }));
+    VlanBitmap vids {};
+    vids.set(vid);
+    commitScheduler.addCommand(std::make_shared<HwVlanRangeSetting>(HwVlanRangeSetting::Action::Create, vids));
+}
+
+/// Counts its executions, so commands lost by ASIC thread can be detected
+class CountedCommand final : public Command {
+  public:
+    explicit CountedCommand(std::atomic<uint64_t>& executedCount) : _executedCount { executedCount } {
+        // Nothing more to do
+    }
+
+    virtual ~CountedCommand() override = default;
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        _executedCount.fetch_add(1, std::memory_order_relaxed);
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+  private:
+    std::atomic<uint64_t>& _executedCount;
+};
+
+} // namespace
+
+/// Config push of 128 ports and 2048 VLANs, split into commits of batch_vlans VLANs. Each commit is
+/// ordered into levels by CommitScheduler and passed to running ASIC thread, whose result is waited for.
+void OpenNos::registerCommitBenchmarks(BenchmarkRunner& runner) {
+    runner.run("CommitScheduler.configPush", getBatchSizeParameters(), 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const auto batchVlans = static_cast<VlanId>(parameters.at("batch_vlans"));
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   hwCommandProcessor->start();
+                   size_t levelsCount = 0;
+                   size_t commitsCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       simulator.reset();
+                       simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), PushedPortsCount);
+                       levelsCount = 0;
+                       commitsCount = 0;
+                       state.start();
+                       for (VlanId firstVid = 2; firstVid <= PushedVlansCount + 1; firstVid = static_cast<VlanId>(firstVid + batchVlans)) {
+                           auto commitScheduler = std::make_shared<CommitScheduler>();
+                           const auto lastVid = static_cast<VlanId>(std::min<int>(firstVid + batchVlans - 1, PushedVlansCount + 1));
+                           for (VlanId vid = firstVid; vid <= lastVid; ++vid) {
+                               addVlanCommands(*commitScheduler, vid);
+                           }
+
+                           std::vector<CommitScheduler::ExecutionLevel> levels {};
+                           commitScheduler->getExecutionLevels(levels);
+                           levelsCount += levels.size();
+                           ++commitsCount;
+                           hwCommandProcessor->executeAndWait(commitScheduler);
+                       }
+
+                       state.stop();
+                   }
+
+                   hwCommandProcessor->stop();
+                   state.setMetric("commits", static_cast<double>(commitsCount));
+                   state.setMetric("levels_per_commit", static_cast<double>(levelsCount) / static_cast<double>(commitsCount));
+                   state.setMetric("sdk_calls", static_cast<double>(simulator.getTotalCallsCount()));
+               });
+
+    // Producers enqueue while configuration thread calls execute(), only ASIC thread can pop commands
+    std::vector<BenchmarkRunner::Parameters> producersParametersSet {};
+    for (const int64_t producersCount : { 1, 4 }) {
+        producersParametersSet.push_back({ { "commands", 100000 }, { "producers", producersCount } });
+    }
+
+    runner.run("HwCommandProcessor.concurrentProducers", producersParametersSet, 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const auto commandsCount = static_cast<uint64_t>(parameters.at("commands"));
+                   const auto producersCount = static_cast<size_t>(parameters.at("producers"));
+                   uint64_t lostCommands = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                       std::atomic<uint64_t> executedCount { 0 };
+                       std::atomic<uint64_t> enqueuedCount { 0 };
+                       std::atomic<bool> producing { true };
+                       hwCommandProcessor->start();
+                       state.start();
+                       std::vector<std::thread> producers {};
+                       for (size_t producer = 0; producer < producersCount; ++producer) {
+                           producers.emplace_back([&] {
+                               for (uint64_t command = 0; command < commandsCount / producersCount; ++command) {
+                                   if (not Result::Failed(hwCommandProcessor->addCommandToExecute(std::make_shared<CountedCommand>(executedCount)))) {
+                                       enqueuedCount.fetch_add(1, std::memory_order_relaxed);
+                                   }
+                               }
+                           });
+                       }
+
+                       std::thread configuring { [&] {
+                           while (producing.load(std::memory_order_acquire)) {
+                               hwCommandProcessor->execute();
+                           }
+                       } };
+                       for (auto& producer : producers) {
+                           producer.join();
+                       }
+
+                       producing.store(false, std::memory_order_release);
+                       configuring.join();
+                       hwCommandProcessor->stop();
+                       state.stop();
+                       lostCommands += enqueuedCount.load() - executedCount.load();
+                   }
+
+                   state.setMetric("lost_commands", static_cast<double>(lostCommands));
+               });
+}
@@ -0,0 +1,198 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Asic.hpp"
+#include "HwCommandProcessor.hpp"
+#include "LagManager.hpp"
+#include "PortManager.hpp"
+#include "Simulator/OpenNslSimulator.hpp"
+#include "Vlan.hpp"
+#include "VlanManager.hpp"
+#include "VlanMemberPortManager.hpp"
+
+extern "C" {
+#   include <opennsl/vlan.h>
+}
+
+// C++ Standard Library
+#include <memory>
+#include <random>
+
+using namespace OpenNos;
+
+namespace {
+
+constexpr size_t LookupsPerIteration = 1024;
+
+std::vector<BenchmarkRunner::Parameters> getPortsAndVlansCountParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t portsCount : { 32, 64, 128, 512 }) {
+        for (const int64_t vlansCount : { 1, 64, 1024, 4094 }) {
+            parametersSet.push_back({ { "ports", portsCount }, { "vlans", vlansCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getVlansCountParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t vlansCount : { 64, 1024, 4094 }) {
+        parametersSet.push_back({ { "vlans", vlansCount } });
+    }
+
+    return parametersSet;
+}
+
+/// Random order of indexes which are resolved by one iteration
+std::vector<size_t> getLookupOrder(const size_t indexesCount) {
+    std::mt19937 generator { 0 };
+    std::uniform_int_distribution<size_t> index { 0, indexesCount - 1 };
+    std::vector<size_t> lookupOrder(LookupsPerIteration);
+    for (auto& lookupIndex : lookupOrder) {
+        lookupIndex = index(generator);
+    }
+
+    return lookupOrder;
+}
+
+/// VIDs 2..vlans+1, which are created by VlanManager, default VLAN is never created
+std::vector<VlanId> getVids(const int64_t vlansCount) {
+    std::vector<VlanId> vids {};
+    for (int64_t vid = 2; vid <= vlansCount + 1; ++vid) {
+        vids.push_back(static_cast<VlanId>(vid));
+    }
+
+    return vids;
+}
+
+} // namespace
+
+/// Lookups which managers do on each link change and commit, measured on real VLAN objects:
+/// member ports are looked up in committed membership table of VlanMemberPortManager and VLANs
+/// are resolved by generational handles of VlanManager. Resolving of weak pointers to the same
+/// VLAN objects is kept as the baseline which generational handles replaced.
+void OpenNos::registerHandleLookupBenchmarks(BenchmarkRunner& runner) {
+    runner.run("VlanMemberPortManager.isMemberPort", getPortsAndVlansCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(parameters.at("ports")));
+                   const auto vids = getVids(parameters.at("vlans"));
+                   for (const auto vid : vids) {
+                       opennsl_vlan_create(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid));
+                   }
+
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto manager = std::make_shared<VlanMemberPortManager>(hwCommandProcessor);
+                   VlanBitmap vlans {};
+                   vlans.setRange(vids.front(), vids.back());
+                   // Ports are numbered from 1, so the last one of "ports" doesn't fit into port bitmap
+                   const auto lastPortNo = static_cast<PortId>(parameters.at("ports") - 1);
+                   VlanMemberPorts ports {};
+                   ports.tagged.setRange(1, lastPortNo);
+                   manager->addMemberPorts(vlans, ports);
+                   manager->execute();
+                   hwCommandProcessor->execute();
+
+                   const auto& memberPorts = manager->getCommittedMemberPorts();
+                   const auto vlanLookupOrder = getLookupOrder(vids.size());
+                   const auto portLookupOrder = getLookupOrder(lastPortNo);
+                   size_t foundMemberPorts = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       foundMemberPorts = 0;
+                       state.start();
+                       for (size_t lookupNo = 0; lookupNo < LookupsPerIteration; ++lookupNo) {
+                           const auto portNo = static_cast<PortId>(portLookupOrder[lookupNo] + 1);
+                           foundMemberPorts += memberPorts.isMemberPort(vids[vlanLookupOrder[lookupNo]], portNo) ? 1 : 0;
+                       }
+
+                       state.stop();
+                       doNotOptimize(foundMemberPorts);
+                   }
+
+                   state.setMetric("lookups", static_cast<double>(LookupsPerIteration));
+                   state.setMetric("missing_member_ports", static_cast<double>(LookupsPerIteration - foundMemberPorts));
+               });
+
+    runner.run("WeakHandle.resolve", getVlansCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   std::vector<std::shared_ptr<Vlan>> vlans {};
+                   for (const auto vid : getVids(parameters.at("vlans"))) {
+                       vlans.push_back(std::make_shared<Vlan>(vid));
+                   }
+
+                   const std::vector<std::weak_ptr<Vlan>> handles(vlans.begin(), vlans.end());
+                   const auto lookupOrder = getLookupOrder(handles.size());
+                   size_t vidsSum = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       for (const auto index : lookupOrder) {
+                           if (auto vlan = handles[index].lock()) {
+                               vidsSum += vlan->id();
+                           }
+                       }
+
+                       state.stop();
+                       doNotOptimize(vidsSum);
+                   }
+
+                   state.setMetric("lookups", static_cast<double>(LookupsPerIteration));
+               });
+
+    runner.run("SlotHandle.resolve", getVlansCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto portManager = std::make_shared<PortManager>();
+                   auto lagManager = std::make_shared<LagManager>(portManager);
+                   auto manager = std::make_shared<VlanManager>(portManager, lagManager, hwCommandProcessor);
+                   hwCommandProcessor->execute();
+                   const auto vids = getVids(parameters.at("vlans"));
+                   VlanBitmap vlans {};
+                   vlans.setRange(vids.front(), vids.back());
+                   manager->addRange(vlans);
+                   manager->execute();
+                   hwCommandProcessor->execute();
+
+                   std::vector<VlanHandle> handles {};
+                   for (const auto vid : vids) {
+                       handles.push_back(manager->getHandle(vid));
+                   }
+
+                   const auto lookupOrder = getLookupOrder(handles.size());
+                   size_t vidsSum = 0;
+                   size_t unresolvedHandles = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       for (const auto index : lookupOrder) {
+                           if (auto vlan = manager->get(handles[index])) {
+                               vidsSum += vlan->id();
+                           }
+                           else {
+                               ++unresolvedHandles;
+                           }
+                       }
+
+                       state.stop();
+                       doNotOptimize(vidsSum);
+                   }
+
+                   state.setMetric("lookups", static_cast<double>(LookupsPerIteration));
+                   state.setMetric("unresolved_handles", static_cast<double>(unresolvedHandles));
+               });
+}
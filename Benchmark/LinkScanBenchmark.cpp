@@ -0,0 +1,586 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Asic.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwPortManager.hpp"
+#include "LatencyTracer.hpp"
+#include "PortManager.hpp"
+#include "Simulator/OpenNslSimulator.hpp"
+#include "VlanLinkStatusHandling.hpp"
+
+extern "C" {
+#   include <opennsl/link.h>
+#   include <opennsl/vlan.h>
+}
+
+// C++ Standard Library
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace OpenNos;
+
+namespace {
+
+std::vector<BenchmarkRunner::Parameters> getPortsCountParameters() {
+    return { { { "ports", 32 } }, { { "ports", 64 } }, { { "ports", 128 } }, { { "ports", 512 } } };
+}
+
+std::vector<BenchmarkRunner::Parameters> getDampeningParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t dampening : { 0, 1 }) {
+        for (const int64_t vlansCount : { 1, 64, 1024 }) {
+            parametersSet.push_back({ { "dampening", dampening }, { "vlans", vlansCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getFdbFlushingParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t batched : { 0, 1 }) {
+        for (const int64_t portsCount : { 32, 128, 512 }) {
+            for (const int64_t lagMembersCount : { 0, 4 }) {
+                parametersSet.push_back({ { "batched", batched }, { "ports", portsCount }, { "lag_members", lagMembersCount } });
+            }
+        }
+    }
+
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getTracingParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t tracing : { 0, 1 }) {
+        for (const int64_t portsCount : { 32, 128, 512 }) {
+            parametersSet.push_back({ { "tracing", tracing }, { "ports", portsCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getLinkEventBatchParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t observersCount : { 1, 16, 64 }) {
+        for (const int64_t portsCount : { 32, 512 }) {
+            parametersSet.push_back({ { "observers", observersCount }, { "ports", portsCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getHwUnitsParameters() {
+    return { { { "units", 1 } }, { { "units", 2 } }, { { "units", 4 } }, { { "units", HwPortLinkScanHandling::MaxHwUnits } } };
+}
+
+std::vector<BenchmarkRunner::Parameters> getLinkScanModeParameters() {
+    return { { { "hardware", 0 }, { "interval_us", 1000 } }, { { "hardware", 0 }, { "interval_us", 10000 } },
+             { { "hardware", 1 }, { "interval_us", 10000 } } };
+}
+
+/// Remembers the latest link status notified of each port
+class LinkStatusRecordingObserver final : public Observer {
+  public:
+    LinkStatusRecordingObserver() : Observer({ UpdateReason::LinkStatusUpdate }), _linkedUp {} {}
+    virtual ObserverId hash() override { return getObserverId(); }
+    virtual void update(const ObservedSubjectHandle& /* subject */, const UpdateReason /* updateReason */) override {}
+    virtual void updateLinkStatus(const ObservedSubjectHandle& /* subject */, const LinkEventBatch::Handle& linkEvents) override {
+        for (const auto& linkEvent : *linkEvents) {
+            _linkedUp[linkEvent.portNo].store(linkEvent.linkedUp, std::memory_order_release);
+        }
+    }
+
+    /// @retval false if link status wasn't notified within @p timeout
+    bool waitForLinkStatus(const PortId portNo, const bool linkedUp, const std::chrono::milliseconds timeout) const {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (_linkedUp[portNo].load(std::memory_order_acquire) != linkedUp) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+  private:
+    std::array<std::atomic<bool>, MaxPorts> _linkedUp;
+};
+
+/// Reads all link events notified, like PortManager does
+class LinkEventsReadingObserver final : public Observer {
+  public:
+    LinkEventsReadingObserver() : Observer({ UpdateReason::LinkStatusUpdate }), _linkedUpPortsCount { 0 } {}
+    virtual ObserverId hash() override { return getObserverId(); }
+    virtual void update(const ObservedSubjectHandle& /* subject */, const UpdateReason /* updateReason */) override {}
+    virtual void updateLinkStatus(const ObservedSubjectHandle& /* subject */, const LinkEventBatch::Handle& linkEvents) override {
+        for (const auto& linkEvent : *linkEvents) {
+            _linkedUpPortsCount += linkEvent.linkedUp ? 1 : 0;
+        }
+    }
+
+    size_t getLinkedUpPortsCount() const { return _linkedUpPortsCount; }
+
+  private:
+    size_t _linkedUpPortsCount;
+};
+
+/// Keeps handles of the latest link event batches, like observer which processes events later
+class LinkEventsRetainingObserver final : public Observer {
+  public:
+    explicit LinkEventsRetainingObserver(const size_t retainedBatchesCount)
+        : Observer({ UpdateReason::LinkStatusUpdate }), _retainedBatches(retainedBatchesCount), _nextBatchIndex { 0 } {}
+    virtual ObserverId hash() override { return getObserverId(); }
+    virtual void update(const ObservedSubjectHandle& /* subject */, const UpdateReason /* updateReason */) override {}
+    virtual void updateLinkStatus(const ObservedSubjectHandle& /* subject */, const LinkEventBatch::Handle& linkEvents) override {
+        _retainedBatches[_nextBatchIndex] = linkEvents;
+        _nextBatchIndex = (_nextBatchIndex + 1) % _retainedBatches.size();
+    }
+
+  private:
+    std::vector<LinkEventBatch::Handle> _retainedBatches;
+    size_t _nextBatchIndex;
+};
+
+} // namespace
+
+/// Link events are injected by SDK simulator. Time of SDK linkscan callback and time of handing
+/// collected changes over to PortManager are measured separately.
+/// @note Panel port mapping is still a stub, so all hw ports are reported as one panel port.
+void OpenNos::registerLinkScanBenchmarks(BenchmarkRunner& runner) {
+    runner.run("HwPortLinkScanHandling.callback", getPortsCountParameters(), 100,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<int>(parameters.at("ports"));
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           state.start();
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                           state.stop();
+                       }
+
+                       linkScanHandling->execute();
+                   }
+
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+               });
+
+    runner.run("PortManager.update.LinkStatusUpdate", getPortsCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<int>(parameters.at("ports"));
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto portManager = std::make_shared<PortManager>();
+                   // Created after PortManager, so SDK callback is bound to this instance
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   Observer::Handle portManagerAsObserver = portManager;
+                   linkScanHandling->addObserver(portManagerAsObserver);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                       }
+
+                       state.start();
+                       linkScanHandling->execute();
+                       state.stop();
+                   }
+
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+               });
+
+    /// Flap storm: SDK linkscan thread reports link changes of all ports back to back, while notifier
+    /// thread concurrently drains them and notifies PortManager
+    runner.run("HwPortLinkScanHandling.flapStorm", getPortsCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<int>(parameters.at("ports"));
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto portManager = std::make_shared<PortManager>();
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   Observer::Handle portManagerAsObserver = portManager;
+                   linkScanHandling->addObserver(portManagerAsObserver);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   linkScanHandling->start();
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           state.start();
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                           state.stop();
+                       }
+                   }
+
+                   linkScanHandling->stop();
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   const auto statistics = linkScanHandling->getStatistics();
+                   state.setMetric("callbacks", static_cast<double>(statistics.callbacks));
+                   state.setMetric("notifier_wake_ups", static_cast<double>(statistics.notifierWakeUps));
+                   state.setMetric("drained_ports", static_cast<double>(statistics.drainedPorts));
+               });
+
+    /// One bad port flaps continuously. Each reported change reprograms all VLANs which port is trunked
+    /// into, so number of SDK calls shows load put on ASIC command path with and without dampening.
+    runner.run("HwPortLinkDampening.badPort", getDampeningParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   constexpr opennsl_port_t BadHwPort = 1;
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   HwPortLinkDampening::Parameters dampeningParameters {};
+                   dampeningParameters.dampeningEnabled = parameters.at("dampening") != 0;
+                   linkScanHandling->setLinkDampeningParameters(dampeningParameters);
+                   // Not started, so queued VLAN reconfiguration is executed in this thread
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto vlanLinkStatusHandling = std::make_shared<VlanLinkStatusHandling>(hwCommandProcessor);
+                   for (int64_t vid = 1; vid <= parameters.at("vlans"); ++vid) {
+                       opennsl_vlan_create(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid));
+                       vlanLinkStatusHandling->setVlanCreated(static_cast<VlanId>(vid), true);
+                       vlanLinkStatusHandling->addPortRole(static_cast<VlanId>(vid),
+                                                           HwPort::Mapping::hwPortToPanelPort(Asic::getDefaultHwUnit(), BadHwPort),
+                                                           VlanPortRole::Trunk);
+                   }
+
+                   Observer::Handle vlanLinkStatusHandlingAsObserver = vlanLinkStatusHandling;
+                   linkScanHandling->addObserver(vlanLinkStatusHandlingAsObserver);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   const auto sdkCallsBefore = simulator.getTotalCallsCount();
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       simulator.injectLinkEvent(Asic::getDefaultHwUnit(), BadHwPort, false);
+                       linkScanHandling->execute();
+                       hwCommandProcessor->execute();
+                       simulator.injectLinkEvent(Asic::getDefaultHwUnit(), BadHwPort, true);
+                       linkScanHandling->execute();
+                       hwCommandProcessor->execute();
+                       state.stop();
+                   }
+
+                   const auto sdkCalls = simulator.getTotalCallsCount() - sdkCallsBefore;
+                   const auto statistics = linkScanHandling->getLinkDampeningStatistics();
+                   // Penalty limited below suppress threshold would never suppress port
+                   auto invalidParameters = dampeningParameters;
+                   invalidParameters.maxSuppressTime = std::chrono::milliseconds { 0 };
+                   const bool invalidParametersAccepted = not Result::Failed(linkScanHandling->setLinkDampeningParameters(invalidParameters));
+                   // Port still suppressed after the last flaps is reported up as soon as dampening is disabled
+                   dampeningParameters.dampeningEnabled = false;
+                   linkScanHandling->setLinkDampeningParameters(dampeningParameters);
+                   linkScanHandling->execute();
+                   hwCommandProcessor->execute();
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   state.setMetric("link_changes", static_cast<double>(statistics.linkChanges));
+                   state.setMetric("reported_changes", static_cast<double>(statistics.reportedChanges));
+                   state.setMetric("suppressed_changes", static_cast<double>(statistics.suppressedChanges));
+                   state.setMetric("sdk_calls", static_cast<double>(sdkCalls));
+                   state.setMetric("invalid_parameters_accepted", invalidParametersAccepted ? 1 : 0);
+                   state.setMetric("reuses_after_disabling", static_cast<double>(linkScanHandling->getLinkDampeningStatistics().reuses - statistics.reuses));
+               });
+
+    /// All ports go down at once, e.g. line card failure. Each SDK call of FDB flushing takes 5 us.
+    /// Not batched: each port is flushed by its own delete by port call right after it went down.
+    /// Batched: ports are collected and flushed in one pass on ASIC thread, LAGs by delete by trunk.
+    runner.run("HwPortFdbFlushing.massLinkDown", getFdbFlushingParameters(), 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<PortId>(parameters.at("ports"));
+                   const auto lagMembersCount = static_cast<PortId>(parameters.at("lag_members"));
+                   const bool batched = parameters.at("batched") != 0;
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   simulator.setCallLatency(SdkCall::L2AddrDeleteByPort, std::chrono::microseconds { 5 });
+                   simulator.setCallLatency(SdkCall::L2AddrDeleteByTrunk, std::chrono::microseconds { 5 });
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto fdbFlushing = std::make_shared<HwPortFdbFlushing>();
+                   if (batched) {
+                       fdbFlushing->setHwCommandProcessor(hwCommandProcessor);
+                       for (PortId firstPortNo = 1; lagMembersCount && (firstPortNo + lagMembersCount <= portsCount); firstPortNo += lagMembersCount) {
+                           HwPortFdbFlushing::PortBitmap memberPorts {};
+                           for (PortId portNo = firstPortNo; portNo < firstPortNo + lagMembersCount; ++portNo) {
+                               memberPorts.set(portNo);
+                           }
+
+                           fdbFlushing->setTrunkMemberPorts(static_cast<opennsl_trunk_t>(firstPortNo), memberPorts);
+                       }
+                   }
+
+                   const auto sdkCallsBefore = simulator.getTotalCallsCount();
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                           if (batched) {
+                               fdbFlushing->addPortToFlushing(portNo);
+                           } else {
+                               fdbFlushing->addPortToFlushing(portNo).execute();
+                           }
+                       }
+
+                       if (batched) {
+                           fdbFlushing->commit();
+                           hwCommandProcessor->execute();
+                       }
+
+                       state.stop();
+                   }
+
+                   state.setMetric("sdk_calls_per_iteration",
+                                   static_cast<double>(simulator.getTotalCallsCount() - sdkCallsBefore) / static_cast<double>(state.getIterations()));
+               });
+
+    /// Members of each LAG go down one by one, each link change is flushed in its own pass.
+    /// MACs learned on trunk stay valid while any member forwards, so each LAG is expected to be
+    /// flushed once, when its last member goes down, and no member is flushed by port.
+    runner.run("HwPortFdbFlushing.lagMemberLinkDown", { { { "ports", 32 } }, { { "ports", 256 } } }, 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<PortId>(parameters.at("ports"));
+                   const PortId lagMembersCount = 4;
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto fdbFlushing = std::make_shared<HwPortFdbFlushing>();
+                   for (PortId firstPortNo = 1; firstPortNo + lagMembersCount <= portsCount + 1; firstPortNo += lagMembersCount) {
+                       HwPortFdbFlushing::PortBitmap memberPorts {};
+                       memberPorts.setRange(firstPortNo, firstPortNo + lagMembersCount - 1);
+                       fdbFlushing->setTrunkMemberPorts(static_cast<opennsl_trunk_t>(firstPortNo), memberPorts);
+                   }
+
+                   uint64_t failures = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       const auto trunkCallsBefore = simulator.getCallsCount(SdkCall::L2AddrDeleteByTrunk);
+                       const auto portCallsBefore = simulator.getCallsCount(SdkCall::L2AddrDeleteByPort);
+                       state.start();
+                       for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                           fdbFlushing->addPortToFlushing(portNo).commit();
+                       }
+
+                       state.stop();
+                       const uint64_t lagsCount = portsCount / lagMembersCount;
+                       if ((simulator.getCallsCount(SdkCall::L2AddrDeleteByTrunk) - trunkCallsBefore != lagsCount)
+                           || (simulator.getCallsCount(SdkCall::L2AddrDeleteByPort) != portCallsBefore)) {
+                           ++failures;
+                       }
+
+                       for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                           fdbFlushing->setPortLinkedUp(portNo);
+                       }
+                   }
+
+                   const auto statistics = fdbFlushing->getStatistics();
+                   state.setMetric("unexpected_flushes", static_cast<double>(failures));
+                   state.setMetric("skipped_trunk_member_ports", static_cast<double>(statistics.skippedTrunkMemberPorts));
+               });
+
+    /// Flap storm with latency tracing, shows cost of trace points in linkscan callback and
+    /// latencies of link event handling stages collected by LatencyTracer
+    runner.run("LatencyTracer.flapStorm", getTracingParameters(), 200,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   auto& latencyTracer = LatencyTracer::getInstance();
+                   latencyTracer.reset();
+                   latencyTracer.setEnabled(parameters.at("tracing") != 0);
+                   const auto portsCount = static_cast<int>(parameters.at("ports"));
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto portManager = std::make_shared<PortManager>();
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   Observer::Handle portManagerAsObserver = portManager;
+                   linkScanHandling->addObserver(portManagerAsObserver);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   linkScanHandling->start();
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           state.start();
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                           state.stop();
+                       }
+                   }
+
+                   linkScanHandling->stop();
+                   // Changes not drained by notifier before it stopped
+                   linkScanHandling->execute();
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   latencyTracer.setEnabled(false);
+                   for (const auto stage : { TraceStage::LinkScanCallback, TraceStage::NotifierDrain, TraceStage::LinkStatusNotified }) {
+                       const auto& histogram = latencyTracer.getHistogram(stage);
+                       const std::string stageName = (TraceStage::LinkScanCallback == stage) ? "callback"
+                               : (TraceStage::NotifierDrain == stage) ? "notifier_drain" : "link_status_notified";
+                       state.setMetric(stageName + "_p50_ns", static_cast<double>(histogram.getPercentileNs(50.0)));
+                       state.setMetric(stageName + "_p99_ns", static_cast<double>(histogram.getPercentileNs(99.0)));
+                   }
+               });
+
+    /// All ports flap at once and many observers read the same link events. Observers share one
+    /// batch of events, so time of notification grows only with work done by observers.
+    runner.run("HwPortLinkScanHandling.linkEventBatch", getLinkEventBatchParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   const auto portsCount = static_cast<int>(parameters.at("ports"));
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   std::vector<Observer::Handle> observers {};
+                   for (int64_t i = 0; i < parameters.at("observers"); ++i) {
+                       observers.push_back(std::make_shared<LinkEventsReadingObserver>());
+                       linkScanHandling->addObserver(observers.back());
+                   }
+
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                       }
+
+                       state.start();
+                       linkScanHandling->execute();
+                       state.stop();
+                   }
+
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+               });
+
+    /// Observer keeps the latest batches, so they can't be recycled. Pool grows only up to its limit, which
+    /// fits retained batches together with the one being notified and the one being filled. Batches over
+    /// it are allocated and freed outside of pool.
+    runner.run("HwPortLinkScanHandling.retainedLinkEventBatches",
+               { { { "retained", 1 } }, { { "retained", static_cast<int64_t>(HwPortLinkScanHandling::MaxPooledLinkEventBatches) - 2 } }, { { "retained", 256 } } },
+               1000, [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   constexpr int portsCount = 32;
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   Observer::Handle observer = std::make_shared<LinkEventsRetainingObserver>(static_cast<size_t>(parameters.at("retained")));
+                   linkScanHandling->addObserver(observer);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= portsCount; ++hwPort) {
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), hwPort, (iteration % 2) == 0);
+                       }
+
+                       state.start();
+                       linkScanHandling->execute();
+                       state.stop();
+                   }
+
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   const auto statistics = linkScanHandling->getLinkEventBatchPoolStatistics();
+                   state.setMetric("acquired_batches", static_cast<double>(statistics.acquiredBatches));
+                   state.setMetric("allocated_batches", static_cast<double>(statistics.allocatedBatches));
+                   state.setMetric("overflow_batches", static_cast<double>(statistics.overflowBatches));
+               });
+
+    /// Link events of many units are interleaved, each unit has its own linkscan handling. Time of
+    /// SDK callback shows cost of dispatch to handling of unit.
+    runner.run("HwPortLinkScanHandling.multiUnit", getHwUnitsParameters(), 100,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   // The same h/w port of all units flaps, so each link event has to be traced on its own unit
+                   auto& latencyTracer = LatencyTracer::getInstance();
+                   latencyTracer.reset();
+                   latencyTracer.setEnabled(true);
+                   constexpr int PortsCount = 128;
+                   const auto unitsCount = static_cast<int>(parameters.at("units"));
+                   std::vector<HwPortLinkScanHandling::Handle> linkScanHandlings {};
+                   for (int unit = 0; unit < unitsCount; ++unit) {
+                       simulator.setEthernetPortsCount(unit, PortsCount);
+                       linkScanHandlings.push_back(std::make_shared<HwPortLinkScanHandling>(unit));
+                       opennsl_linkscan_register(unit, linkScanHandlings.back()->getLinkScanCallback());
+                   }
+
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (opennsl_port_t hwPort = 1; hwPort <= PortsCount; ++hwPort) {
+                           for (int unit = 0; unit < unitsCount; ++unit) {
+                               state.start();
+                               simulator.injectLinkEvent(unit, hwPort, (iteration % 2) == 0);
+                               state.stop();
+                           }
+                       }
+
+                       for (auto& linkScanHandling : linkScanHandlings) {
+                           linkScanHandling->execute();
+                       }
+                   }
+
+                   uint64_t misroutedCallbacks = 0;
+                   for (int unit = 0; unit < unitsCount; ++unit) {
+                       const auto statistics = linkScanHandlings[static_cast<size_t>(unit)]->getStatistics();
+                       misroutedCallbacks += statistics.ignoredCallbacks + statistics.callbacks - state.getIterations() * PortsCount;
+                       opennsl_linkscan_unregister(unit, linkScanHandlings[static_cast<size_t>(unit)]->getLinkScanCallback());
+                   }
+
+                   latencyTracer.setEnabled(false);
+                   const auto linkEventsCount = state.getIterations() * PortsCount * static_cast<size_t>(unitsCount);
+                   state.setMetric("misrouted_callbacks", static_cast<double>(misroutedCallbacks));
+                   state.setMetric("untraced_link_events",
+                                   static_cast<double>(linkEventsCount - latencyTracer.getHistogram(TraceStage::NotifierDrain).getCount()));
+               });
+
+    /// Link of port goes down in PHY at random phase of linkscan interval. Measured is time until
+    /// observers are notified about it, which is dominated by detection in software linkscan mode.
+    runner.run("HwPortLinkScanHandling.detectionLatency", getLinkScanModeParameters(), 50,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   constexpr PortId PortNo = 1;
+                   constexpr std::chrono::milliseconds Timeout { 1000 };
+                   const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(PortNo);
+                   const auto linkScanInterval = std::chrono::microseconds { parameters.at("interval_us") };
+                   PortParameters portParameters {};
+                   portParameters.portNo = PortNo;
+                   portParameters.linkScanMode = (parameters.at("hardware") != 0) ? LinkScanMode::Hardware : LinkScanMode::Software;
+                   HwPortLinkScanModeSetting linkScanModeSetting {};
+                   linkScanModeSetting.setPortParameters(portParameters);
+                   linkScanModeSetting.execute();
+                   auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                   auto observer = std::make_shared<LinkStatusRecordingObserver>();
+                   Observer::Handle observerHandle = observer;
+                   linkScanHandling->addObserver(observerHandle);
+                   opennsl_linkscan_register(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   linkScanHandling->start();
+                   opennsl_linkscan_enable_set(Asic::getDefaultHwUnit(), static_cast<int>(linkScanInterval.count()));
+                   const PortId notifiedPortNo = HwPort::Mapping::hwPortToPanelPort(Asic::getDefaultHwUnit(), hwPort);
+                   std::mt19937 randomGenerator { 1 };
+                   std::uniform_int_distribution<int64_t> phaseDistribution { 0, linkScanInterval.count() };
+                   size_t missedLinkDowns = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       simulator.setPhysicalLinkStatus(Asic::getDefaultHwUnit(), hwPort, true);
+                       observer->waitForLinkStatus(notifiedPortNo, true, Timeout);
+                       std::this_thread::sleep_for(std::chrono::microseconds { phaseDistribution(randomGenerator) });
+                       state.start();
+                       simulator.setPhysicalLinkStatus(Asic::getDefaultHwUnit(), hwPort, false);
+                       const bool notified = observer->waitForLinkStatus(notifiedPortNo, false, Timeout);
+                       state.stop();
+                       missedLinkDowns += notified ? 0 : 1;
+                   }
+
+                   opennsl_linkscan_enable_set(Asic::getDefaultHwUnit(), 0);
+                   opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                   linkScanHandling->stop();
+                   state.setMetric("missed_link_downs", static_cast<double>(missedLinkDowns));
+               });
+}
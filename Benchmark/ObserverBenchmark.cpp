@@ -0,0 +1,218 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "EventBus.hpp"
+#include "Observer.hpp"
+
+// C++ Standard Library
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace OpenNos;
+
+namespace {
+
+class BenchmarkObserver final : public Observer {
+  public:
+    BenchmarkObserver(const ObserverId observerId, std::initializer_list<UpdateReason> supportedUpdateReasons)
+        : Observer(supportedUpdateReasons), _observerId { observerId }, _updatesCount { 0 } {
+        // Nothing more to do
+    }
+
+    virtual ObserverId hash() override { return _observerId; }
+    virtual void update(const ObservedSubjectHandle& /* subject */, const UpdateReason /* updateReason */) override {
+        ++_updatesCount;
+    }
+
+    size_t getUpdatesCount() const { return _updatesCount; }
+
+  private:
+    ObserverId _observerId;
+    size_t _updatesCount;
+};
+
+class BenchmarkSubject final : public ObservedSubject {
+  public:
+    using ObservedSubject::notifyAllObservers;
+};
+
+/// Emulates observer which programs ASIC on each update, e.g. VLAN reprogramming
+class SlowObserver final : public Observer {
+  public:
+    explicit SlowObserver(const std::chrono::nanoseconds updateTime)
+        : Observer({ UpdateReason::PortDown, UpdateReason::PortUp }), _updateTime { updateTime }, _updatesCount { 0 } {
+        // Nothing more to do
+    }
+
+    virtual ObserverId hash() override { return 0; }
+    virtual void update(const ObservedSubjectHandle& /* subject */, const UpdateReason /* updateReason */) override {
+        const auto updateStartedAt = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - updateStartedAt < _updateTime) {
+        }
+
+        ++_updatesCount;
+    }
+
+    size_t getUpdatesCount() const { return _updatesCount; }
+
+  private:
+    std::chrono::nanoseconds _updateTime;
+    size_t _updatesCount;
+};
+
+} // namespace
+
+/// Emulates per port observers (e.g. Port objects) where half of them is interested in notified reason
+void OpenNos::registerObserverBenchmarks(BenchmarkRunner& runner) {
+    runner.run("ObservedSubject.notifyAllObservers",
+               { { { "ports", 32 } }, { { "ports", 64 } }, { { "ports", 128 } }, { { "ports", 512 } }, { { "ports", 4096 } } }, 10000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto subject = std::make_shared<BenchmarkSubject>();
+                   std::vector<std::shared_ptr<BenchmarkObserver>> observers {};
+                   for (int64_t portNo = 0; portNo < parameters.at("ports"); ++portNo) {
+                       const auto updateReason = (portNo % 2) ? UpdateReason::PortDown : UpdateReason::LinkStatusUpdate;
+                       observers.push_back(std::make_shared<BenchmarkObserver>(static_cast<ObserverId>(portNo),
+                                                                               std::initializer_list<UpdateReason> { updateReason }));
+                       Observer::Handle observer = observers.back();
+                       subject->addObserver(observer);
+                   }
+
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       subject->notifyAllObservers(UpdateReason::LinkStatusUpdate);
+                       state.stop();
+                   }
+
+                   doNotOptimize(observers.front()->getUpdatesCount());
+               });
+
+    /// Per port and per VLAN observers are added and removed in random order
+    runner.run("ObservedSubject.addRemoveObserver",
+               { { { "observers", 512 } }, { { "observers", 4096 } }, { { "observers", 16384 } } }, 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto subject = std::make_shared<BenchmarkSubject>();
+                   std::vector<Observer::Handle> observers {};
+                   for (int64_t observerNo = 0; observerNo < parameters.at("observers"); ++observerNo) {
+                       observers.push_back(std::make_shared<BenchmarkObserver>(static_cast<ObserverId>(observerNo),
+                               std::initializer_list<UpdateReason> { UpdateReason::LinkStatusUpdate, UpdateReason::PortDown }));
+                   }
+
+                   std::mt19937 generator { 1 };
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       std::shuffle(std::begin(observers), std::end(observers), generator);
+                       state.start();
+                       for (auto& observer : observers) {
+                           subject->addObserver(observer);
+                       }
+
+                       for (auto& observer : observers) {
+                           subject->removeObserver(observer);
+                       }
+
+                       state.stop();
+                   }
+
+                   doNotOptimize(subject->getObserversCount());
+               });
+
+    /// Port subjects flap (PortDown, PortUp) in bursts, each update of observer takes 20 us.
+    /// Measured is time spent by notifying thread, e.g. link scan notifier. Asynchronous delivery
+    /// collapses flaps of the same port which are not delivered yet.
+    runner.run("EventBus.portFlapBurst", { { { "async", 0 }, { "ports", 32 } }, { { "async", 1 }, { "ports", 32 } },
+                                           { { "async", 0 }, { "ports", 128 } }, { { "async", 1 }, { "ports", 128 } } }, 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const bool async = parameters.at("async") != 0;
+                   auto eventBus = std::make_shared<EventBus>();
+                   eventBus->start();
+                   auto slowObserver = std::make_shared<SlowObserver>(std::chrono::microseconds { 20 });
+                   Observer::Handle observer = slowObserver;
+                   std::vector<std::shared_ptr<BenchmarkSubject>> subjects {};
+                   for (int64_t portNo = 0; portNo < parameters.at("ports"); ++portNo) {
+                       subjects.push_back(std::make_shared<BenchmarkSubject>());
+                       subjects.back()->addObserver(observer, async ? eventBus : nullptr);
+                   }
+
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       for (const auto updateReason : { UpdateReason::PortDown, UpdateReason::PortUp, UpdateReason::PortDown }) {
+                           for (auto& subject : subjects) {
+                               subject->notifyAllObservers(updateReason);
+                           }
+                       }
+
+                       state.stop();
+                       eventBus->waitUntilIdle();
+                   }
+
+                   eventBus->stop();
+                   const auto statistics = eventBus->getStatistics();
+                   state.setMetric("updates_per_iteration",
+                                   static_cast<double>(slowObserver->getUpdatesCount()) / static_cast<double>(state.getIterations()));
+                   state.setMetric("coalesced", static_cast<double>(statistics.coalesced));
+               });
+
+    /// Stress: notifier publishes at high rate, while other thread keeps adding and removing observers,
+    /// e.g. subsystems which come and go. Measured is notification, which must not wait for changes.
+    runner.run("ObservedSubject.concurrentAddRemove", { { { "observers", 64 } }, { { "observers", 512 } } }, 100000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto subject = std::make_shared<BenchmarkSubject>();
+                   std::vector<std::shared_ptr<BenchmarkObserver>> observers {};
+                   for (int64_t observerNo = 0; observerNo < parameters.at("observers"); ++observerNo) {
+                       observers.push_back(std::make_shared<BenchmarkObserver>(static_cast<ObserverId>(observerNo),
+                                                                               std::initializer_list<UpdateReason> { UpdateReason::LinkStatusUpdate }));
+                       Observer::Handle observer = observers.back();
+                       subject->addObserver(observer);
+                   }
+
+                   std::atomic<bool> churning { true };
+                   std::atomic<uint64_t> changesCount { 0 };
+                   std::thread churnThread { [&subject, &churning, &changesCount] {
+                       std::vector<Observer::Handle> churnObservers {};
+                       for (ObserverId observerNo = 0; observerNo < 64; ++observerNo) {
+                           churnObservers.push_back(std::make_shared<BenchmarkObserver>(observerNo,
+                                   std::initializer_list<UpdateReason> { UpdateReason::LinkStatusUpdate }));
+                       }
+
+                       std::mt19937 generator { 1 };
+                       while (churning.load(std::memory_order_relaxed)) {
+                           auto& observer = churnObservers[generator() % churnObservers.size()];
+                           subject->addObserver(observer);
+                           subject->removeObserver(churnObservers[generator() % churnObservers.size()]);
+                           changesCount.fetch_add(2, std::memory_order_relaxed);
+                       }
+
+                       for (auto& observer : churnObservers) {
+                           subject->removeObserver(observer);
+                       }
+                   } };
+
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       subject->notifyAllObservers(UpdateReason::LinkStatusUpdate);
+                       state.stop();
+                   }
+
+                   churning.store(false, std::memory_order_relaxed);
+                   churnThread.join();
+                   state.setMetric("observer_changes", static_cast<double>(changesCount.load()));
+                   state.setMetric("updates_of_first_observer", static_cast<double>(observers.front()->getUpdatesCount()));
+                   doNotOptimize(subject->getObserversCount());
+               });
+}
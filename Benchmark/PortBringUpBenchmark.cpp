@@ -0,0 +1,306 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Asic.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwPortManager.hpp"
+#include "HwPortMapping.hpp"
+#include "PortManager.hpp"
+#include "Simulator/OpenNslSimulator.hpp"
+
+// C++ Standard Library
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using namespace OpenNos;
+
+namespace {
+
+std::vector<BenchmarkRunner::Parameters> getBringUpParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t groupsCount : { 1, 4, 8 }) {
+        for (const int64_t portsCount : { 32, 128 }) {
+            parametersSet.push_back({ { "groups", groupsCount }, { "ports", portsCount } });
+        }
+    }
+
+    // Unit without Ethernet ports is brought up without any per-port call
+    parametersSet.push_back({ { "groups", static_cast<int64_t>(HwPortBulkInitializing::DefaultGroupsCount) }, { "ports", 0 } });
+    return parametersSet;
+}
+
+std::vector<BenchmarkRunner::Parameters> getBreakoutParameters() {
+    const std::vector<std::pair<PortSplitMode, PortSplitMode>> breakouts {
+        { PortSplitMode::None, PortSplitMode::_4x25G },
+        { PortSplitMode::_4x25G, PortSplitMode::_2x50G },
+        { PortSplitMode::_4x10G, PortSplitMode::_4x25G },
+        { PortSplitMode::_2x50G, PortSplitMode::None }
+    };
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const auto& breakout : breakouts) {
+        parametersSet.push_back({ { "from", static_cast<int64_t>(breakout.first) }, { "to", static_cast<int64_t>(breakout.second) } });
+    }
+
+    return parametersSet;
+}
+
+/// QSFP cages whose four lanes are wired to consecutive h/w ports, none of them is split
+std::vector<PlatformPortRecord> createLaneGroups(const int64_t portsCount) {
+    std::vector<PlatformPortRecord> records {};
+    records.push_back({ 0, 0, 0, 0, 0, { PortParameters::InvalidPort, PortParameters::InvalidPort,
+                                         PortParameters::InvalidPort, PortParameters::InvalidPort } });
+    for (uint16_t portNo = 1; portNo <= portsCount; ++portNo) {
+        const uint16_t parentPort = static_cast<uint16_t>(portNo - (portNo - 1) % MaxSlavePorts);
+        PlatformPortRecord record {};
+        record.panelPort = portNo;
+        record.hwPort = portNo;
+        record.parentPort = parentPort;
+        record.slavePorts.fill(PortParameters::InvalidPort);
+        if (portNo == parentPort) {
+            for (uint16_t lane = 0; lane < MaxSlavePorts; ++lane) {
+                record.slavePorts[lane] = parentPort + lane;
+            }
+        }
+
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+/// Changes speed of port and shuts it down, like setting of configuration commit
+class PortReconfiguring final : public UndoableCommand {
+  public:
+    static constexpr PortSpeed Speed = PortSpeed::_25Gb;
+
+    PortReconfiguring(PortManager::Handle portManager, const PortId portNo)
+        : _portManager { std::move(portManager) }, _portNo { portNo }, _speedMemento { PortSpeed::Max }, _shutdownedMemento { false } {
+        // Nothing more to do
+    }
+
+    virtual ~PortReconfiguring() override = default;
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::PortSet; }
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        auto port = _portManager->get(_portManager->getHandle(_portNo));
+        if (nullptr == port) {
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        _speedMemento = port->getSpeed();
+        _shutdownedMemento = port->isShutdowned();
+        if (Result::Failed(port->setSpeed(Speed)) || Result::Failed(port->shutdown(true))) {
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override {
+        auto port = _portManager->get(_portManager->getHandle(_portNo));
+        if ((nullptr == port) || Result::Failed(port->setSpeed(_speedMemento)) || Result::Failed(port->shutdown(_shutdownedMemento))) {
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+  private:
+    PortManager::Handle _portManager;
+    PortId _portNo;
+    PortSpeed _speedMemento;
+    bool _shutdownedMemento;
+};
+
+} // namespace
+
+/// Startup of port module and default settings of all ports. Per-port SDK calls are delayed like
+/// register and PHY access of real ASIC. Time of each phase is reported as metric. Breakout of one
+/// lane group is measured against the same latencies.
+void OpenNos::registerPortBringUpBenchmarks(BenchmarkRunner& runner) {
+    runner.run("HwPortBulkInitializing.bringUp", getBringUpParameters(), 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(parameters.at("ports")));
+                   simulator.setCallLatency(SdkCall::PortStpSet, std::chrono::microseconds { 10 });
+                   simulator.setCallLatency(SdkCall::PortSelectiveSet, std::chrono::microseconds { 100 });
+                   simulator.setCallLatency(SdkCall::PortVlanMemberSet, std::chrono::microseconds { 10 });
+                   simulator.setCallLatency(SdkCall::StatClear, std::chrono::microseconds { 50 });
+                   simulator.setCallLatency(SdkCall::PortAbilityLocalGet, std::chrono::microseconds { 50 });
+                   simulator.setCallLatency(SdkCall::PortAbilityAdvertGet, std::chrono::microseconds { 50 });
+                   const auto groupsCount = static_cast<size_t>(parameters.at("groups"));
+                   HwPortBulkInitializing::PhaseTimings phaseTimings {};
+                   uint64_t failedBringUpsCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       auto linkScanHandling = std::make_shared<HwPortLinkScanHandling>();
+                       HwPortModuleInitializing moduleInitializing { linkScanHandling, groupsCount };
+                       HwPortDefaultParametersSetting defaultParametersSetting {};
+                       defaultParametersSetting.setGroupsCount(groupsCount);
+                       state.start();
+                       const auto moduleInitializingResult = moduleInitializing.execute();
+                       const auto defaultParametersSettingResult = defaultParametersSetting.execute();
+                       state.stop();
+                       if (Result::Failed(moduleInitializingResult) || Result::Failed(defaultParametersSettingResult)) {
+                           ++failedBringUpsCount;
+                       }
+
+                       opennsl_linkscan_unregister(Asic::getDefaultHwUnit(), linkScanHandling->getLinkScanCallback());
+                       for (const auto& timings : { moduleInitializing.getPhaseTimings(), defaultParametersSetting.getPhaseTimings() }) {
+                           for (size_t phase = 0; phase < timings.size(); ++phase) {
+                               phaseTimings[phase].duration += timings[phase].duration;
+                           }
+                       }
+                   }
+
+                   for (size_t phase = 0; phase < phaseTimings.size(); ++phase) {
+                       const auto phaseName = HwPortBulkInitializing::getPhaseName(static_cast<HwPortBulkInitializing::Phase>(phase));
+                       state.setMetric(std::string { phaseName } + "_us",
+                                       static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(phaseTimings[phase].duration).count())
+                                       / static_cast<double>(state.getIterations()));
+                   }
+
+                   state.setMetric("failed_bring_ups", static_cast<double>(failedBringUpsCount));
+               });
+
+    runner.run("HwPortBreakoutSetting.laneGroup", getBreakoutParameters(), 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   constexpr int64_t PortsCount = 128;
+                   constexpr PortId ParentPort = 5;
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(PortsCount));
+                   simulator.setCallLatency(SdkCall::PortStpSet, std::chrono::microseconds { 10 });
+                   simulator.setCallLatency(SdkCall::PortSelectiveSet, std::chrono::microseconds { 100 });
+                   simulator.setCallLatency(SdkCall::PortVlanMemberSet, std::chrono::microseconds { 10 });
+                   simulator.setCallLatency(SdkCall::StatClear, std::chrono::microseconds { 50 });
+                   simulator.setCallLatency(SdkCall::PortControlSet, std::chrono::microseconds { 100 });
+                   const auto records = createLaneGroups(PortsCount);
+                   auto& hwPortMapping = HwPortMapping::getInstance();
+                   hwPortMapping.load(records.data(), records.size());
+                   HwPortBreakoutSetting breakoutSetting {};
+                   PortParameters portParameters {};
+                   portParameters.portNo = ParentPort;
+                   uint64_t sdkCallsCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       portParameters.splitMode = static_cast<PortSplitMode>(parameters.at("from"));
+                       breakoutSetting.setPortParameters(portParameters).execute();
+                       portParameters.splitMode = static_cast<PortSplitMode>(parameters.at("to"));
+                       breakoutSetting.setPortParameters(portParameters);
+                       const auto sdkCallsBefore = simulator.getTotalCallsCount();
+                       state.start();
+                       breakoutSetting.execute();
+                       state.stop();
+                       sdkCallsCount += simulator.getTotalCallsCount() - sdkCallsBefore;
+                   }
+
+                   size_t touchedPortsCount = 0;
+                   for (const auto laneAction : breakoutSetting.getLaneActions()) {
+                       touchedPortsCount += (laneAction != HwPortBreakoutSetting::LaneAction::None)
+                               && (laneAction != HwPortBreakoutSetting::LaneAction::Keep);
+                   }
+
+                   state.setMetric("sdk_calls", static_cast<double>(sdkCallsCount) / static_cast<double>(state.getIterations()));
+                   state.setMetric("touched_ports", static_cast<double>(touchedPortsCount));
+                   hwPortMapping.reset();
+               });
+
+    /// Lane group is split to four ports and joined back by PortManager with breakout programmed in ASIC
+    /// thread. Ports of manager which differ from ports of lane group layout are reported as metric.
+    runner.run("PortManager.changePortBreakout", { { { "ports", 32 } } }, 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   constexpr PortId ParentPort = 5;
+                   const auto portsCount = parameters.at("ports");
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(portsCount));
+                   const auto records = createLaneGroups(portsCount);
+                   auto& hwPortMapping = HwPortMapping::getInstance();
+                   hwPortMapping.load(records.data(), records.size());
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   hwCommandProcessor->start();
+                   auto portManager = std::make_shared<PortManager>();
+                   portManager->setHwCommandProcessor(hwCommandProcessor);
+                   portManager->add(ParentPort);
+                   portManager->execute(gNullResultCallback);
+                   // Ports of lane group which have to exist after each step
+                   const std::vector<std::pair<PortSplitMode, std::vector<PortId>>> steps {
+                       { PortSplitMode::_4x25G, { ParentPort, ParentPort + 1, ParentPort + 2, ParentPort + 3 } },
+                       { PortSplitMode::None, { ParentPort } }
+                   };
+                   size_t unexpectedPortsCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       for (const auto& step : steps) {
+                           state.start();
+                           const auto result = portManager->changePortBreakout(ParentPort, step.first);
+                           state.stop();
+                           unexpectedPortsCount += Result::Failed(result) ? 1 : 0;
+                           for (PortId portNo = ParentPort; portNo < ParentPort + MaxSlavePorts; ++portNo) {
+                               const bool expected = std::find(std::begin(step.second), std::end(step.second), portNo) != std::end(step.second);
+                               unexpectedPortsCount += expected != portManager->exists(portNo);
+                           }
+                       }
+                   }
+
+                   hwCommandProcessor->stop();
+                   state.setMetric("unexpected_ports", static_cast<double>(unexpectedPortsCount));
+                   hwPortMapping.reset();
+               });
+
+    /// Speed and shutdown of all ports are committed together, with ASIC failing all of them or none.
+    /// Ports whose parameters differ from what ASIC has programmed are reported as metric.
+    std::vector<BenchmarkRunner::Parameters> commitParametersSet {};
+    for (const int64_t failing : { 0, 1 }) {
+        commitParametersSet.push_back({ { "failing", failing }, { "ports", 32 } });
+    }
+
+    runner.run("PortManager.commitPortSettings", commitParametersSet, 10,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const auto portsCount = static_cast<PortId>(parameters.at("ports"));
+                   const bool failing = parameters.at("failing") != 0;
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   size_t unexpectedParametersCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       simulator.reset();
+                       simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(portsCount));
+                       auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                       hwCommandProcessor->start();
+                       auto portManager = std::make_shared<PortManager>();
+                       portManager->setHwCommandProcessor(hwCommandProcessor);
+                       std::vector<UndoableCommand::Handle> portSettings {};
+                       for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                           portManager->add(portNo);
+                           portSettings.push_back(std::make_shared<PortReconfiguring>(portManager, portNo));
+                       }
+
+                       portManager->execute(gNullResultCallback);
+                       simulator.setCallFailure(SdkCall::PortSelectiveSet, failing ? 1 : 0);
+                       state.start();
+                       portManager->commitPortSettings(portSettings, gNullResultCallback);
+                       state.stop();
+                       simulator.setCallFailure(SdkCall::PortSelectiveSet, 0);
+                       for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                           const auto port = portManager->get(portManager->getHandle(portNo));
+                           const bool programmed = (port->getSpeed() == PortReconfiguring::Speed) && port->isShutdowned();
+                           unexpectedParametersCount += programmed == failing ? 1 : 0;
+                       }
+
+                       hwCommandProcessor->stop();
+                   }
+
+                   state.setMetric("unexpected_parameters", static_cast<double>(unexpectedParametersCount));
+               });
+}
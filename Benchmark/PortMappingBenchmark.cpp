@@ -0,0 +1,116 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "HwPortMapping.hpp"
+
+// C++ Standard Library
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+using namespace OpenNos;
+
+namespace {
+
+std::vector<BenchmarkRunner::Parameters> getPortsCountParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t portsCount : { 32, 128, 511 }) {
+        parametersSet.push_back({ { "ports", portsCount } });
+    }
+
+    return parametersSet;
+}
+
+/// CPU port and front panel ports wired to shuffled h/w ports. Each four ports are lanes of one
+/// port split into 4x25G, like QSFP cages of DX010.
+std::vector<PlatformPortRecord> createPlatformPorts(const int64_t portsCount) {
+    std::vector<uint16_t> hwPorts(static_cast<size_t>(portsCount));
+    std::iota(hwPorts.begin(), hwPorts.end(), uint16_t { 1 });
+    std::shuffle(hwPorts.begin(), hwPorts.end(), std::mt19937 { 0 });
+    std::vector<PlatformPortRecord> records {};
+    records.push_back({ 0, 0, 0, 0, 0, { PortParameters::InvalidPort, PortParameters::InvalidPort,
+                                         PortParameters::InvalidPort, PortParameters::InvalidPort } });
+    for (uint16_t portNo = 1; portNo <= portsCount; ++portNo) {
+        const uint16_t parentPort = static_cast<uint16_t>(portNo - (portNo - 1) % 4);
+        PlatformPortRecord record {};
+        record.panelPort = portNo;
+        record.hwPort = hwPorts[portNo - 1];
+        record.splitMode = static_cast<uint8_t>(PortSplitMode::_4x25G);
+        record.laneNo = static_cast<uint8_t>((portNo - parentPort) + static_cast<uint8_t>(PortLaneNo::Lane_1));
+        record.parentPort = parentPort;
+        record.slavePorts.fill(PortParameters::InvalidPort);
+        if (portNo == parentPort) {
+            for (uint16_t lane = 0; lane < MaxSlavePorts; ++lane) {
+                record.slavePorts[lane] = (parentPort + lane <= portsCount) ? parentPort + lane : PortParameters::InvalidPort;
+            }
+        }
+
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+} // namespace
+
+/// Panel port is translated to h/w port by each port command and h/w port to panel port by each
+/// link event. Loading measures reading of memory-mapped platform file at startup.
+void OpenNos::registerPortMappingBenchmarks(BenchmarkRunner& runner) {
+    runner.run("HwPortMapping.load", getPortsCountParameters(), 100,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const std::string platformFilePath { "/tmp/opennos-benchmark-platform-ports.bin" };
+                   const auto records = createPlatformPorts(parameters.at("ports"));
+                   if (Failed(HwPortMapping::store(platformFilePath, records))) {
+                       return;
+                   }
+
+                   HwPortMapping hwPortMapping {};
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       const auto result = hwPortMapping.load(platformFilePath);
+                       state.stop();
+                       doNotOptimize(result);
+                   }
+
+                   state.setMetric("file_bytes", static_cast<double>(sizeof(PlatformFileHeader) + records.size() * sizeof(PlatformPortRecord)));
+                   std::remove(platformFilePath.c_str());
+               });
+
+    runner.run("HwPortMapping.translate", getPortsCountParameters(), 1000,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   const auto records = createPlatformPorts(parameters.at("ports"));
+                   HwPortMapping hwPortMapping {};
+                   hwPortMapping.load(records.data(), records.size());
+                   std::vector<PortId> ports(records.size());
+                   std::iota(ports.begin(), ports.end(), PortId { 0 });
+                   std::shuffle(ports.begin(), ports.end(), std::mt19937 { 1 });
+                   size_t mismatchesCount = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       for (const auto portNo : ports) {
+                           const auto hwPort = hwPortMapping.panelPortToHwPort(portNo);
+                           mismatchesCount += hwPortMapping.hwPortToPanelPort(Asic::getDefaultHwUnit(), hwPort) != portNo;
+                       }
+
+                       state.stop();
+                       doNotOptimize(mismatchesCount);
+                   }
+
+                   state.setMetric("round_trips", static_cast<double>(ports.size()));
+                   state.setMetric("mismatches", static_cast<double>(mismatchesCount));
+               });
+}
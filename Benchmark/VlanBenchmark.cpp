@@ -0,0 +1,334 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRunner.hpp"
+
+#include "Asic.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwPort.hpp"
+#include "HwVlan.hpp"
+#include "Simulator/OpenNslSimulator.hpp"
+#include "LagManager.hpp"
+#include "PortManager.hpp"
+#include "VlanLinkStatusHandling.hpp"
+#include "VlanManager.hpp"
+#include "VlanMemberPortManager.hpp"
+
+extern "C" {
+#   include <opennsl/vlan.h>
+}
+
+// C++ Standard Library
+#include <memory>
+
+using namespace OpenNos;
+
+namespace {
+
+std::vector<BenchmarkRunner::Parameters> getPortsAndVlansCountParameters() {
+    std::vector<BenchmarkRunner::Parameters> parametersSet {};
+    for (const int64_t portsCount : { 32, 64, 128, 512 }) {
+        for (const int64_t vlansCount : { 1, 64, 1024, 4094 }) {
+            parametersSet.push_back({ { "ports", portsCount }, { "vlans", vlansCount } });
+        }
+    }
+
+    return parametersSet;
+}
+
+void addAllPortsToAllVlans(VlanMemberPortManager& manager, const BenchmarkRunner::Parameters& parameters, const bool tagged) {
+    for (int64_t vid = 1; vid <= parameters.at("vlans"); ++vid) {
+        for (int64_t portNo = 1; portNo < parameters.at("ports"); ++portNo) {
+            manager.addMemberPort(static_cast<VlanId>(vid), static_cast<PortId>(portNo), tagged);
+        }
+    }
+}
+
+void flapPorts(VlanLinkStatusHandling& linkStatusHandling, const PortBitmap& ports, const bool linkUp, const bool batched) {
+    if (batched) {
+        linkStatusHandling.reconfigureOnLinkChange(linkUp ? ports : PortBitmap {}, linkUp ? PortBitmap {} : ports);
+        return;
+    }
+
+    for (const auto portNo : ports) {
+        PortBitmap port {};
+        port.set(portNo);
+        linkStatusHandling.reconfigureOnLinkChange(linkUp ? port : PortBitmap {}, linkUp ? PortBitmap {} : port);
+    }
+}
+
+/// Creates VLANs 2..vlans+1 with all ports as tagged members, either VLAN by VLAN, each of them
+/// by its own commit, or by range commands and one commit
+void provisionVlans(VlanManager& manager, HwCommandProcessor& hwCommandProcessor, const BenchmarkRunner::Parameters& parameters) {
+    const auto lastVid = static_cast<VlanId>(parameters.at("vlans") + 1);
+    const auto lastPortNo = static_cast<PortId>(parameters.at("ports"));
+    if (parameters.at("ranged") != 0) {
+        VlanBitmap vids {};
+        vids.setRange(2, lastVid);
+        VlanMemberPorts ports {};
+        ports.tagged.setRange(1, lastPortNo);
+        manager.addRange(vids);
+        manager.addRangeMemberPorts(vids, ports);
+        manager.execute();
+        hwCommandProcessor.execute();
+        return;
+    }
+
+    for (VlanId vid = 2; vid <= lastVid; ++vid) {
+        manager.add(vid);
+        for (PortId portNo = 1; portNo <= lastPortNo; ++portNo) {
+            manager.getMemberPortManager()->addMemberPort(vid, portNo, true);
+        }
+
+        manager.execute();
+        hwCommandProcessor.execute();
+    }
+}
+
+} // namespace
+
+/// All ports are trunked into all VLANs, which is the worst case of membership tables size
+void OpenNos::registerVlanBenchmarks(BenchmarkRunner& runner) {
+    runner.run("VlanMemberPortManager.addMemberPort", getPortsAndVlansCountParameters(), 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   const size_t residentMemoryBefore = BenchmarkRunner::getResidentMemory();
+                   auto manager = std::make_shared<VlanMemberPortManager>(hwCommandProcessor);
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       addAllPortsToAllVlans(*manager, parameters, (iteration % 2) == 0);
+                       state.stop();
+                   }
+
+                   state.setMetric("resident_bytes_delta",
+                                   static_cast<double>(BenchmarkRunner::getResidentMemory()) - static_cast<double>(residentMemoryBefore));
+               });
+
+    runner.run("VlanMemberPortManager.execute", getPortsAndVlansCountParameters(), 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(parameters.at("ports")));
+                   for (int64_t vid = 1; vid <= parameters.at("vlans"); ++vid) {
+                       opennsl_vlan_create(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid));
+                   }
+
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto manager = std::make_shared<VlanMemberPortManager>(hwCommandProcessor);
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       // Alternate tagging mode, so each commit changes membership of all ports
+                       addAllPortsToAllVlans(*manager, parameters, (iteration % 2) == 0);
+                       state.start();
+                       manager->execute();
+                       state.stop();
+                       hwCommandProcessor->execute();
+                   }
+
+                   state.setMetric("sdk_calls", static_cast<double>(simulator.getTotalCallsCount()));
+               });
+
+    /// Committed configuration is applied again with port 1 re-tagged in some of VLANs, like when
+    /// operator pushes mostly unchanged config. Re-tagged port shouldn't be removed from its VLANs, as
+    /// long as SDK re-tags member in place. Without in place re-tagging it has to be removed and added
+    /// again, while its tagging read back from SDK has to be right in both cases.
+    std::vector<BenchmarkRunner::Parameters> reapplyParametersSet {};
+    for (const int64_t inPlace : { 0, 1 }) {
+        for (const int64_t retaggedVlans : { 0, 64, 4094 }) {
+            reapplyParametersSet.push_back({ { "in_place", inPlace }, { "ports", 64 }, { "retagged_vlans", retaggedVlans }, { "vlans", 4094 } });
+        }
+    }
+
+    runner.run("VlanMemberPortManager.reapply", reapplyParametersSet, 10,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setVlanPortAddRetagging(parameters.at("in_place") != 0);
+                   HwVlanPortRetagging::reset(Asic::getDefaultHwUnit());
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(parameters.at("ports")));
+                   for (int64_t vid = 1; vid <= parameters.at("vlans"); ++vid) {
+                       opennsl_vlan_create(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid));
+                   }
+
+                   auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                   auto manager = std::make_shared<VlanMemberPortManager>(hwCommandProcessor);
+                   addAllPortsToAllVlans(*manager, parameters, true);
+                   manager->execute();
+                   hwCommandProcessor->execute();
+                   const auto sdkCallsBefore = simulator.getTotalCallsCount();
+                   const auto portRemovalsBefore = simulator.getCallsCount(SdkCall::VlanPortRemove);
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       addAllPortsToAllVlans(*manager, parameters, true);
+                       for (int64_t vid = 1; vid <= parameters.at("retagged_vlans"); ++vid) {
+                           manager->addMemberPort(static_cast<VlanId>(vid), 1, (iteration % 2) != 0);
+                       }
+
+                       state.start();
+                       manager->execute();
+                       hwCommandProcessor->execute();
+                       state.stop();
+                   }
+
+                   state.setMetric("sdk_calls_per_commit", static_cast<double>(simulator.getTotalCallsCount() - sdkCallsBefore)
+                                                           / static_cast<double>(state.getIterations()));
+                   state.setMetric("port_removals", static_cast<double>(simulator.getCallsCount(SdkCall::VlanPortRemove) - portRemovalsBefore));
+                   // Port 1 is untagged in re-tagged VLANs after odd count of iterations
+                   const bool untagged = (state.getIterations() % 2) != 0;
+                   uint64_t wronglyTaggedVlans = 0;
+                   for (int64_t vid = 1; vid <= parameters.at("retagged_vlans"); ++vid) {
+                       opennsl_pbmp_t hwPorts;
+                       opennsl_pbmp_t hwUntaggedPorts;
+                       opennsl_vlan_port_get(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid), &hwPorts, &hwUntaggedPorts);
+                       const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(1);
+                       if ((not OPENNSL_PBMP_MEMBER(hwPorts, hwPort)) || (untagged != OPENNSL_PBMP_MEMBER(hwUntaggedPorts, hwPort))) {
+                           ++wronglyTaggedVlans;
+                       }
+                   }
+
+                   state.setMetric("wrongly_tagged_vlans", static_cast<double>(wronglyTaggedVlans));
+               });
+
+    /// 128 ports are trunked into all VLANs, flapped ports go down and up. Not batched mode handles
+    /// each port as separate link event, like link scan callback reports them.
+    std::vector<BenchmarkRunner::Parameters> flapParametersSet {};
+    for (const int64_t batched : { 0, 1 }) {
+        for (const int64_t flappedPorts : { 1, 32, 128 }) {
+            for (const int64_t vlansCount : { 64, 1024, 4094 }) {
+                flapParametersSet.push_back({ { "batched", batched }, { "flapped_ports", flappedPorts }, { "vlans", vlansCount } });
+            }
+        }
+    }
+
+    runner.run("VlanLinkStatusHandling.reconfigureOnLinkChange", flapParametersSet, 20,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   constexpr int portsCount = 128;
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   simulator.reset();
+                   simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), portsCount);
+                   auto linkStatusHandling = std::make_shared<VlanLinkStatusHandling>(std::make_shared<HwCommandProcessor>());
+                   PortBitmap allPorts {};
+                   for (PortId portNo = 1; portNo <= portsCount; ++portNo) {
+                       allPorts.set(portNo);
+                   }
+
+                   for (int64_t vid = 1; vid <= parameters.at("vlans"); ++vid) {
+                       opennsl_vlan_create(Asic::getDefaultHwUnit(), static_cast<opennsl_vlan_t>(vid));
+                       linkStatusHandling->setVlanCreated(static_cast<VlanId>(vid), true);
+                       for (const auto portNo : allPorts) {
+                           linkStatusHandling->addPortRole(static_cast<VlanId>(vid), portNo, VlanPortRole::Trunk);
+                       }
+                   }
+
+                   linkStatusHandling->reconfigureOnLinkChange(allPorts, PortBitmap {});
+                   PortBitmap flappedPorts {};
+                   for (PortId portNo = 1; portNo <= parameters.at("flapped_ports"); ++portNo) {
+                       flappedPorts.set(portNo);
+                   }
+
+                   const bool batched = parameters.at("batched") != 0;
+                   const auto sdkCallsBefore = linkStatusHandling->getStatistics().sdkCalls;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       state.start();
+                       flapPorts(*linkStatusHandling, flappedPorts, false, batched);
+                       state.stop();
+                       state.start();
+                       flapPorts(*linkStatusHandling, flappedPorts, true, batched);
+                       state.stop();
+                   }
+
+                   state.setMetric("sdk_calls_per_link_change",
+                                   static_cast<double>(linkStatusHandling->getStatistics().sdkCalls - sdkCallsBefore)
+                                   / static_cast<double>(2 * state.getIterations()));
+               });
+
+    std::vector<BenchmarkRunner::Parameters> provisionParametersSet {};
+    for (const int64_t ranged : { 0, 1 }) {
+        for (const int64_t vlansCount : { 64, 1024, 4094 }) {
+            provisionParametersSet.push_back({ { "ports", 64 }, { "ranged", ranged }, { "vlans", vlansCount } });
+        }
+    }
+
+    runner.run("VlanManager.provision", provisionParametersSet, 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   uint64_t sdkCalls = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       simulator.reset();
+                       simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(parameters.at("ports")));
+                       auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                       auto portManager = std::make_shared<PortManager>();
+                       auto lagManager = std::make_shared<LagManager>(portManager);
+                       // Links are up, otherwise member ports wouldn't be programmed into VLANs by commit
+                       for (PortId portNo = 1; portNo <= static_cast<PortId>(parameters.at("ports")); ++portNo) {
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), HwPort::Mapping::panelPortToHwPort(portNo), true);
+                       }
+
+                       auto manager = std::make_shared<VlanManager>(portManager, lagManager, hwCommandProcessor);
+                       // Manager reads link status of ports in ASIC thread
+                       hwCommandProcessor->execute();
+                       const uint64_t sdkCallsBefore = simulator.getTotalCallsCount();
+                       state.start();
+                       provisionVlans(*manager, *hwCommandProcessor, parameters);
+                       state.stop();
+                       sdkCalls = simulator.getTotalCallsCount() - sdkCallsBefore;
+                   }
+
+                   state.setMetric("sdk_calls", static_cast<double>(sdkCalls));
+               });
+
+    // Commit fails in ASIC, configuration stays pending and is programmed by next commit
+    std::vector<BenchmarkRunner::Parameters> retryParametersSet {};
+    for (const int64_t vlansCount : { 64, 1024 }) {
+        retryParametersSet.push_back({ { "ports", 64 }, { "ranged", 1 }, { "vlans", vlansCount } });
+    }
+
+    runner.run("VlanManager.retryAfterAsicFailure", retryParametersSet, 5,
+               [](BenchmarkRunner::State& state, const BenchmarkRunner::Parameters& parameters) {
+                   auto& simulator = OpenNslSimulator::getInstance();
+                   const auto lastVid = static_cast<VlanId>(parameters.at("vlans") + 1);
+                   const auto lastPortNo = static_cast<PortId>(parameters.at("ports"));
+                   uint64_t unexpectedResults = 0;
+                   uint64_t lostVlans = 0;
+                   uint64_t lostMemberPorts = 0;
+                   for (size_t iteration = 0; iteration < state.getIterations(); ++iteration) {
+                       simulator.reset();
+                       simulator.setEthernetPortsCount(Asic::getDefaultHwUnit(), static_cast<int>(lastPortNo));
+                       for (PortId portNo = 1; portNo <= lastPortNo; ++portNo) {
+                           simulator.injectLinkEvent(Asic::getDefaultHwUnit(), HwPort::Mapping::panelPortToHwPort(portNo), true);
+                       }
+
+                       auto hwCommandProcessor = std::make_shared<HwCommandProcessor>();
+                       auto portManager = std::make_shared<PortManager>();
+                       auto lagManager = std::make_shared<LagManager>(portManager);
+                       auto manager = std::make_shared<VlanManager>(portManager, lagManager, hwCommandProcessor);
+                       hwCommandProcessor->execute();
+                       simulator.setCallFailure(SdkCall::VlanPortAdd, 1);
+                       state.start();
+                       provisionVlans(*manager, *hwCommandProcessor, parameters);
+                       simulator.setCallFailure(SdkCall::VlanPortAdd, 0);
+                       const auto result = manager->execute();
+                       hwCommandProcessor->execute();
+                       state.stop();
+                       unexpectedResults += Result::Failed(result) ? 1 : 0;
+                       for (VlanId vid = 2; vid <= lastVid; ++vid) {
+                           lostVlans += manager->exists(vid) ? 0 : 1;
+                           const auto& memberPorts = manager->getMemberPortManager()->getCommittedMemberPorts().getMemberPorts(vid);
+                           lostMemberPorts += static_cast<uint64_t>(lastPortNo) - memberPorts.tagged.size();
+                       }
+                   }
+
+                   state.setMetric("unexpected_results", static_cast<double>(unexpectedResults));
+                   state.setMetric("lost_vlans", static_cast<double>(lostVlans));
+                   state.setMetric("lost_member_ports", static_cast<double>(lostMemberPorts));
+               });
+}
@@ -0,0 +1,190 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+/// Fixed-size set of small integers stored as bits. Besides set-like interface (compatible
+/// with the subset of std::set used in this project) it offers word-parallel operations,
+/// so unions, differences and intersections of whole sets are cheap.
+template <size_t BITS, typename VALUE = size_t>
+class Bitmap {
+  public:
+    using Word = uint64_t;
+    static constexpr size_t BitsPerWord = 64;
+    static constexpr size_t WordsCount = (BITS + BitsPerWord - 1) / BitsPerWord;
+    using value_type = VALUE;
+
+    class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = VALUE;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const VALUE*;
+        using reference = VALUE;
+
+        const_iterator(const Bitmap* bitmap, const size_t bit) : _bitmap { bitmap }, _bit { bit } {}
+        VALUE operator*() const { return static_cast<VALUE>(_bit); }
+        const_iterator& operator++() { _bit = _bitmap->findNext(_bit + 1); return *this; }
+        const_iterator operator++(int) { auto previous = *this; ++(*this); return previous; }
+        bool operator==(const const_iterator& other) const { return _bit == other._bit; }
+        bool operator!=(const const_iterator& other) const { return _bit != other._bit; }
+
+      private:
+        const Bitmap* _bitmap;
+        size_t _bit;
+    };
+
+    using iterator = const_iterator;
+
+    constexpr Bitmap() : _words {} {}
+
+    static constexpr size_t capacity() { return BITS; }
+    static constexpr bool isValid(const VALUE value) { return static_cast<size_t>(value) < BITS; }
+
+    bool test(const VALUE value) const {
+        const auto bit = static_cast<size_t>(value);
+        return (bit < BITS) && (_words[bit / BitsPerWord] & (Word { 1 } << (bit % BitsPerWord)));
+    }
+
+    void set(const VALUE value) {
+        const auto bit = checkedBit(value);
+        _words[bit / BitsPerWord] |= Word { 1 } << (bit % BitsPerWord);
+    }
+
+    void reset(const VALUE value) {
+        const auto bit = static_cast<size_t>(value);
+        if (bit < BITS) {
+            _words[bit / BitsPerWord] &= ~(Word { 1 } << (bit % BitsPerWord));
+        }
+    }
+
+    /// Sets all bits from @p first to @p last inclusive, word by word
+    void setRange(const VALUE first, const VALUE last) {
+        const auto firstBit = checkedBit(first);
+        const auto lastBit = checkedBit(last);
+        for (size_t bit = firstBit; bit <= lastBit; bit = (bit / BitsPerWord + 1) * BitsPerWord) {
+            const size_t wordIndex = bit / BitsPerWord;
+            const size_t wordLastBit = std::min(lastBit - wordIndex * BitsPerWord, BitsPerWord - 1);
+            _words[wordIndex] |= (~Word { 0 } << (bit % BitsPerWord)) & (~Word { 0 } >> (BitsPerWord - 1 - wordLastBit));
+        }
+    }
+
+    // std::set compatible interface
+    size_t count(const VALUE value) const { return test(value) ? 1 : 0; }
+    bool emplace(const VALUE value) {
+        const bool inserted = not test(value);
+        set(value);
+        return inserted;
+    }
+
+    size_t erase(const VALUE value) {
+        const size_t erased = count(value);
+        reset(value);
+        return erased;
+    }
+
+    void clear() { _words.fill(0); }
+
+    bool empty() const {
+        for (const auto word : _words) {
+            if (word) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t size() const {
+        size_t bits = 0;
+        for (const auto word : _words) {
+            bits += static_cast<size_t>(__builtin_popcountll(word));
+        }
+
+        return bits;
+    }
+
+    const_iterator begin() const { return const_iterator { this, findNext(0) }; }
+    const_iterator end() const { return const_iterator { this, BITS }; }
+
+    // Word-parallel operations
+    Bitmap& operator|=(const Bitmap& other) {
+        for (size_t word = 0; word < WordsCount; ++word) {
+            _words[word] |= other._words[word];
+        }
+
+        return *this;
+    }
+
+    Bitmap& operator&=(const Bitmap& other) {
+        for (size_t word = 0; word < WordsCount; ++word) {
+            _words[word] &= other._words[word];
+        }
+
+        return *this;
+    }
+
+    /// Removes all bits which are set in @p other
+    Bitmap& subtract(const Bitmap& other) {
+        for (size_t word = 0; word < WordsCount; ++word) {
+            _words[word] &= ~other._words[word];
+        }
+
+        return *this;
+    }
+
+    friend Bitmap operator|(Bitmap lhs, const Bitmap& rhs) { return lhs |= rhs; }
+    friend Bitmap operator&(Bitmap lhs, const Bitmap& rhs) { return lhs &= rhs; }
+    /// Returns bits set in @p lhs which are not set in @p rhs
+    friend Bitmap operator-(Bitmap lhs, const Bitmap& rhs) { return lhs.subtract(rhs); }
+    bool operator==(const Bitmap& other) const { return _words == other._words; }
+    bool operator!=(const Bitmap& other) const { return _words != other._words; }
+
+    Word getWord(const size_t word) const { return _words[word]; }
+    void setWord(const size_t word, const Word value) { _words[word] = value; }
+
+  private:
+    static size_t checkedBit(const VALUE value) {
+        const auto bit = static_cast<size_t>(value);
+        if (bit >= BITS) {
+            throw std::out_of_range { "Bitmap index out of range" };
+        }
+
+        return bit;
+    }
+
+    size_t findNext(size_t bit) const {
+        while (bit < BITS) {
+            const size_t wordIndex = bit / BitsPerWord;
+            const Word word = _words[wordIndex] & (~Word { 0 } << (bit % BitsPerWord));
+            if (word) {
+                const size_t found = wordIndex * BitsPerWord + static_cast<size_t>(__builtin_ctzll(word));
+                return found < BITS ? found : BITS;
+            }
+
+            bit = (wordIndex + 1) * BitsPerWord;
+        }
+
+        return BITS;
+    }
+
+    std::array<Word, WordsCount> _words;
+};
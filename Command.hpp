@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "CommandStorage.hpp"
 #include "LoggingFacility.hpp"
 #include "Types.hpp"
 
@@ -100,17 +101,22 @@ class UndoableCommand : public Command, public Revertable {
 };
 
 /// @note Decorator will extend behaviour of execute() and undo() methods
-template <typename TYPE, typename TYPE_ID, typename TYPE_HANDLE>
+/// Managed objects are owned by manager and referred by generational handles, see SlotHandle.
+/// @tparam STORAGE selects containers of managed objects (OrderedCommandStorage or DenseCommandStorage)
+template <typename TYPE, typename TYPE_ID, typename STORAGE = OrderedCommandStorage>
 class CommandManager : public UndoableCommand {
   public:
+    using ObjectHandle = SlotHandle<TYPE>;
+    using IdSet = typename STORAGE::template IdSet<TYPE_ID>;
+    using ObjectMap = typename STORAGE::template ObjectMap<TYPE_ID, TYPE>;
     virtual ~CommandManager() = default;
     Result::Value add(const TYPE_ID id) {
-        auto foundToRemovingIt = _toRemoving.find(id);
-        if (foundToRemovingIt != std::end(_toRemoving)) {
-            _toRemoving.erase(foundToRemovingIt);
+        if (not STORAGE::isValidId(id)) {
+            return Result::Value::Fail;
         }
 
-        if (_configured.find(id) != std::end(_configured)) {
+        _toRemoving.erase(id);
+        if (_configured.count(id) != 0) {
             return Result::Value::AlreadyExists;
         }
 
@@ -119,12 +125,8 @@ class CommandManager : public UndoableCommand {
     }
 
     Result::Value remove(const TYPE_ID id) {
-        auto foundToAddingIt = _toAdding.find(id);
-        if (foundToAddingIt != std::end(_toAdding)) {
-            _toAdding.erase(foundToAddingIt);
-        }
-
-        if (std::end(_configured) == _configured.find(id)) {
+        _toAdding.erase(id);
+        if (0 == _configured.count(id)) {
             return Result::Value::NotExists;
         }
 
@@ -138,15 +140,13 @@ class CommandManager : public UndoableCommand {
           _mementoAdded.clear();
           _mementoRemoved.clear();
           for (const auto id : _toRemoving) {
-              destroyHandle(_idToHandleMap[id]);
-              _idToHandleMap.erase(id);
+              _objects.erase(id);
               _configured.erase(id);
               _mementoRemoved.emplace(id);
           }
 
           for (const auto id : _toAdding) {
-              TYPE_HANDLE handle = createHandle(id);
-              _idToHandleMap.emplace(id, handle);
+              _objects.emplace(id, createObject(id));
               _configured.emplace(id);
               _mementoAdded.emplace(id);
           }
@@ -169,14 +169,12 @@ class CommandManager : public UndoableCommand {
         Result::Value result = Result::Value::Success;
         try {
           for (const auto id : _mementoAdded) {
-              destroyHandle(_idToHandleMap[id]);
-              _idToHandleMap.erase(id);
+              _objects.erase(id);
               _configured.erase(id);
           }
 
           for (const auto id : _mementoRemoved) {
-              TYPE_HANDLE handle = createHandle(id);
-              _idToHandleMap.emplace(id, handle);
+              _objects.emplace(id, createObject(id));
               _configured.emplace(id);
           }
         }
@@ -193,25 +191,30 @@ class CommandManager : public UndoableCommand {
     }
 
     bool exists(const TYPE_ID id) const {
-        return _idToHandleMap.find(id) != std::end(_idToHandleMap);
+        return _objects.count(id) != 0;
+    }
+
+    /// @return null handle if object doesn't exist
+    ObjectHandle getHandle(const TYPE_ID id) const {
+        return _objects.getHandle(id);
     }
 
-    TYPE_HANDLE& getHandle(const TYPE_ID id) {
-        return _idToHandleMap.at(id);
+    /// @return nullptr if object of @p handle has been removed
+    TYPE* get(const ObjectHandle handle) const {
+        return _objects.get(handle);
     }
 
     virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
 
   protected:
-    virtual TYPE_HANDLE createHandle(const TYPE_ID id) { return std::make_shared<TYPE>(id); }
-    virtual void destroyHandle(TYPE_HANDLE handle) { handle.reset(); }
-
-    std::map<TYPE_ID, TYPE_HANDLE> _idToHandleMap;
-    std::set<TYPE_ID> _toAdding;
-    std::set<TYPE_ID> _toRemoving;
-    std::set<TYPE_ID> _mementoAdded;
-    std::set<TYPE_ID> _mementoRemoved;
-    std::set<TYPE_ID> _configured;
+    virtual std::shared_ptr<TYPE> createObject(const TYPE_ID id) { return std::make_shared<TYPE>(id); }
+
+    ObjectMap _objects;
+    IdSet _toAdding;
+    IdSet _toRemoving;
+    IdSet _mementoAdded;
+    IdSet _mementoRemoved;
+    IdSet _configured;
 };
 
 NullResultCallback::NullResultCallback() { /* Nothing more to do */ }
@@ -0,0 +1,46 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Bitmap.hpp"
+#include "SlotMap.hpp"
+
+#include <set>
+
+/// Storage of objects managed by CommandManager kept in node-based containers.
+/// Suitable for sparse or unbounded ID spaces.
+struct OrderedCommandStorage {
+    template <typename TYPE_ID>
+    using IdSet = std::set<TYPE_ID>;
+    template <typename TYPE_ID, typename TYPE>
+    using ObjectMap = OrderedSlotMap<TYPE, TYPE_ID>;
+
+    template <typename TYPE_ID>
+    static constexpr bool isValidId(const TYPE_ID) { return true; }
+};
+
+/// Storage of objects managed by CommandManager kept in bitmaps and slot array indexed by ID.
+/// Suitable for small and bounded ID spaces like VLANs or ports. All of exists(), add(),
+/// remove() and resolving of handle are O(1) and iteration during commit is done word by word.
+template <size_t MAX_IDS>
+struct DenseCommandStorage {
+    template <typename TYPE_ID>
+    using IdSet = Bitmap<MAX_IDS, TYPE_ID>;
+    template <typename TYPE_ID, typename TYPE>
+    using ObjectMap = DenseSlotMap<TYPE, TYPE_ID, MAX_IDS>;
+
+    template <typename TYPE_ID>
+    static constexpr bool isValidId(const TYPE_ID id) { return static_cast<size_t>(id) < MAX_IDS; }
+};
@@ -0,0 +1,140 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "CommitScheduler.hpp"
+
+#include <algorithm>
+
+CommitScheduler::CommitScheduler() {
+    // Nothing more to do
+}
+
+const TopologicalSorting& CommitScheduler::getCommitDependencies() {
+    static const TopologicalSorting commitDependencies = [] {
+        TopologicalSorting dependencies {};
+        // Creating objects
+        dependencies.addDependency(CommitOrderingResolve::PortCreate, CommitOrderingResolve::PortInit);
+        dependencies.addDependency(CommitOrderingResolve::PortInit, CommitOrderingResolve::PortSet);
+        dependencies.addDependency(CommitOrderingResolve::PortInit, CommitOrderingResolve::PortSetWithoutDependencyToEnabledBreakoutMode);
+        dependencies.addDependency(CommitOrderingResolve::PortSetWithoutDependencyToEnabledBreakoutMode,
+                                   CommitOrderingResolve::PortSetWithDependencyToEnabledBreakoutMode);
+        dependencies.addDependency(CommitOrderingResolve::PortInit, CommitOrderingResolve::PortSetWithoutDependencyToActiveLagMember);
+        dependencies.addDependency(CommitOrderingResolve::PortInit, CommitOrderingResolve::LagCreate);
+        dependencies.addDependency(CommitOrderingResolve::LagCreate, CommitOrderingResolve::PortSetWithDependencyToActiveLagMember);
+        dependencies.addDependency(CommitOrderingResolve::VlanCreate, CommitOrderingResolve::StpCreate);
+        dependencies.addDependency(CommitOrderingResolve::VlanCreate, CommitOrderingResolve::VlanAddMemberPorts);
+        dependencies.addDependency(CommitOrderingResolve::PortInit, CommitOrderingResolve::VlanAddMemberPorts);
+        dependencies.addDependency(CommitOrderingResolve::LagCreate, CommitOrderingResolve::VlanAddMemberPorts);
+        // Removing member ports has to free place for new ones
+        dependencies.addDependency(CommitOrderingResolve::VlanRemoveMemberPorts, CommitOrderingResolve::VlanAddMemberPorts);
+        // Deleting objects
+        dependencies.addDependency(CommitOrderingResolve::VlanRemoveMemberPorts, CommitOrderingResolve::FdbFlush);
+        dependencies.addDependency(CommitOrderingResolve::VlanRemoveMemberPorts, CommitOrderingResolve::VlanDelete);
+        // One member ports setting carries also removing of ports from deleted VLANs
+        dependencies.addDependency(CommitOrderingResolve::VlanAddMemberPorts, CommitOrderingResolve::VlanDelete);
+        dependencies.addDependency(CommitOrderingResolve::VlanRemoveMemberPorts, CommitOrderingResolve::LagDelete);
+        dependencies.addDependency(CommitOrderingResolve::StpDelete, CommitOrderingResolve::VlanDelete);
+        dependencies.addDependency(CommitOrderingResolve::FdbFlush, CommitOrderingResolve::PortDeinit);
+        dependencies.addDependency(CommitOrderingResolve::LagDelete, CommitOrderingResolve::PortDeinit);
+        dependencies.addDependency(CommitOrderingResolve::PortDeinit, CommitOrderingResolve::PortDelete);
+        return dependencies;
+    }();
+
+    return commitDependencies;
+}
+
+void CommitScheduler::addCommand(Command::Handle command) {
+    _commands.emplace_back(std::move(command));
+}
+
+Result::Value CommitScheduler::getExecutionLevels(std::vector<ExecutionLevel>& levels) const {
+    std::map<TopologicalSorting::Vertex, ExecutionLevel> commandsByResolve {};
+    std::set<TopologicalSorting::Vertex> resolves {};
+    for (const auto& command : _commands) {
+        const auto resolve = command->getCommitOrderingResolve();
+        commandsByResolve[resolve].push_back(command);
+        resolves.emplace(resolve);
+    }
+
+    std::vector<TopologicalSorting::Level> resolveLevels {};
+    if (Result::Failed(getCommitDependencies().sortIntoLevels(resolves, resolveLevels))) {
+        return Result::Value::Fail;
+    }
+
+    levels.clear();
+    levels.reserve(resolveLevels.size());
+    for (const auto& resolveLevel : resolveLevels) {
+        ExecutionLevel level {};
+        for (const auto resolve : resolveLevel) {
+            auto& commands = commandsByResolve[resolve];
+            level.insert(std::end(level), std::begin(commands), std::end(commands));
+        }
+
+        levels.emplace_back(std::move(level));
+    }
+
+    return Result::Value::Success;
+}
+
+size_t CommitScheduler::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::Unordered;
+}
+
+Result::Value CommitScheduler::execute(ResultCallback::Handle& callback) {
+    std::vector<ExecutionLevel> levels {};
+    auto result = getExecutionLevels(levels);
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(result, callback);
+
+    _executed.clear();
+    for (auto& level : levels) {
+        for (auto& command : level) {
+            result = command->execute();
+            if (Result::Failed(result)) {
+                undoExecuted();
+                _commands.clear();
+                CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(result, callback);
+            }
+
+            _executed.push_back(command);
+        }
+    }
+
+    _commands.clear();
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+Result::Value CommitScheduler::undo(ResultCallback::Handle& callback) {
+    if (_executed.empty()) {
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(Result::Value::CommandNotUndoable, callback);
+    }
+
+    // Macro evaluates its argument more than once, second undo would hide failure of the first one
+    const auto result = undoExecuted();
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+}
+
+Result::Value CommitScheduler::undoExecuted() {
+    Result::Value result = Result::Value::Success;
+    // Dependent commands have to be reverted before commands they depend on
+    std::for_each(std::rbegin(_executed), std::rend(_executed), [&result](Command::Handle& command) {
+        if (auto undoableCommand = std::dynamic_pointer_cast<UndoableCommand>(command)) {
+            if (Result::Failed(undoableCommand->undo())) {
+                result = Result::Value::Fail;
+            }
+        }
+    });
+
+    _executed.clear();
+    return result;
+}
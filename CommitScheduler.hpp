@@ -0,0 +1,46 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Command.hpp"
+#include "TopologicalSorting.hpp"
+
+#include <vector>
+
+/// Orders batch of commands according to their CommitOrderingResolve and executes them
+/// level by level. Commands in the same level do not depend on each other, so they can be
+/// dispatched together to the ASIC.
+class CommitScheduler final : public UndoableCommand {
+  public:
+    using Handle = std::shared_ptr<CommitScheduler>;
+    using ExecutionLevel = std::vector<Command::Handle>;
+    CommitScheduler();
+    virtual ~CommitScheduler() override = default;
+    void addCommand(Command::Handle command);
+    /// @retval Result::Value::Fail if dependencies between commands contain cycle
+    Result::Value getExecutionLevels(std::vector<ExecutionLevel>& levels) const;
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Executes all added commands. On failure all already executed undoable commands
+    /// are reverted in reverse order.
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override;
+
+  private:
+    static const TopologicalSorting& getCommitDependencies();
+    Result::Value undoExecuted();
+
+    std::vector<Command::Handle> _commands;
+    std::vector<Command::Handle> _executed; // Memento of commands executed in last commit
+};
@@ -0,0 +1,162 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "EventBus.hpp"
+
+#include <algorithm>
+
+EventBus::EventBus(const size_t workersCount)
+    : _workersCount { std::max<size_t>(workersCount, 1) }, _running { false }, _busyMailboxesCount { 0 }, _statistics {} {
+    // Nothing more to do
+}
+
+EventBus::~EventBus() {
+    stop();
+}
+
+Result::Value EventBus::start() {
+    std::lock_guard<std::mutex> lock { _mtx };
+    if (_running) {
+        return Result::Value::AlreadyExists;
+    }
+
+    _running = true;
+    for (size_t worker = 0; worker < _workersCount; ++worker) {
+        _workers.emplace_back(&EventBus::runWorker, this);
+    }
+
+    return Result::Value::Success;
+}
+
+void EventBus::stop() {
+    {
+        std::lock_guard<std::mutex> lock { _mtx };
+        if (not _running) {
+            return;
+        }
+
+        _running = false;
+    }
+
+    _mailboxReady.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+
+    _workers.clear();
+}
+
+bool EventBus::supersedes(const UpdateReason laterReason, const UpdateReason earlierReason) {
+    switch (laterReason) {
+      case UpdateReason::LagDown:
+      case UpdateReason::LagUp:
+        return (UpdateReason::LagDown == earlierReason) || (UpdateReason::LagUp == earlierReason);
+      case UpdateReason::PortDown:
+      case UpdateReason::PortUp:
+        return (UpdateReason::PortDown == earlierReason) || (UpdateReason::PortUp == earlierReason);
+      case UpdateReason::VlanCreate:
+      case UpdateReason::VlanDestroy:
+        return (UpdateReason::VlanCreate == earlierReason) || (UpdateReason::VlanDestroy == earlierReason);
+      default:
+        // Observer reads the latest state of subject, so one update is enough. Link events aren't
+        // read from subject, publish() merges them.
+        return laterReason == earlierReason;
+    }
+}
+
+void EventBus::publish(const Observer::Handle& observer, const ObservedSubjectHandle& subject, const UpdateReason updateReason,
+                       const LinkEventBatch::Handle& linkEvents) {
+    std::unique_lock<std::mutex> lock { _mtx };
+    ++_statistics.published;
+    auto& mailbox = _mailboxes[observer->getObserverId()];
+    if (not mailbox) {
+        mailbox = std::make_shared<Mailbox>();
+        mailbox->observer = observer;
+        mailbox->scheduled = false;
+    }
+
+    auto& events = mailbox->events;
+    const auto supersededIt = std::find_if(std::begin(events), std::end(events), [&subject, updateReason](const Event& event) {
+        return (event.subject == subject) && supersedes(updateReason, event.updateReason);
+    });
+    LinkEventBatch::Handle eventLinkEvents { linkEvents };
+    if (supersededIt != std::end(events)) {
+        // Events of both updates are kept in order they were notified
+        if (supersededIt->linkEvents && linkEvents) {
+            eventLinkEvents = LinkEventBatch::merge(*supersededIt->linkEvents, *linkEvents);
+        } else if (supersededIt->linkEvents) {
+            eventLinkEvents = supersededIt->linkEvents;
+        }
+
+        // Superseding update takes the latest position, so order of updates from one subject is kept
+        events.erase(supersededIt);
+        ++_statistics.coalesced;
+    }
+
+    events.push_back(Event { subject, updateReason, std::move(eventLinkEvents) });
+    _statistics.maxMailboxDepth = std::max(_statistics.maxMailboxDepth, events.size());
+    if (mailbox->scheduled) {
+        return;
+    }
+
+    mailbox->scheduled = true;
+    ++_busyMailboxesCount;
+    _readyMailboxes.push_back(mailbox);
+    lock.unlock();
+    _mailboxReady.notify_one();
+}
+
+void EventBus::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock { _mtx };
+    _idle.wait(lock, [this] { return (0 == _busyMailboxesCount) || (not _running); });
+}
+
+EventBus::Statistics EventBus::getStatistics() const {
+    std::lock_guard<std::mutex> lock { _mtx };
+    return _statistics;
+}
+
+void EventBus::runWorker() {
+    std::unique_lock<std::mutex> lock { _mtx };
+    std::vector<Event> events {};
+    while (true) {
+        _mailboxReady.wait(lock, [this] { return (not _readyMailboxes.empty()) || (not _running); });
+        if (_readyMailboxes.empty()) {
+            break;
+        }
+
+        auto mailbox = _readyMailboxes.front();
+        _readyMailboxes.pop_front();
+        std::swap(events, mailbox->events);
+        lock.unlock();
+        for (const auto& event : events) {
+            mailbox->observer->dispatchUpdate(event.subject, event.updateReason, event.linkEvents);
+        }
+
+        lock.lock();
+        _statistics.delivered += events.size();
+        events.clear();
+        if (not mailbox->events.empty()) {
+            // Published during delivery, the other mailboxes go first
+            _readyMailboxes.push_back(mailbox);
+            continue;
+        }
+
+        mailbox->scheduled = false;
+        _mailboxes.erase(mailbox->observer->getObserverId());
+        if (0 == --_busyMailboxesCount) {
+            _idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Observer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// Delivers updates to observers asynchronously on pool of worker threads, so subject which raised
+/// event (e.g. link scan notifier) doesn't wait for slow observer (e.g. VLAN reprogramming).
+/// Each observer has own mailbox processed by one worker at the same time, so observer gets its
+/// updates in order of publication and is never called concurrently. Update is coalesced with
+/// not yet delivered update from the same subject which it supersedes, e.g. PortUp after PortDown.
+class EventBus final {
+  public:
+    using Handle = std::shared_ptr<EventBus>;
+    static constexpr size_t DefaultWorkersCount = 1;
+    struct Statistics {
+        uint64_t published;
+        uint64_t coalesced; // Dropped, because superseded by later update
+        uint64_t delivered;
+        size_t maxMailboxDepth;
+    };
+
+    explicit EventBus(const size_t workersCount = DefaultWorkersCount);
+    ~EventBus();
+    Result::Value start();
+    /// Delivers updates which have been already published and stops workers
+    void stop();
+    /// @note Updates published while bus is stopped are delivered after start()
+    /// Link events of link status update superseded by later one are merged into the later one
+    void publish(const Observer::Handle& observer, const ObservedSubjectHandle& subject, const UpdateReason updateReason,
+                 const LinkEventBatch::Handle& linkEvents = nullptr);
+    /// Blocks until all published updates are delivered
+    void waitUntilIdle();
+    Statistics getStatistics() const;
+
+  private:
+    struct Event {
+        ObservedSubjectHandle subject;
+        UpdateReason updateReason;
+        LinkEventBatch::Handle linkEvents; // Passed with link status update, subject has newer ones when event is delivered
+    };
+
+    struct Mailbox {
+        Observer::Handle observer;
+        std::vector<Event> events;
+        bool scheduled; // Queued for worker or being processed by worker
+    };
+
+    /// @return true if @p laterReason from the same subject makes @p earlierReason obsolete
+    static bool supersedes(const UpdateReason laterReason, const UpdateReason earlierReason);
+    void runWorker();
+
+    const size_t _workersCount;
+    mutable std::mutex _mtx;
+    std::condition_variable _mailboxReady;
+    std::condition_variable _idle;
+    bool _running;
+    size_t _busyMailboxesCount; // Scheduled mailboxes, idle if zero
+    std::unordered_map<ObserverId, std::shared_ptr<Mailbox>> _mailboxes; // Mailboxes with undelivered updates
+    std::deque<std::shared_ptr<Mailbox>> _readyMailboxes;
+    std::vector<std::thread> _workers;
+    Statistics _statistics;
+};
@@ -0,0 +1,51 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "EventNotifier.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventNotifier::EventNotifier()
+    : _eventFd { eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) } {
+    if (_eventFd < 0) {
+        throw std::runtime_error { "Failed to create event notifier" };
+    }
+}
+
+EventNotifier::~EventNotifier() {
+    close(_eventFd);
+}
+
+void EventNotifier::notify() noexcept {
+    const uint64_t event = 1;
+    // Counter saturation (EAGAIN) still means that waiting thread will be woken up
+    [[maybe_unused]] auto rc = write(_eventFd, &event, sizeof(event));
+}
+
+bool EventNotifier::wait(const std::chrono::milliseconds timeout) noexcept {
+    pollfd pfd { _eventFd, POLLIN, 0 };
+    const int rc = poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (rc <= 0) {
+        return false;
+    }
+
+    uint64_t events = 0;
+    [[maybe_unused]] auto readBytes = read(_eventFd, &events, sizeof(events));
+    return true;
+}
@@ -0,0 +1,35 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+
+/// Wakes up waiting thread without taking any user space lock and without allocation,
+/// so it is safe to be notified from SDK threads. Notifications are accumulated until
+/// waiting thread consumes them.
+class EventNotifier final {
+  public:
+    EventNotifier();
+    ~EventNotifier();
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+    void notify() noexcept;
+    /// @retval true if thread has been notified
+    /// @retval false if timeout expired
+    bool wait(const std::chrono::milliseconds timeout = std::chrono::milliseconds { -1 }) noexcept;
+
+  private:
+    int _eventFd;
+};
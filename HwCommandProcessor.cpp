@@ -14,29 +14,205 @@
 
 #include "HwCommandProcessor.hpp"
 
-Result HwCommandProcessor::addAddingLagMemberPortsToExecute(UndoableCommand::Handle cmdHandle) {
-    _addingLagMemberPorts.push(cmdHandle);
-    return Result::Success;
+#include <future>
+
+namespace {
+
+/// Runs action in ASIC thread and passes its result to thread which waits for it
+class WaitedCommand final : public Command {
+  public:
+    explicit WaitedCommand(std::function<Result::Value()> action) : _action { std::move(action) } { /* Nothing more to do */ }
+    virtual ~WaitedCommand() override = default;
+    std::future<Result::Value> getResult() { return _result.get_future(); }
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        Result::Value result = Result::Value::Fail;
+        try {
+            result = _action();
+        }
+        catch (...) {
+            ERROR_LOG("Command waited for has thrown exception");
+        }
+
+        _result.set_value(result);
+        callback->onCommandResult(result);
+        return result;
+    }
+
+  private:
+    std::function<Result::Value()> _action;
+    std::promise<Result::Value> _result;
+};
+
+} // namespace
+
+HwCommandProcessor::HwCommandProcessor(const size_t queueCapacity)
+    : _commands { queueCapacity }, _running { false }, _asicThreadId { std::thread::id {} },
+      _enqueuedCommands { 0 }, _rejectedCommands { 0 }, _executedCommands { 0 }, _failedCommands { 0 },
+      _batches { 0 }, _lastBatchSize { 0 }, _maxBatchSize { 0 }, _totalLatencyNs { 0 }, _maxLatencyNs { 0 } {
+    // Nothing more to do
+}
+
+HwCommandProcessor::~HwCommandProcessor() {
+    stop();
+}
+
+Result::Value HwCommandProcessor::start() {
+    if (_running.exchange(true)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    _asicThread = std::thread { &HwCommandProcessor::runCommandsProcessor, this };
+    return Result::Value::Success;
+}
+
+void HwCommandProcessor::stop() {
+    if (not _running.exchange(false)) {
+        return;
+    }
+
+    _commandsEnqueued.notify();
+    if (_asicThread.joinable()) {
+        _asicThread.join();
+    }
+
+    _asicThreadId.store(std::thread::id {}, std::memory_order_release);
+}
+
+Result::Value HwCommandProcessor::addCommandToExecute(Command::Handle command) {
+    if (not _commands.push(QueuedCommand { std::move(command), std::chrono::steady_clock::now() })) {
+        _rejectedCommands.fetch_add(1, std::memory_order_relaxed);
+        return Result::Value::NoMemory;
+    }
+
+    _enqueuedCommands.fetch_add(1, std::memory_order_relaxed);
+    _commandsEnqueued.notify();
+    return Result::Value::Success;
+}
+
+Result::Value HwCommandProcessor::addAddingLagMemberPortsToExecute(UndoableCommand::Handle cmdHandle) {
+    return addCommandToExecute(std::move(cmdHandle));
+}
+
+Result::Value HwCommandProcessor::addAddingVlanMemberPortsToExecute(UndoableCommand::Handle cmdHandle) {
+    return addCommandToExecute(std::move(cmdHandle));
+}
+
+Result::Value HwCommandProcessor::executeAndWait(Command::Handle command) {
+    return runAndWait([command] { return command->execute(); });
+}
+
+Result::Value HwCommandProcessor::undoAndWait(UndoableCommand::Handle command) {
+    return runAndWait([command] { return command->undo(); });
+}
+
+Result::Value HwCommandProcessor::runAndWait(std::function<Result::Value()> action) {
+    // Command executed by ASIC thread can't wait for itself
+    if (isAsicThread()) {
+        return action();
+    }
+
+    if (not _running.load(std::memory_order_acquire)) {
+        drainCommands();
+        return action();
+    }
+
+    auto waitedCommand = std::make_shared<WaitedCommand>(std::move(action));
+    auto result = waitedCommand->getResult();
+    const auto enqueueResult = addCommandToExecute(waitedCommand);
+    if (Result::Failed(enqueueResult)) {
+        return enqueueResult;
+    }
+
+    return result.get();
+}
+
+size_t HwCommandProcessor::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::Unordered;
+}
+
+Result::Value HwCommandProcessor::execute(ResultCallback::Handle& callback) {
+    // Queue has single consumer, so commands mustn't be popped concurrently with ASIC thread
+    if (_running.load(std::memory_order_acquire) && (not isAsicThread())) {
+        const auto result = runAndWait([] { return Result::Value::Success; });
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+    }
+
+    const auto result = executeBatch();
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
 }
 
-Result HwCommandProcessor::addAddingVlanMemberPortsToExecute(UndoableCommand::Handle cmdHandle) {
-    _addingVlanMemberPorts.push(cmdHandle);
-    return Result::Success;
+Result::Value HwCommandProcessor::executeBatch() {
+    Result::Value result = Result::Value::Success;
+    QueuedCommand queuedCommand {};
+    size_t batchSize = 0;
+    while ((batchSize < MaxBatchSize) && _commands.pop(queuedCommand)) {
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - queuedCommand.enqueuedAt).count();
+        _totalLatencyNs.fetch_add(latency, std::memory_order_relaxed);
+        if (latency > _maxLatencyNs.load(std::memory_order_relaxed)) {
+            _maxLatencyNs.store(latency, std::memory_order_relaxed);
+        }
+
+        if (Result::Failed(queuedCommand.command->execute())) {
+            _failedCommands.fetch_add(1, std::memory_order_relaxed);
+            result = Result::Value::Fail;
+        }
+
+        queuedCommand.command.reset();
+        ++batchSize;
+    }
+
+    if (batchSize > 0) {
+        _executedCommands.fetch_add(batchSize, std::memory_order_relaxed);
+        _batches.fetch_add(1, std::memory_order_relaxed);
+        _lastBatchSize.store(batchSize, std::memory_order_relaxed);
+        if (batchSize > _maxBatchSize.load(std::memory_order_relaxed)) {
+            _maxBatchSize.store(batchSize, std::memory_order_relaxed);
+        }
+    }
+
+    return result;
 }
 
-Result HwCommandProcessor::execute() {
-    // Implements Round-Robin scheduler for access to ASIC
-    /// @todo Lock _addingLagMemberPorts mutex
-    if (not _addingLagMemberPorts.empty()) {
-        _addingLagMemberPorts.front()->execute();
-        _addingLagMemberPorts.pop();
+void HwCommandProcessor::drainCommands() {
+    while (_commands.size() > 0) {
+        // Producer notifies after it has published its command, so don't spin on reserved position
+        if (not _commands.isFrontPublished()) {
+            _commandsEnqueued.wait();
+        }
+
+        executeBatch();
     }
+}
 
-    /// @todo Lock _addingVlanMemberPorts mutex
-    if (not _addingVlanMemberPorts.empty()) {
-        _addingVlanMemberPorts.front()->execute();
-        _addingVlanMemberPorts.pop();
+void HwCommandProcessor::runCommandsProcessor() {
+    _asicThreadId.store(std::this_thread::get_id(), std::memory_order_release);
+    while (_running.load(std::memory_order_acquire)) {
+        // Full batch means that more commands are probably waiting, so don't sleep. Position reserved
+        // by producer doesn't count, its notification comes once command is published.
+        if (not _commands.isFrontPublished()) {
+            _commandsEnqueued.wait();
+        }
+
+        executeBatch();
     }
 
-    return Result::Success;
+    // Drain commands enqueued before stop was requested
+    drainCommands();
+}
+
+HwCommandProcessor::Statistics HwCommandProcessor::getStatistics() const {
+    Statistics statistics {};
+    statistics.queueDepth = _commands.size();
+    statistics.enqueuedCommands = _enqueuedCommands.load(std::memory_order_relaxed);
+    statistics.rejectedCommands = _rejectedCommands.load(std::memory_order_relaxed);
+    statistics.executedCommands = _executedCommands.load(std::memory_order_relaxed);
+    statistics.failedCommands = _failedCommands.load(std::memory_order_relaxed);
+    statistics.batches = _batches.load(std::memory_order_relaxed);
+    statistics.lastBatchSize = _lastBatchSize.load(std::memory_order_relaxed);
+    statistics.maxBatchSize = _maxBatchSize.load(std::memory_order_relaxed);
+    statistics.totalEnqueueToExecuteLatency = std::chrono::nanoseconds { _totalLatencyNs.load(std::memory_order_relaxed) };
+    statistics.maxEnqueueToExecuteLatency = std::chrono::nanoseconds { _maxLatencyNs.load(std::memory_order_relaxed) };
+    return statistics;
 }
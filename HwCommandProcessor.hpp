@@ -15,27 +15,88 @@
 #pragma once
 
 #include "Command.hpp"
+#include "EventNotifier.hpp"
+#include "LockFreeQueue.hpp"
 
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
 
-class HwCommandProcessor : public Command {
+/// Serializes all requests to ASIC. Any thread (link scan notifier, configuration path,
+/// protocol daemons) can enqueue command without taking mutex. Commands are executed
+/// in batches by the single ASIC thread.
+class HwCommandProcessor final : public Command {
   public:
     using Handle = std::shared_ptr<HwCommandProcessor>;
-    ~HwCommandProcessor() = default;
-    Result addAddingVlanMemberPortsToExecute(UndoableCommand::Handle cmdHandle);
-    virtual void execute() override;
+    static constexpr size_t DefaultQueueCapacity = 4096;
+    static constexpr size_t MaxBatchSize = 256;
 
-    Result addCommandToExecute(Command::Handle command) {
-        _commands.push_back();
-    }
+    struct Statistics {
+        size_t queueDepth;
+        uint64_t enqueuedCommands;
+        uint64_t rejectedCommands; // Queue was full
+        uint64_t executedCommands;
+        uint64_t failedCommands;
+        uint64_t batches;
+        size_t lastBatchSize;
+        size_t maxBatchSize;
+        std::chrono::nanoseconds totalEnqueueToExecuteLatency;
+        std::chrono::nanoseconds maxEnqueueToExecuteLatency;
+    };
 
+    explicit HwCommandProcessor(const size_t queueCapacity = DefaultQueueCapacity);
+    virtual ~HwCommandProcessor() override;
+    /// Starts ASIC thread which runs runCommandsProcessor()
+    Result::Value start();
+    void stop();
+    /// @note Safe to be called concurrently from many threads
+    /// @retval Result::Value::NoMemory if queue is full
+    Result::Value addCommandToExecute(Command::Handle command);
+    Result::Value addAddingLagMemberPortsToExecute(UndoableCommand::Handle cmdHandle);
+    Result::Value addAddingVlanMemberPortsToExecute(UndoableCommand::Handle cmdHandle);
+    /// Executes @p command in ASIC thread after commands queued before it and waits for its result.
+    /// If ASIC thread is not running, queued commands and then @p command are executed in context of calling thread.
+    Result::Value executeAndWait(Command::Handle command);
+    /// Reverts @p command the same way as executeAndWait() executes it
+    Result::Value undoAndWait(UndoableCommand::Handle command);
+    /// Runs @p action the same way as executeAndWait() executes command
+    Result::Value runAndWait(std::function<Result::Value()> action);
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Executes one batch of queued commands in context of calling thread. If ASIC thread is running,
+    /// only it executes commands, so then this waits until commands queued before are executed.
+    /// @note Has to be called only from one thread at the same time
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    Statistics getStatistics() const;
+
+  private:
+    struct QueuedCommand {
+        Command::Handle command;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    bool isAsicThread() const { return std::this_thread::get_id() == _asicThreadId.load(std::memory_order_acquire); }
+    /// Pops and executes at most MaxBatchSize commands, only consumer of the queue can call it
+    Result::Value executeBatch();
+    /// Executes commands until queue is empty, including commands which are being pushed
+    void drainCommands();
     /// runCommandsProcessor() is the function which will run in separated thread to execute directly
     /// request to ASIC.
     void runCommandsProcessor();
 
-  private:
-    std::priority_queue<Command::Handle> _commands;
-    std::queue<UndoableCommand::Handle> _addingLagMemberPorts;
-    std::queue<UndoableCommand::Handle> _addingVlanMemberPorts;
-};
+    BoundedMpscQueue<QueuedCommand> _commands;
+    EventNotifier _commandsEnqueued;
+    std::atomic<bool> _running;
+    std::thread _asicThread;
+    std::atomic<std::thread::id> _asicThreadId;
 
+    std::atomic<uint64_t> _enqueuedCommands;
+    std::atomic<uint64_t> _rejectedCommands;
+    std::atomic<uint64_t> _executedCommands;
+    std::atomic<uint64_t> _failedCommands;
+    std::atomic<uint64_t> _batches;
+    std::atomic<size_t> _lastBatchSize;
+    std::atomic<size_t> _maxBatchSize;
+    std::atomic<int64_t> _totalLatencyNs;
+    std::atomic<int64_t> _maxLatencyNs;
+};
@@ -15,70 +15,560 @@
 #include "HwPort.hpp"
 
 #include "HwErrors.hpp"
+#include "LatencyTracer.hpp"
 #include "LoggingFacility.hpp"
 
+#include <algorithm>
+#include <array>
+
 extern "C" {
 #   include <opennsl/error.h>
 #   include <opennsl/l2.h>
 #   include <opennsl/port.h>
+#   include <opennsl/stat.h>
 #   include <opennsl/stg.h>
 }
 
-opennsl_port_t HwPort::Mapping::panelPortToHwPort(const PortId /* portNo */) {
-    return 0;
+HwPort& HwPort::setPortParameters(const PortParameters parameters) {
+    _parameters = parameters;
+    return *this;
 }
 
-PortId HwPort::Mapping::hwPortToPanelPort(const opennsl_port_t /* hwPort */) {
+struct SpeedToPortAbility {
+    PortSpeed speed;
+    uint32 ability;
+};
+
+static constexpr std::array<SpeedToPortAbility, 7> gSpeedToPortAbility {{
+    { PortSpeed::_1Gb, OPENNSL_PORT_ABILITY_1000MB },
+    { PortSpeed::_10Gb, OPENNSL_PORT_ABILITY_10GB },
+    { PortSpeed::_20Gb, OPENNSL_PORT_ABILITY_20GB },
+    { PortSpeed::_25Gb, OPENNSL_PORT_ABILITY_25GB },
+    { PortSpeed::_40Gb, OPENNSL_PORT_ABILITY_40GB },
+    { PortSpeed::_50Gb, OPENNSL_PORT_ABILITY_50GB },
+    { PortSpeed::_100Gb, OPENNSL_PORT_ABILITY_100GB }
+}};
+
+/// @retval 0 if speed is not supported
+static constexpr uint32 speedToPortAbility(const PortSpeed speed) {
+    for (const auto& speedToAbility : gSpeedToPortAbility) {
+        if (speedToAbility.speed == speed) {
+            return speedToAbility.ability;
+        }
+    }
+
     return 0;
 }
 
-HwPort& HwPort::setPortParameters(const PortParameters parameters) {
-    _parameters = parameters;
-    return *this;
+static_assert(speedToPortAbility(PortSpeed::_100Gb) == OPENNSL_PORT_ABILITY_100GB, "Invalid speed to port ability table");
+static_assert(speedToPortAbility(PortSpeed::_400Gb) == 0, "Unsupported speed has to be rejected");
+
+Result::Value HwPort::buildAutonegAdvertisement(opennsl_port_ability_t& advertAbility, const bool withFec) const {
+    const opennsl_port_t hwPort = Mapping::panelPortToHwPort(_parameters.portNo);
+    opennsl_port_ability_t portAbility;
+    opennsl_port_ability_t_init(&portAbility);
+    portAbility.fec = OPENNSL_PORT_ABILITY_FEC_NONE;
+    /// @todo We only support advertising one speed or all possible speeds at the moment.
+    if (PortSpeed::Max == _parameters.speed) {
+        // Full autonegotiation desired.  Get all possible speed/duplex values for this port from h/w, then filter out HD support.
+        if (not Result::Failed(HwPortAbilityCache::getLocalAbility(Asic::getDefaultHwUnit(), hwPort, portAbility))) {
+            // Mask out half-duplex support.
+            portAbility.speed_half_duplex = 0;
+        } else {
+            VLOG_ERR("Failed to get port %d ability", hwPort);
+            // Assume typical 100G port setting. Can't be worse than just exiting...
+            portAbility.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
+        }
+    } else {
+        portAbility.speed_full_duplex = speedToPortAbility(_parameters.speed);
+        if (0 == portAbility.speed_full_duplex) {
+            // Unsupported speed.
+            VLOG_ERR("Failed to configure unavailable speed %d",
+                     _parameters.speed);
+            return Result::Value::Fail;
+        }
+
+        if ((PortSpeed::_100Gb == _parameters.speed) && _parameters.fec) {
+            portAbility.fec = OPENNSL_PORT_ABILITY_FEC_CL91;
+        }
+    }
+
+    opennsl_port_ability_t_init(&advertAbility);
+    if (Result::Failed(HwPortAbilityCache::getAdvertAbility(Asic::getDefaultHwUnit(), hwPort, advertAbility))) {
+        VLOG_ERR("Failed to get port %d local advert", hwPort);
+        // Assume typical advertised ability.
+        advertAbility.pause = OPENNSL_PORT_ABILITY_PAUSE;
+    }
+
+    // Only change speed/duplex part of advertisement.
+    advertAbility.speed_full_duplex = portAbility.speed_full_duplex;
+    advertAbility.speed_half_duplex = portAbility.speed_half_duplex;
+    if (withFec) {
+        advertAbility.fec = portAbility.fec;
+    }
+
+    return Result::Value::Success;
+}
+
+std::array<std::vector<HwPortAbilityCache::Entry>, HwPortAbilityCache::MaxHwUnits> HwPortAbilityCache::_entries {};
+
+HwPortAbilityCache::Entry* HwPortAbilityCache::getEntry(const int hwUnit, const opennsl_port_t hwPort) {
+    if ((hwUnit < 0) || (hwUnit >= MaxHwUnits) || (hwPort < 0)) {
+        return nullptr;
+    }
+
+    auto& unitEntries = _entries[static_cast<size_t>(hwUnit)];
+    const auto index = static_cast<size_t>(hwPort);
+    return (index < unitEntries.size()) ? &unitEntries[index] : nullptr;
+}
+
+void HwPortAbilityCache::populate(const int hwUnit, const opennsl_port_t hwPort) {
+    invalidate(hwUnit, hwPort);
+    opennsl_port_ability_t ability;
+    getLocalAbility(hwUnit, hwPort, ability);
+    getAdvertAbility(hwUnit, hwPort, ability);
+}
+
+void HwPortAbilityCache::invalidate(const int hwUnit, const opennsl_port_t hwPort) {
+    if (auto entry = getEntry(hwUnit, hwPort)) {
+        entry->localAbilityValid = false;
+        entry->advertAbilityValid = false;
+    }
+}
+
+void HwPortAbilityCache::invalidateUnit(const int hwUnit) {
+    if ((hwUnit >= 0) && (hwUnit < MaxHwUnits)) {
+        for (auto& entry : _entries[static_cast<size_t>(hwUnit)]) {
+            entry.localAbilityValid = false;
+            entry.advertAbilityValid = false;
+        }
+    }
+}
+
+void HwPortAbilityCache::reserve(const int hwUnit, const size_t hwPortsCount) {
+    if ((hwUnit >= 0) && (hwUnit < MaxHwUnits)) {
+        auto& unitEntries = _entries[static_cast<size_t>(hwUnit)];
+        if (unitEntries.size() < hwPortsCount) {
+            unitEntries.resize(hwPortsCount, Entry {});
+        }
+    }
+}
+
+Result::Value HwPortAbilityCache::getLocalAbility(const int hwUnit, const opennsl_port_t hwPort, opennsl_port_ability_t& ability) {
+    auto entry = getEntry(hwUnit, hwPort);
+    if (not entry) {
+        opennsl_port_ability_t_init(&ability);
+        const int rc = opennsl_port_ability_local_get(hwUnit, hwPort, &ability);
+        return OPENNSL_FAILURE(rc) ? Result::Value::Fail : Result::Value::Success;
+    }
+
+    if (not entry->localAbilityValid) {
+        opennsl_port_ability_t_init(&entry->localAbility);
+        const int rc = opennsl_port_ability_local_get(hwUnit, hwPort, &entry->localAbility);
+        if (OPENNSL_FAILURE(rc)) {
+            return Result::Value::Fail;
+        }
+
+        entry->localAbilityValid = true;
+    }
+
+    ability = entry->localAbility;
+    return Result::Value::Success;
+}
+
+Result::Value HwPortAbilityCache::getAdvertAbility(const int hwUnit, const opennsl_port_t hwPort, opennsl_port_ability_t& ability) {
+    auto entry = getEntry(hwUnit, hwPort);
+    if (not entry) {
+        opennsl_port_ability_t_init(&ability);
+        const int rc = opennsl_port_ability_advert_get(hwUnit, hwPort, &ability);
+        return OPENNSL_FAILURE(rc) ? Result::Value::Fail : Result::Value::Success;
+    }
+
+    if (not entry->advertAbilityValid) {
+        opennsl_port_ability_t_init(&entry->advertAbility);
+        const int rc = opennsl_port_ability_advert_get(hwUnit, hwPort, &entry->advertAbility);
+        if (OPENNSL_FAILURE(rc)) {
+            return Result::Value::Fail;
+        }
+
+        entry->advertAbilityValid = true;
+    }
+
+    ability = entry->advertAbility;
+    return Result::Value::Success;
+}
+
+void HwPortAbilityCache::updateAdvertAbility(const int hwUnit, const opennsl_port_t hwPort, const opennsl_port_ability_t& ability) {
+    if (auto entry = getEntry(hwUnit, hwPort)) {
+        entry->advertAbility = ability;
+        entry->advertAbilityValid = true;
+    }
+}
+
+HwPortFdbFlushing::HwPortFdbFlushing()
+    : _scheduled { false }, _trunkOfPort(MaxPorts, NoTrunk), _statistics {} {
+    // Nothing more to do
+}
+
+void HwPortFdbFlushing::setHwCommandProcessor(HwCommandProcessor::Handle hwCommandProcessor) {
+    std::lock_guard<std::mutex> lock { _mtx };
+    _hwCommandProcessor = hwCommandProcessor;
 }
 
 HwPortFdbFlushing& HwPortFdbFlushing::addPortToFlushing(const PortId portNo) {
-    if (std::end(_portsToFlushing) == _portsToFlushing.find(portNo)) {
-        _portsToFlushing.emplace(portNo);
+    std::lock_guard<std::mutex> lock { _mtx };
+    if (portNo < MaxPorts) {
+        _portsToFlushing.set(portNo);
+        _notForwardingPorts.set(portNo);
+        ++_statistics.requestedPorts;
     }
 
     return *this;
 }
 
+Result::Value HwPortFdbFlushing::removePortFromFlushing(const PortId portNo) {
+    std::lock_guard<std::mutex> lock { _mtx };
+    if ((portNo >= MaxPorts) || (not _portsToFlushing.test(portNo))) {
+        return Result::Value::NotExists;
+    }
+
+    _portsToFlushing.reset(portNo);
+    return Result::Value::Success;
+}
+
+void HwPortFdbFlushing::setPortLinkedUp(const PortId portNo) {
+    std::lock_guard<std::mutex> lock { _mtx };
+    _notForwardingPorts.reset(portNo);
+}
+
+void HwPortFdbFlushing::setTrunkMemberPorts(const opennsl_trunk_t trunk, const PortBitmap& memberPorts) {
+    std::lock_guard<std::mutex> lock { _mtx };
+    PortBitmap previousMemberPorts {};
+    auto trunkMemberPortsIt = _trunkMemberPorts.find(trunk);
+    if (trunkMemberPortsIt != std::end(_trunkMemberPorts)) {
+        previousMemberPorts = trunkMemberPortsIt->second;
+        for (const auto portNo : previousMemberPorts) {
+            _trunkOfPort[portNo] = NoTrunk;
+        }
+    }
+
+    // MACs learned on trunk stay valid until its last forwarding member port is gone
+    const bool hadForwardingMemberPort = hasForwardingMemberPort(trunk);
+    if (memberPorts.empty()) {
+        _trunkMemberPorts.erase(trunk);
+    } else {
+        _trunkMemberPorts[trunk] = memberPorts;
+        for (const auto portNo : memberPorts) {
+            _trunkOfPort[portNo] = trunk;
+        }
+    }
+
+    if (hadForwardingMemberPort && (not hasForwardingMemberPort(trunk))) {
+        for (const auto portNo : previousMemberPorts) {
+            addTrunkToFlushing(_trunksToFlushing, Mapping::panelPortToHwUnit(portNo), trunk);
+        }
+    }
+}
+
+Result::Value HwPortFdbFlushing::commit(ResultCallback::Handle& callback) {
+    HwCommandProcessor::Handle hwCommandProcessor {};
+    {
+        std::lock_guard<std::mutex> lock { _mtx };
+        if (_scheduled || (_portsToFlushing.empty() && _trunksToFlushing.empty())) {
+            CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+        }
+
+        hwCommandProcessor = _hwCommandProcessor;
+        _scheduled = static_cast<bool>(hwCommandProcessor);
+    }
+
+    if (not hwCommandProcessor) {
+        return execute(callback);
+    }
+
+    const auto result = hwCommandProcessor->addCommandToExecute(shared_from_this());
+    if (Result::Failed(result)) {
+        // Collected ports stay pending, so they are flushed with next commit
+        std::lock_guard<std::mutex> lock { _mtx };
+        _scheduled = false;
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+}
+
 size_t HwPortFdbFlushing::getCommitOrderingResolve() const {
     return CommitOrderingResolve::FdbFlush;
 }
 
 Result::Value HwPortFdbFlushing::execute(ResultCallback::Handle& callback) {
-     opennsl_module_t mod = -1;
-     uint32 flags = 0;
+    PortBitmap portsToFlushing {};
+    PortBitmap requestedPorts {};
+    std::vector<HwUnitTrunk> trunksToFlushing {};
+    {
+        // Ports added from now on are flushed in next pass
+        std::lock_guard<std::mutex> lock { _mtx };
+        std::swap(portsToFlushing, _portsToFlushing);
+        std::swap(trunksToFlushing, _trunksToFlushing);
+        requestedPorts = portsToFlushing;
+        _scheduled = false;
+        ++_statistics.passes;
+        for (const auto portNo : portsToFlushing) {
+            const auto trunk = _trunkOfPort[portNo];
+            if (NoTrunk == trunk) {
+                continue;
+            }
+
+            portsToFlushing.reset(portNo);
+            if (hasForwardingMemberPort(trunk)) {
+                ++_statistics.skippedTrunkMemberPorts;
+                continue;
+            }
+
+            ++_statistics.flushedTrunkMemberPorts;
+            addTrunkToFlushing(trunksToFlushing, Mapping::panelPortToHwUnit(portNo), trunk);
+        }
+    }
+
+    opennsl_module_t mod = -1;
+    uint32 flags = 0;
+    // Flushing goes on after failure, so one port doesn't leave stale MACs of others
+    int firstFailure = OPENNSL_E_NONE;
+    for (const auto& hwUnitTrunk : trunksToFlushing) {
+        const auto rv = opennsl_l2_addr_delete_by_trunk(hwUnitTrunk.first, hwUnitTrunk.second, flags);
+        countSdkCall(rv);
+        firstFailure = OPENNSL_FAILURE(firstFailure) ? firstFailure : rv;
+    }
 
-    for (auto& portNo : _portsToFlushing) {
+    for (const auto portNo : portsToFlushing) {
         opennsl_port_t hwPort = Mapping::panelPortToHwPort(portNo);
-        auto rv = opennsl_l2_addr_delete_by_port(Asic::getDefaultHwUnit(), mod, hwPort, flags);
-        CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rv, callback);
+        const auto rv = opennsl_l2_addr_delete_by_port(Mapping::panelPortToHwUnit(portNo), mod, hwPort, flags);
+        countSdkCall(rv);
+        firstFailure = OPENNSL_FAILURE(firstFailure) ? firstFailure : rv;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { _mtx };
+        _statistics.flushedTrunks += trunksToFlushing.size();
+        _statistics.flushedPorts += portsToFlushing.size();
     }
 
-    _portsToFlushing.clear();
+    for (const auto portNo : requestedPorts) {
+        LatencyTracer::getInstance().traceFdbFlushed(Mapping::panelPortToHwUnit(portNo), Mapping::panelPortToHwPort(portNo));
+    }
+
+    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(firstFailure, callback);
     CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
 }
 
-size_t HwPortParametersSetting::getCommitOrderingResolve() const {
+HwPortFdbFlushing::Statistics HwPortFdbFlushing::getStatistics() const {
+    std::lock_guard<std::mutex> lock { _mtx };
+    return _statistics;
+}
+
+void HwPortFdbFlushing::countSdkCall(const int rv) {
+    if (OPENNSL_FAILURE(rv)) {
+        std::lock_guard<std::mutex> lock { _mtx };
+        ++_statistics.failedCalls;
+    }
+}
+
+bool HwPortFdbFlushing::hasForwardingMemberPort(const opennsl_trunk_t trunk) const {
+    const auto trunkMemberPortsIt = _trunkMemberPorts.find(trunk);
+    if (trunkMemberPortsIt == std::end(_trunkMemberPorts)) {
+        return false;
+    }
+
+    for (const auto portNo : trunkMemberPortsIt->second) {
+        if (not _notForwardingPorts.test(portNo)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HwPortFdbFlushing::addTrunkToFlushing(std::vector<HwUnitTrunk>& trunksToFlushing, const int hwUnit, const opennsl_trunk_t trunk) {
+    const HwUnitTrunk hwUnitTrunk { hwUnit, trunk };
+    if (std::find(std::begin(trunksToFlushing), std::end(trunksToFlushing), hwUnitTrunk) == std::end(trunksToFlushing)) {
+        trunksToFlushing.push_back(hwUnitTrunk);
+    }
+}
+
+opennsl_port_t HwPortAttributesSetting::getHwPort() const {
+    return Mapping::panelPortToHwPort(_parameters.portNo);
+}
+
+Result::Value HwPortAttributesSetting::execute(ResultCallback::Handle& callback) {
+    opennsl_port_info_t portInfo;
+    opennsl_port_info_t_init(&portInfo);
+    if (Result::Failed(buildPortInfo(portInfo))) {
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    // Program h/w with the given values.
+    const int rc = opennsl_port_selective_set(Asic::getDefaultHwUnit(), getHwPort(), &portInfo);
+    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rc, callback);
+    if (portInfo.action_mask & OPENNSL_PORT_ATTR_LOCAL_ADVERT_MASK) {
+        HwPortAbilityCache::updateAdvertAbility(Asic::getDefaultHwUnit(), getHwPort(), portInfo.local_ability);
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+HwPortAttributesCoalescing::HwPortAttributesCoalescing()
+    : _collectingThreadId { std::thread::id {} }, _statistics { } {
+    // Nothing more to do
+}
+
+Result::Value HwPortAttributesCoalescing::begin() {
+    auto notCollecting = std::thread::id {};
+    if (not _collectingThreadId.compare_exchange_strong(notCollecting, std::this_thread::get_id())) {
+        return isCollecting() ? Result::Value::Success : Result::Value::AlreadyExists;
+    }
+
+    _portResults.clear();
+    return Result::Value::Success;
+}
+
+bool HwPortAttributesCoalescing::isCollecting() const {
+    return std::this_thread::get_id() == _collectingThreadId.load();
+}
+
+Result::Value HwPortAttributesCoalescing::addPortSetting(HwPortAttributesSetting& setting) {
+    if (not isCollecting()) {
+        return Result::Value::Fail;
+    }
+
+    opennsl_port_info_t portInfo;
+    opennsl_port_info_t_init(&portInfo);
+    const auto result = setting.buildPortInfo(portInfo);
+    if (Result::Failed(result)) {
+        return result;
+    }
+
+    const auto hwPort = setting.getHwPort();
+    auto foundPortIt = _pendingPortInfos.find(hwPort);
+    if (foundPortIt == std::end(_pendingPortInfos)) {
+        _pendingPortInfos.emplace(hwPort, portInfo);
+    } else {
+        mergePortInfo(foundPortIt->second, portInfo);
+    }
+
+    ++_statistics.mergedSettings;
+    return Result::Value::Success;
+}
+
+void HwPortAttributesCoalescing::abort() {
+    if (not isCollecting()) {
+        return;
+    }
+
+    for (const auto& hwPortInfo : _pendingPortInfos) {
+        _portResults[hwPortInfo.first] = Result::Value::Fail;
+    }
+
+    _pendingPortInfos.clear();
+    _collectingThreadId.store(std::thread::id {});
+}
+
+void HwPortAttributesCoalescing::mergePortInfo(opennsl_port_info_t& target, const opennsl_port_info_t& source) {
+    // Later setting overrides only attributes which it has requested to change
+    if (source.action_mask & OPENNSL_PORT_ATTR_ENABLE_MASK) {
+        target.enable = source.enable;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_AUTONEG_MASK) {
+        target.autoneg = source.autoneg;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_SPEED_MASK) {
+        target.speed = source.speed;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_DUPLEX_MASK) {
+        target.duplex = source.duplex;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_LINKSCAN_MASK) {
+        target.linkscan = source.linkscan;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_PAUSE_RX_MASK) {
+        target.pause_rx = source.pause_rx;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_PAUSE_TX_MASK) {
+        target.pause_tx = source.pause_tx;
+    }
+
+    if (source.action_mask & OPENNSL_PORT_ATTR_LOCAL_ADVERT_MASK) {
+        target.local_ability = source.local_ability;
+    }
+
+    if (source.action_mask2 & OPENNSL_PORT_ATTR2_PORT_ABILITY) {
+        target.port_ability = source.port_ability;
+    }
+
+    target.action_mask |= source.action_mask;
+    target.action_mask2 |= source.action_mask2;
+}
+
+size_t HwPortAttributesCoalescing::getCommitOrderingResolve() const {
     return CommitOrderingResolve::PortSet;
 }
 
-Result::Value HwPortParametersSetting::execute(ResultCallback::Handle& callback) {
-    int rc = OPENNSL_E_NONE;
-    const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(_parameters.portNo);
-    opennsl_port_info_t bcm_pinfo;
-    opennsl_port_info_t_init(&bcm_pinfo);
+Result::Value HwPortAttributesCoalescing::execute(ResultCallback::Handle& callback) {
+    if (not isCollecting()) {
+        ERROR_LOG("Commit of port attributes has not been begun by calling thread");
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    auto pendingPortInfos = std::move(_pendingPortInfos);
+    _pendingPortInfos.clear();
+    _collectingThreadId.store(std::thread::id {});
+    // Failure of one port doesn't stop programming of the others, so none of collected settings is lost
+    Result::Value result = Result::Value::Success;
+    for (auto& hwPortInfo : pendingPortInfos) {
+        ++_statistics.sdkCalls;
+        const int rc = opennsl_port_selective_set(Asic::getDefaultHwUnit(), hwPortInfo.first, &hwPortInfo.second);
+        if (OPENNSL_FAILURE(rc)) {
+            ++_statistics.failedCalls;
+            ERROR_LOG(stringFormat("Failed to set attributes of h/w port %d: %s (%d)", hwPortInfo.first, opennsl_errmsg(rc), rc));
+            _portResults[hwPortInfo.first] = Result::Value::Fail;
+            result = Result::Value::Fail;
+            continue;
+        }
+
+        _portResults[hwPortInfo.first] = Result::Value::Success;
+
+        if (hwPortInfo.second.action_mask & OPENNSL_PORT_ATTR_LOCAL_ADVERT_MASK) {
+            HwPortAbilityCache::updateAdvertAbility(Asic::getDefaultHwUnit(), hwPortInfo.first, hwPortInfo.second.local_ability);
+        }
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+}
+
+HwPortAttributesCoalescing::Statistics HwPortAttributesCoalescing::getStatistics() const {
+    return _statistics;
+}
+
+HwPortParametersSetting& HwPortParametersSetting::setPortParameters(const PortParameters& parameters) {
+    HwPort::setPortParameters(parameters);
+    return *this;
+}
+
+size_t HwPortParametersSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::PortSet;
+}
 
+Result::Value HwPortParametersSetting::buildPortInfo(opennsl_port_info_t& bcm_pinfo) {
     // Whether we are enabling or disabling, we need to set the operational state (ENABLE) flag.
     bcm_pinfo.action_mask |= OPENNSL_PORT_ATTR_ENABLE_MASK;
 
     if (not _parameters.shutdowned) {
         DEBUG_LOG("Enabling hw_port=%d, autoneg=%d, duplex=%d",
-                   hwPort, _parameters.autoneg, _parameters.fullDuplex);
+                   getHwPort(), _parameters.autoneg, _parameters.fullDuplex);
 
         bcm_pinfo.enable = TRUE;
 
@@ -87,67 +577,11 @@ Result::Value HwPortParametersSetting::execute(ResultCallback::Handle& callback)
         // We are enabling the port, so need to configure speed, duplex, pause, and autoneg as requested.
         /// @note half-duplex is not supported.
         if (_parameters.autoneg) {
-            opennsl_port_ability_t port_ability;
             opennsl_port_ability_t advert_ability;
-
-            opennsl_port_ability_t_init(&port_ability);
-            opennsl_port_ability_t_init(&advert_ability);
-
-            port_ability.fec = OPENNSL_PORT_ABILITY_FEC_NONE;
-            /// @todo We only support advertising one speed or all possible speeds at the moment.
-            if (PortSpeed::Max == _parameters.speed) {
-                // Full autonegotiation desired.  Get all possible speed/duplex values for this port from h/w, then filter out HD support.
-                rc = opennsl_port_ability_local_get(Asic::getDefaultHwUnit(), hwPort, &port_ability);
-                if (OPENNSL_SUCCESS(rc)) {
-                    // Mask out half-duplex support.
-                    port_ability.speed_half_duplex = 0;
-                } else {
-                    VLOG_ERR("Failed to get port %d ability", hwPort);
-                    // Assume typical 100G port setting. Can't be worse than just exiting...
-                    port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-                }
-            }
-            else if (PortSpeed::_1Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_1000MB;
-            }
-            else if (PortSpeed::_10Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_10GB;
-            }
-            else if (PortSpeed::_20Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_20GB;
-            }
-            else if (PortSpeed::_25Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_25GB;
-            }
-            else if (PortSpeed::_40Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_40GB;
-            }
-            else if (PortSpeed::_50Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_50GB;
-            }
-            else if (PortSpeed::_100Gb == _parameters.speed) {
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-                if (_parameters.fec) {
-                    port_ability.fec = OPENNSL_PORT_ABILITY_FEC_CL91;
-                }
-            } else {
-                // Unsupported speed.
-                VLOG_ERR("Failed to configure unavailable speed %d",
-                         _parameters.speed);
-                CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+            if (Result::Failed(buildAutonegAdvertisement(advert_ability, false))) {
+                return Result::Value::Fail;
             }
 
-            rc = opennsl_port_ability_advert_get(Asic::getDefaultHwUnit(), hwPort, &advert_ability);
-            if (OPENNSL_FAILURE(rc)) {
-                VLOG_ERR("Failed to get port %d local advert", hw_port);
-                // Assume typical advertised ability.
-                advert_ability.pause = OPENNSL_PORT_ABILITY_PAUSE;
-            }
-
-            // Only change speed/duplex part of advertisement.
-            advert_ability.speed_full_duplex = port_ability.speed_full_duplex;
-            advert_ability.speed_half_duplex = port_ability.speed_half_duplex;
-
             // Update flow control (pause) advertisement.
             if (_parameters.rxPause) {
                 advert_ability.pause |= OPENNSL_PORT_ABILITY_PAUSE_RX;
@@ -187,18 +621,306 @@ Result::Value HwPortParametersSetting::execute(ResultCallback::Handle& callback)
     } else {
         //For 100G support, need to remove autoneg, during no shut
         //Otherwise shut/no-shut wont work
-        DEBUG_LOG("Disabling hw_port=%d", hwPort);
+        DEBUG_LOG("Disabling hw_port=%d", getHwPort());
         bcm_pinfo.enable = 0;
         bcm_pinfo.autoneg = FALSE;
         bcm_pinfo.action_mask  |= OPENNSL_PORT_ATTR_AUTONEG_MASK;
     }
 
-    // Program h/w with the given values.
-    rc = opennsl_port_selective_set(Asic::getDefaultHwUnit(), hwPort, &bcm_pinfo);
-    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rc, callback);
+    return Result::Value::Success;
+}
+
+int HwPortLinkScanModeSetting::toOpenNslLinkScanMode(const LinkScanMode linkScanMode) {
+    return (LinkScanMode::Hardware == linkScanMode) ? OPENNSL_LINKSCAN_MODE_HW : OPENNSL_LINKSCAN_MODE_SW;
+}
+
+size_t HwPortLinkScanModeSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::PortSet;
+}
+
+Result::Value HwPortLinkScanModeSetting::buildPortInfo(opennsl_port_info_t& portInfo) {
+    portInfo.linkscan = toOpenNslLinkScanMode(_parameters.linkScanMode);
+    portInfo.action_mask |= OPENNSL_PORT_ATTR_LINKSCAN_MASK;
+    return Result::Value::Success;
+}
+
+struct SplitModeLanes {
+    PortSplitMode splitMode;
+    uint8_t lanesPerPort;
+    PortSpeed speed;
+};
+
+/// Indexed by split mode
+static constexpr std::array<SplitModeLanes, 6> gSplitModeLanes {{
+    { PortSplitMode::None, MaxSlavePorts, PortSpeed::Max },
+    { PortSplitMode::_4x10G, 1, PortSpeed::_10Gb },
+    { PortSplitMode::_4x25G, 1, PortSpeed::_25Gb },
+    { PortSplitMode::_2x50G, 2, PortSpeed::_50Gb },
+    { PortSplitMode::_4x100, 1, PortSpeed::_100Gb },
+    { PortSplitMode::_2x200, 2, PortSpeed::_200Gb }
+}};
+
+static_assert(gSplitModeLanes.back().splitMode == PortSplitMode::_2x200, "Split modes are not indexed by their value");
+
+static const SplitModeLanes& getSplitModeLanes(const PortSplitMode splitMode) {
+    return gSplitModeLanes[std::min(static_cast<size_t>(splitMode), gSplitModeLanes.size() - 1)];
+}
+
+HwPortBreakoutSetting::HwPortBreakoutSetting()
+    : _linkScanMode { LinkScanMode::Software }, _laneActions {} {
+    // Nothing more to do
+}
+
+uint8_t HwPortBreakoutSetting::getLanesPerPort(const PortSplitMode splitMode) {
+    return getSplitModeLanes(splitMode).lanesPerPort;
+}
+
+PortSpeed HwPortBreakoutSetting::getSplitPortSpeed(const PortSplitMode splitMode) {
+    return getSplitModeLanes(splitMode).speed;
+}
+
+PortLaneNo HwPortBreakoutSetting::getLaneNo(const PortSplitMode splitMode, const size_t lane) {
+    switch (getLanesPerPort(splitMode)) {
+      case 1:
+            return static_cast<PortLaneNo>(static_cast<size_t>(PortLaneNo::Lane_1) + lane);
+      case 2:
+            return (lane < 2) ? PortLaneNo::Lane_1_2 : PortLaneNo::Lane_3_4;
+      default:
+            return PortLaneNo {}; // Port is not split
+    }
+}
+
+HwPortBreakoutSetting::LaneActions HwPortBreakoutSetting::planLaneActions(const PortSplitMode fromSplitMode, const PortSplitMode toSplitMode) {
+    const auto fromLanesPerPort = getLanesPerPort(fromSplitMode);
+    const auto toLanesPerPort = getLanesPerPort(toSplitMode);
+    LaneActions laneActions {};
+    for (size_t lane = 0; lane < laneActions.size(); ++lane) {
+        const bool portBefore = (lane % fromLanesPerPort) == 0;
+        const bool portAfter = (lane % toLanesPerPort) == 0;
+        if (portBefore && portAfter) {
+            if (fromLanesPerPort != toLanesPerPort) {
+                laneActions[lane] = LaneAction::Reinit;
+            }
+            else {
+                laneActions[lane] = (getSplitPortSpeed(fromSplitMode) == getSplitPortSpeed(toSplitMode)) ? LaneAction::Keep : LaneAction::SpeedSet;
+            }
+        }
+        else if (portBefore) {
+            laneActions[lane] = LaneAction::Delete;
+        }
+        else if (portAfter) {
+            laneActions[lane] = LaneAction::Create;
+        }
+        else {
+            laneActions[lane] = LaneAction::None;
+        }
+    }
+
+    return laneActions;
+}
+
+HwPortBreakoutSetting& HwPortBreakoutSetting::setLinkScanMode(const LinkScanMode linkScanMode) {
+    _linkScanMode = linkScanMode;
+    return *this;
+}
+
+size_t HwPortBreakoutSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::PortSettingToEnabledBreakoutMode;
+}
+
+Result::Value HwPortBreakoutSetting::execute(ResultCallback::Handle& callback) {
+    auto& hwPortMapping = OpenNos::HwPortMapping::getInstance();
+    const PortId parentPort = _parameters.portNo;
+    const auto& parentPortLayout = hwPortMapping.getPortLayout(parentPort);
+    if (parentPortLayout.parentPort != parentPort) {
+        ERROR_LOG(stringFormat("Port %hu is not parent of lane group", parentPort));
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    const PortSplitMode fromSplitMode = parentPortLayout.splitMode;
+    const PortSplitMode toSplitMode = _parameters.splitMode;
+    const auto slavePorts = parentPortLayout.slavePorts;
+    _laneActions = planLaneActions(fromSplitMode, toSplitMode);
+    HwPorts hwPorts {};
+    for (size_t lane = 0; lane < hwPorts.size(); ++lane) {
+        hwPorts[lane] = hwPortMapping.panelPortToHwPort(slavePorts[lane]);
+        if ((_laneActions[lane] != LaneAction::None) && (hwPorts[lane] == OpenNos::HwPortMapping::InvalidHwPort)) {
+            ERROR_LOG(stringFormat("Lane %zu of port %hu is not wired to h/w port", lane + 1, parentPort));
+            CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(Result::Value::NotSupported, callback);
+        }
+    }
+
+    const int hwUnit = Asic::getDefaultHwUnit();
+    std::vector<AppliedStep> appliedSteps;
+    appliedSteps.reserve(3 * MaxSlavePorts + 1);
+    auto applied = [&](const int rv, const Step step, const size_t lane) {
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to change lane %zu of port %hu: %s (%d)", lane + 1, parentPort, opennsl_errmsg(rv), rv));
+            revert(hwPorts, slavePorts, fromSplitMode, appliedSteps);
+            return false;
+        }
+
+        appliedSteps.push_back({ step, lane });
+        return true;
+    };
+
+    // Ports which lose their lanes are stopped first, so no traffic is sent over lanes being reassigned
+    for (size_t lane = 0; lane < hwPorts.size(); ++lane) {
+        if ((_laneActions[lane] == LaneAction::Delete) || (_laneActions[lane] == LaneAction::Reinit)) {
+            if (not applied(stopPort(hwUnit, hwPorts[lane]), Step::Stopped, lane)) {
+                CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+            }
+
+            HwPortAbilityCache::invalidate(hwUnit, hwPorts[lane]);
+        }
+    }
+
+    const auto toLanesPerPort = getLanesPerPort(toSplitMode);
+    for (size_t lane = 0; lane < hwPorts.size(); ++lane) {
+        if ((_laneActions[lane] == LaneAction::Reinit) || (_laneActions[lane] == LaneAction::Create)) {
+            if (not applied(opennsl_port_control_set(hwUnit, hwPorts[lane], opennslPortControlLanes, toLanesPerPort), Step::LanesSet, lane)) {
+                CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+            }
+        }
+    }
+
+    // Lanes are reassigned now, so mapping has to follow
+    setLaneGroupLayout(slavePorts, toSplitMode);
+    appliedSteps.push_back({ Step::LayoutSet, 0 });
+
+    for (size_t lane = 0; lane < hwPorts.size(); ++lane) {
+        const opennsl_port_t hwPort = hwPorts[lane];
+        if ((_laneActions[lane] == LaneAction::Reinit) || (_laneActions[lane] == LaneAction::Create)) {
+            if (not applied(initPort(hwUnit, hwPort, toSplitMode), Step::Initialized, lane)) {
+                CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+            }
+        }
+        else if (_laneActions[lane] == LaneAction::SpeedSet) {
+            if (not applied(setPortSpeed(hwUnit, hwPort, toSplitMode), Step::SpeedSet, lane)) {
+                CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+            }
+
+            // Abilities depend on speed of lanes, they are read again on next request
+            HwPortAbilityCache::invalidate(hwUnit, hwPort);
+        }
+    }
+
     CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
 }
 
+int HwPortBreakoutSetting::stopPort(const int hwUnit, const opennsl_port_t hwPort) {
+    opennsl_port_info_t portInfo {};
+    opennsl_port_info_t_init(&portInfo);
+    portInfo.enable = FALSE;
+    portInfo.linkscan = OPENNSL_LINKSCAN_MODE_NONE;
+    portInfo.action_mask = OPENNSL_PORT_ATTR_ENABLE_MASK | OPENNSL_PORT_ATTR_LINKSCAN_MASK;
+    return opennsl_port_selective_set(hwUnit, hwPort, &portInfo);
+}
+
+int HwPortBreakoutSetting::initPort(const int hwUnit, const opennsl_port_t hwPort, const PortSplitMode splitMode) const {
+    // The same steps as port module initialization does for each port
+    int rv = opennsl_port_stp_set(hwUnit, hwPort, OPENNSL_STG_STP_FORWARD);
+    if (OPENNSL_SUCCESS(rv)) {
+        rv = opennsl_port_vlan_member_set(hwUnit, hwPort, (OPENNSL_PORT_VLAN_MEMBER_INGRESS | OPENNSL_PORT_VLAN_MEMBER_EGRESS));
+    }
+
+    if (OPENNSL_SUCCESS(rv)) {
+        rv = opennsl_stat_clear(hwUnit, hwPort);
+    }
+
+    if (OPENNSL_SUCCESS(rv)) {
+        opennsl_port_info_t portInfo {};
+        opennsl_port_info_t_init(&portInfo);
+        portInfo.speed = static_cast<int>(getSplitPortSpeed(splitMode));
+        portInfo.duplex = OPENNSL_PORT_DUPLEX_FULL;
+        portInfo.pause_rx = OPENNSL_PORT_ABILITY_PAUSE_RX;
+        portInfo.pause_tx = OPENNSL_PORT_ABILITY_PAUSE_TX;
+        portInfo.linkscan = HwPortLinkScanModeSetting::toOpenNslLinkScanMode(_linkScanMode);
+        portInfo.autoneg = FALSE;
+        portInfo.enable = TRUE;
+        portInfo.action_mask = OPENNSL_PORT_ATTR_AUTONEG_MASK
+                | OPENNSL_PORT_ATTR_DUPLEX_MASK
+                | OPENNSL_PORT_ATTR_PAUSE_TX_MASK
+                | OPENNSL_PORT_ATTR_PAUSE_RX_MASK
+                | OPENNSL_PORT_ATTR_LINKSCAN_MASK
+                | OPENNSL_PORT_ATTR_ENABLE_MASK
+                | OPENNSL_PORT_ATTR_SPEED_MASK;
+        rv = opennsl_port_selective_set(hwUnit, hwPort, &portInfo);
+    }
+
+    return rv;
+}
+
+int HwPortBreakoutSetting::setPortSpeed(const int hwUnit, const opennsl_port_t hwPort, const PortSplitMode splitMode) {
+    opennsl_port_info_t portInfo {};
+    opennsl_port_info_t_init(&portInfo);
+    portInfo.speed = static_cast<int>(getSplitPortSpeed(splitMode));
+    portInfo.action_mask = OPENNSL_PORT_ATTR_SPEED_MASK;
+    return opennsl_port_selective_set(hwUnit, hwPort, &portInfo);
+}
+
+void HwPortBreakoutSetting::setLaneGroupLayout(const SlavePorts& slavePorts, const PortSplitMode splitMode) {
+    auto& hwPortMapping = OpenNos::HwPortMapping::getInstance();
+    for (size_t lane = 0; lane < slavePorts.size(); ++lane) {
+        if (slavePorts[lane] != PortParameters::InvalidPort) {
+            hwPortMapping.setPortLayout(slavePorts[lane], splitMode, getLaneNo(splitMode, lane));
+        }
+    }
+}
+
+void HwPortBreakoutSetting::revert(const HwPorts& hwPorts, const SlavePorts& slavePorts, const PortSplitMode fromSplitMode,
+                                   const std::vector<AppliedStep>& appliedSteps) const {
+    const int hwUnit = Asic::getDefaultHwUnit();
+    const auto fromLanesPerPort = getLanesPerPort(fromSplitMode);
+    // Steps are undone in reverse order, so lanes are given back before their ports are started again
+    for (auto stepIt = appliedSteps.rbegin(); stepIt != appliedSteps.rend(); ++stepIt) {
+        const opennsl_port_t hwPort = hwPorts[stepIt->lane];
+        int rv = OPENNSL_E_NONE;
+        switch (stepIt->step) {
+          case Step::Stopped:
+                rv = initPort(hwUnit, hwPort, fromSplitMode);
+                break;
+          case Step::LanesSet:
+                // Lane of created port goes back to the port which had it, reverting that port's lanes is enough
+                rv = (_laneActions[stepIt->lane] == LaneAction::Create) ? stopPort(hwUnit, hwPort)
+                                                                         : opennsl_port_control_set(hwUnit, hwPort, opennslPortControlLanes, fromLanesPerPort);
+                break;
+          case Step::LayoutSet:
+                setLaneGroupLayout(slavePorts, fromSplitMode);
+                break;
+          case Step::Initialized:
+                rv = stopPort(hwUnit, hwPort);
+                break;
+          case Step::SpeedSet:
+                rv = setPortSpeed(hwUnit, hwPort, fromSplitMode);
+                break;
+        }
+
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to revert lane %zu of h/w port %d: %s (%d)", stepIt->lane + 1, hwPort, opennsl_errmsg(rv), rv));
+        }
+
+        if (stepIt->step != Step::LayoutSet) {
+            HwPortAbilityCache::invalidate(hwUnit, hwPort);
+        }
+    }
+}
+
+HwPortDefaultParametersSetting::HwPortDefaultParametersSetting()
+    : _linkScanMode { LinkScanMode::Software }, _groupsCount { HwPortBulkInitializing::DefaultGroupsCount }, _phaseTimings {} {
+    // Nothing more to do
+}
+
+HwPortDefaultParametersSetting& HwPortDefaultParametersSetting::setGroupsCount(const size_t groupsCount) {
+    _groupsCount = groupsCount;
+    return *this;
+}
+
+HwPortDefaultParametersSetting& HwPortDefaultParametersSetting::setLinkScanMode(const LinkScanMode linkScanMode) {
+    _linkScanMode = linkScanMode;
+    return *this;
+}
+
 size_t HwPortDefaultParametersSetting::getCommitOrderingResolve() const {
     return CommitOrderingResolve::PortInit;
 }
@@ -210,7 +932,7 @@ Result::Value HwPortDefaultParametersSetting::execute(ResultCallback::Handle& ca
     portInfo.duplex = OPENNSL_PORT_DUPLEX_FULL;
     portInfo.pause_rx = OPENNSL_PORT_ABILITY_PAUSE_RX;
     portInfo.pause_tx = OPENNSL_PORT_ABILITY_PAUSE_TX;
-    portInfo.linkscan = OPENNSL_LINKSCAN_MODE_SW;
+    portInfo.linkscan = HwPortLinkScanModeSetting::toOpenNslLinkScanMode(_linkScanMode);
     portInfo.autoneg = FALSE;
     portInfo.enable = TRUE;
     portInfo.action_mask = OPENNSL_PORT_ATTR_AUTONEG_MASK
@@ -221,22 +943,21 @@ Result::Value HwPortDefaultParametersSetting::execute(ResultCallback::Handle& ca
             | OPENNSL_PORT_ATTR_ENABLE_MASK
             | OPENNSL_PORT_ATTR_SPEED_MASK;
 
-    opennsl_port_config_t portConfig;
-    opennsl_port_config_t_init(&portConfig);
-    opennsl_port_config_get(Asic::getDefaultHwUnit(), &portConfig);
-    opennsl_port_t port {};
-    int rv = {};
-
-    OPENNSL_PBMP_ITER(portConfig.e, port) { // Member .e contains all eth ports
-        rv = opennsl_port_stp_set(Asic::getDefaultHwUnit(), port, OPENNSL_STG_STP_FORWARD);
-        if (OPENNSL_FAILURE(rv)) {
-            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
-        }
-
-        rv = opennsl_port_selective_set(Asic::getDefaultHwUnit(), port, &portInfo);
-        if (OPENNSL_FAILURE(rv)) {
-            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
-        }
+    std::vector<opennsl_port_t> hwPorts {};
+    const int rc = HwPortBulkInitializing::getEthernetPorts(Asic::getDefaultHwUnit(), hwPorts);
+    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rc, callback);
+    HwPortBulkInitializing bulkInitializing { Asic::getDefaultHwUnit(), std::move(hwPorts), _groupsCount };
+    size_t failedPortsCount = bulkInitializing.runPhase(HwPortBulkInitializing::Phase::StpSet, [](const int hwUnit, const opennsl_port_t hwPort) {
+        return opennsl_port_stp_set(hwUnit, hwPort, OPENNSL_STG_STP_FORWARD);
+    });
+    failedPortsCount += bulkInitializing.runPhase(HwPortBulkInitializing::Phase::AttributesSet,
+                                                  [&portInfo](const int hwUnit, const opennsl_port_t hwPort) {
+        auto hwPortInfo = portInfo; // Each group has to pass its own copy to SDK
+        return opennsl_port_selective_set(hwUnit, hwPort, &hwPortInfo);
+    });
+    _phaseTimings = bulkInitializing.getPhaseTimings();
+    if (failedPortsCount > 0) {
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
     }
 
     CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
@@ -246,69 +967,13 @@ size_t HwPortSpeedSetting::getCommitOrderingResolve() const {
     return CommitOrderingResolve::PortSet;
 }
 
-Result::Value HwPortSpeedSetting::execute(ResultCallback::Handle& callback) {
-    const auto hwPort = Mapping::panelPortToHwPort(_parameters.portNo);
-    opennsl_port_info_t portInfo {};
-    opennsl_port_info_t_init(&portInfo);
-    portInfo.action_mask = OPENNSL_PORT_ATTR_SPEED_MASK;
+Result::Value HwPortSpeedSetting::buildPortInfo(opennsl_port_info_t& portInfo) {
+    portInfo.action_mask |= OPENNSL_PORT_ATTR_SPEED_MASK;
     portInfo.speed = static_cast<int>(_parameters.speed);
-    int rc {};
     if (_parameters.autoneg) {
-        opennsl_port_ability_t port_ability;
         opennsl_port_ability_t advert_ability;
-
-        opennsl_port_ability_t_init(&port_ability);
-        opennsl_port_ability_t_init(&advert_ability);
-
-        port_ability.fec = OPENNSL_PORT_ABILITY_FEC_NONE;
-        /// @todo We only support advertising one speed or all possible speeds at the moment.
-        if (PortSpeed::Max == _parameters.speed) {
-            // Full autonegotiation desired.  Get all possible speed/duplex values for this port from h/w, then filter out HD support.
-            rc = opennsl_port_ability_local_get(Asic::getDefaultHwUnit(), hwPort, &port_ability);
-            if (OPENNSL_SUCCESS(rc)) {
-                // Mask out half-duplex support.
-                port_ability.speed_half_duplex = 0;
-            } else {
-                VLOG_ERR("Failed to get port %d ability", hwPort);
-                // Assume typical 100G port setting. Can't be worse than just exiting...
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-            }
-        }
-        else if (PortSpeed::_1Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_1000MB;
-        }
-        else if (PortSpeed::_10Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_10GB;
-        }
-        else if (PortSpeed::_20Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_20GB;
-        }
-        else if (PortSpeed::_25Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_25GB;
-        }
-        else if (PortSpeed::_40Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_40GB;
-        }
-        else if (PortSpeed::_50Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_50GB;
-        }
-        else if (PortSpeed::_100Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-            if (_parameters.fec) {
-                port_ability.fec = OPENNSL_PORT_ABILITY_FEC_CL91;
-            }
-        } else {
-            // Unsupported speed.
-            VLOG_ERR("Failed to configure unavailable speed %d",
-                     _parameters.speed);
-            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
-        }
-
-        rc = opennsl_port_ability_advert_get(Asic::getDefaultHwUnit(), hwPort, &advert_ability);
-        if (OPENNSL_FAILURE(rc)) {
-            VLOG_ERR("Failed to get port %d local advert", hw_port);
-            // Assume typical advertised ability.
-            advert_ability.pause = OPENNSL_PORT_ABILITY_PAUSE;
+        if (Result::Failed(buildAutonegAdvertisement(advert_ability, true))) {
+            return Result::Value::Fail;
         }
 
         portInfo.local_ability = advert_ability;
@@ -318,80 +983,21 @@ Result::Value HwPortSpeedSetting::execute(ResultCallback::Handle& callback) {
         portInfo.action_mask2 |= OPENNSL_PORT_ATTR2_PORT_ABILITY;
     }
 
-    // Program h/w with the given values.
-    rc = opennsl_port_selective_set(Asic::getDefaultHwUnit(), hwPort, &portInfo);
-    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rc, callback);
-    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    return Result::Value::Success;
 }
 
 size_t HwPortShutdownSetting::getCommitOrderingResolve() const {
     return CommitOrderingResolve::PortInit;
 }
 
-Result::Value HwPortShutdownSetting::execute(ResultCallback::Handle& callback) {
-    int rc = OPENNSL_E_NONE;
-    const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(_parameters.portNo);
-    opennsl_port_info_t portInfo;
-    opennsl_port_info_t_init(&portInfo);
-
+Result::Value HwPortShutdownSetting::buildPortInfo(opennsl_port_info_t& portInfo) {
     // Whether we are enabling or disabling, we need to set the operational state (ENABLE) flag.
     portInfo.action_mask |= OPENNSL_PORT_ATTR_ENABLE_MASK;
+    portInfo.enable = _parameters.shutdowned ? FALSE : TRUE;
     if ((not _parameters.shutdowned) && _parameters.autoneg) {
-        opennsl_port_ability_t port_ability;
         opennsl_port_ability_t advert_ability;
-
-        opennsl_port_ability_t_init(&port_ability);
-        opennsl_port_ability_t_init(&advert_ability);
-
-        port_ability.fec = OPENNSL_PORT_ABILITY_FEC_NONE;
-        /// @todo We only support advertising one speed or all possible speeds at the moment.
-        if (PortSpeed::Max == _parameters.speed) {
-            // Full autonegotiation desired.  Get all possible speed/duplex values for this port from h/w, then filter out HD support.
-            rc = opennsl_port_ability_local_get(Asic::getDefaultHwUnit(), hwPort, &port_ability);
-            if (OPENNSL_SUCCESS(rc)) {
-                // Mask out half-duplex support.
-                port_ability.speed_half_duplex = 0;
-            } else {
-                VLOG_ERR("Failed to get port %d ability", hwPort);
-                // Assume typical 100G port setting. Can't be worse than just exiting...
-                port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-            }
-        }
-        else if (PortSpeed::_1Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_1000MB;
-        }
-        else if (PortSpeed::_10Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_10GB;
-        }
-        else if (PortSpeed::_20Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_20GB;
-        }
-        else if (PortSpeed::_25Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_25GB;
-        }
-        else if (PortSpeed::_40Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_40GB;
-        }
-        else if (PortSpeed::_50Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_50GB;
-        }
-        else if (PortSpeed::_100Gb == _parameters.speed) {
-            port_ability.speed_full_duplex = OPENNSL_PORT_ABILITY_100GB;
-            if (_parameters.fec) {
-                port_ability.fec = OPENNSL_PORT_ABILITY_FEC_CL91;
-            }
-        } else {
-            // Unsupported speed.
-            VLOG_ERR("Failed to configure unavailable speed %d",
-                     _parameters.speed);
-            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
-        }
-
-        rc = opennsl_port_ability_advert_get(Asic::getDefaultHwUnit(), hwPort, &advert_ability);
-        if (OPENNSL_FAILURE(rc)) {
-            VLOG_ERR("Failed to get port %d local advert", hw_port);
-            // Assume typical advertised ability.
-            advert_ability.pause = OPENNSL_PORT_ABILITY_PAUSE;
+        if (Result::Failed(buildAutonegAdvertisement(advert_ability, true))) {
+            return Result::Value::Fail;
         }
 
         portInfo.local_ability = advert_ability;
@@ -401,8 +1007,5 @@ Result::Value HwPortShutdownSetting::execute(ResultCallback::Handle& callback) {
         portInfo.action_mask2 |= OPENNSL_PORT_ATTR2_PORT_ABILITY;
     }
 
-    // Program h/w with the given values.
-    rc = opennsl_port_selective_set(Asic::getDefaultHwUnit(), hwPort, &portInfo);
-    CALL_CALLBACK_AND_RETURN_IF_OPENNSL_FAIL(rc, callback);
-    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    return Result::Value::Success;
 }
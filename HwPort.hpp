@@ -15,13 +15,21 @@
 #pragma once
 
 #include "Asic.hpp"
+#include "Bitmap.hpp"
 #include "Command.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwPortBulkInitializing.hpp"
+#include "HwPortMapping.hpp"
 #include "Observer.hpp"
+#include <array>
+#include <atomic>
 
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 extern "C" {
 #   include <opennsl/link.h>
@@ -33,54 +41,281 @@ class HwPort : public Command {
     using Handle = std::shared_ptr<HwPort>;
     virtual ~HwPort() = default;
     HwPort& setPortParameters(const PortParameters parameters);
+    /// Translation by mapping of platform, see OpenNos::HwPortMapping
     struct Mapping {
-        static opennsl_port_t panelPortToHwPort(const PortId portNo);
-        static PortId hwPortToPanelPort(const opennsl_port_t hwPort);
+        static opennsl_port_t panelPortToHwPort(const PortId portNo) {
+            return OpenNos::HwPortMapping::getInstance().panelPortToHwPort(portNo);
+        }
+
+        static int panelPortToHwUnit(const PortId portNo) {
+            return OpenNos::HwPortMapping::getInstance().panelPortToHwUnit(portNo);
+        }
+
+        static PortId hwPortToPanelPort(const int hwUnit, const opennsl_port_t hwPort) {
+            return OpenNos::HwPortMapping::getInstance().hwPortToPanelPort(hwUnit, hwPort);
+        }
     };
 
   protected:
+    /// Builds autonegotiation advertisement of speed and duplex requested by port parameters
+    /// @param withFec also advertises requested FEC, otherwise FEC of current advertisement is kept
+    Result::Value buildAutonegAdvertisement(opennsl_port_ability_t& advertAbility, const bool withFec) const;
+
     PortParameters _parameters;
 };
 
+/// Caches abilities of ports, because reading them from SDK means slow register/PHY access.
+/// Cache is populated once at port module initialization of unit. Entry of port has to be invalidated
+/// when port's lanes are changed by breakout or when transceiver is changed, then it is read
+/// again from SDK on next request. Ports of unit out of reserved entries aren't cached.
+/// @note Entries of unit are allocated only by reserve(), which can't run concurrently with other
+/// calls for the same unit. Entries of different ports can be accessed concurrently.
+class HwPortAbilityCache final {
+  public:
+    static constexpr int MaxHwUnits = 8;
+    static void populate(const int hwUnit, const opennsl_port_t hwPort);
+    static void invalidate(const int hwUnit, const opennsl_port_t hwPort);
+    /// Invalidates entries of all ports of @p hwUnit, entries of other units are kept
+    static void invalidateUnit(const int hwUnit);
+    /// Allocates entries of all ports of @p hwUnit, so entries of different ports can be populated concurrently
+    static void reserve(const int hwUnit, const size_t hwPortsCount);
+    static Result::Value getLocalAbility(const int hwUnit, const opennsl_port_t hwPort, opennsl_port_ability_t& ability);
+    static Result::Value getAdvertAbility(const int hwUnit, const opennsl_port_t hwPort, opennsl_port_ability_t& ability);
+    /// Keeps cache in sync after advertisement has been programmed into h/w
+    static void updateAdvertAbility(const int hwUnit, const opennsl_port_t hwPort, const opennsl_port_ability_t& ability);
+
+  private:
+    struct Entry {
+        bool localAbilityValid;
+        bool advertAbilityValid;
+        opennsl_port_ability_t localAbility;
+        opennsl_port_ability_t advertAbility;
+    };
+
+    /// @return nullptr if entry of port isn't reserved
+    static Entry* getEntry(const int hwUnit, const opennsl_port_t hwPort);
+    static std::array<std::vector<Entry>, MaxHwUnits> _entries; // Indexed by unit, then by h/w port
+};
+
 /// Lag and Vlan port will have separated class of FDB flushing command
-class HwPortFdbFlushing : public HwPort {
+/// Ports are collected and flushed together by commit(), so ports which went down within one link
+/// status update cost one pass on ASIC thread. Port added while flushing is already scheduled joins
+/// the pending pass. MACs of LAG member ports are learned on trunk, so they stay valid as long as
+/// any member of LAG still forwards. Trunk is flushed by one delete by trunk call only when its last
+/// forwarding member goes down or leaves LAG.
+/// @note All public methods except execute() are thread safe
+class HwPortFdbFlushing : public HwPort, public std::enable_shared_from_this<HwPortFdbFlushing> {
   public:
     using Handle = std::shared_ptr<HwPortFdbFlushing>;
+    using PortBitmap = Bitmap<MaxPorts, PortId>;
+    struct Statistics {
+        uint64_t requestedPorts;
+        uint64_t flushedPorts; // Flushed by port
+        uint64_t flushedTrunks;
+        uint64_t flushedTrunkMemberPorts; // Covered by flushing of their trunks
+        uint64_t skippedTrunkMemberPorts; // Their trunks still have forwarding members
+        uint64_t passes;
+        uint64_t failedCalls;
+    };
+
+    HwPortFdbFlushing();
     virtual ~HwPortFdbFlushing() override = default;
+    /// Flushing is executed in ASIC thread of @p hwCommandProcessor. Without it commit() executes flushing directly.
+    void setHwCommandProcessor(HwCommandProcessor::Handle hwCommandProcessor);
+    /// Port added to flushing is considered as not forwarding until setPortLinkedUp()
     HwPortFdbFlushing& addPortToFlushing(const PortId portNo);
     Result::Value removePortFromFlushing(const PortId portNo);
+    void setPortLinkedUp(const PortId portNo);
+    /// Trunk is added to flushing when no forwarding member port is left in it
+    /// @param memberPorts empty bitmap removes trunk
+    void setTrunkMemberPorts(const opennsl_trunk_t trunk, const PortBitmap& memberPorts);
+    /// Schedules flushing of collected ports and trunks unless it is already scheduled
+    Result::Value commit(ResultCallback::Handle& callback = gNullResultCallback);
     virtual size_t getCommitOrderingResolve() const override;
+    /// Flushes all collected ports in one pass
     virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    Statistics getStatistics() const;
 
   private:
-    std::set<PortId> _portsToFlushing; // ports from which learned MACs should be cleared
+    static constexpr opennsl_trunk_t NoTrunk = -1;
+    using HwUnitTrunk = std::pair<int, opennsl_trunk_t>;
+    static void addTrunkToFlushing(std::vector<HwUnitTrunk>& trunksToFlushing, const int hwUnit, const opennsl_trunk_t trunk);
+    void countSdkCall(const int rv);
+    bool hasForwardingMemberPort(const opennsl_trunk_t trunk) const;
+
+    mutable std::mutex _mtx;
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    PortBitmap _portsToFlushing; // ports from which learned MACs should be cleared
+    std::vector<HwUnitTrunk> _trunksToFlushing; // Trunk is flushed on units of its member ports
+    PortBitmap _notForwardingPorts;
+    bool _scheduled;
+    std::vector<opennsl_trunk_t> _trunkOfPort; // Indexed by port
+    std::map<opennsl_trunk_t, PortBitmap> _trunkMemberPorts;
+    Statistics _statistics;
+};
+
+/// Base for commands which program port attributes by opennsl_port_selective_set().
+/// Attributes are built separately from programming, so many settings of the same port
+/// can be merged into one SDK call by HwPortAttributesCoalescing.
+class HwPortAttributesSetting : public HwPort {
+  public:
+    using Handle = std::shared_ptr<HwPortAttributesSetting>;
+    virtual ~HwPortAttributesSetting() override = default;
+    opennsl_port_t getHwPort() const;
+    /// Fills @p portInfo with attributes and their action masks
+    virtual Result::Value buildPortInfo(opennsl_port_info_t& portInfo) = 0;
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
 };
 
-class HwPortShutdownSetting : public HwPort {
+class HwPortShutdownSetting : public HwPortAttributesSetting {
   public:
     using Handle = std::shared_ptr<HwPortShutdownSetting>;
     virtual size_t getCommitOrderingResolve() const override;
-    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value buildPortInfo(opennsl_port_info_t& portInfo) override;
 };
 
-class HwPortSpeedSetting : public HwPort {
+class HwPortSpeedSetting : public HwPortAttributesSetting {
   public:
     using Handle = std::shared_ptr<HwPortSpeedSetting>;
     virtual size_t getCommitOrderingResolve() const override;
-    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value buildPortInfo(opennsl_port_info_t& portInfo) override;
+};
+
+/// Software linkscan detects link change on average half of linkscan interval after it happened,
+/// hardware linkscan right after ASIC raises interrupt
+class HwPortLinkScanModeSetting : public HwPortAttributesSetting {
+  public:
+    using Handle = std::shared_ptr<HwPortLinkScanModeSetting>;
+    static int toOpenNslLinkScanMode(const LinkScanMode linkScanMode);
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Hardware linkscan requested on ASIC which doesn't support it is rejected by SDK when port is programmed
+    virtual Result::Value buildPortInfo(opennsl_port_info_t& portInfo) override;
 };
 
+/// Initializes all Ethernet ports of unit, port groups are programmed concurrently
 class HwPortDefaultParametersSetting : public HwPort {
   public:
     using Handle = std::shared_ptr<HwPortDefaultParametersSetting>;
+    HwPortDefaultParametersSetting();
+    /// Linkscan mode which ports are initialized with
+    HwPortDefaultParametersSetting& setLinkScanMode(const LinkScanMode linkScanMode);
+    HwPortDefaultParametersSetting& setGroupsCount(const size_t groupsCount);
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Each phase is run for all ports, so failure of port doesn't stop initialization of other ports
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    const HwPortBulkInitializing::PhaseTimings& getPhaseTimings() const { return _phaseTimings; }
+
+  private:
+    LinkScanMode _linkScanMode;
+    size_t _groupsCount;
+    HwPortBulkInitializing::PhaseTimings _phaseTimings;
+};
+
+/// Changes split mode of port, which is taken from port parameters, by reprogramming only lanes of
+/// the port. Sibling port which keeps its lanes is left untouched or only its speed is changed, so
+/// its traffic is not disrupted. Ports losing or changing their lanes are deinitialized before lanes
+/// are reassigned, ports which got lanes are initialized with default attributes afterwards.
+/// If programming fails in the middle, already applied steps are undone in reverse order, so lane
+/// group returns to its previous split mode with default attributes of its ports.
+class HwPortBreakoutSetting : public HwPort {
+  public:
+    using Handle = std::shared_ptr<HwPortBreakoutSetting>;
+    /// What happens with port starting at lane of lane group
+    enum class LaneAction : uint8_t {
+        None,     // No port starts at lane in either mode
+        Keep,     // Port keeps its lanes and speed
+        SpeedSet, // Port keeps its lanes, only its speed changes
+        Reinit,   // Port gets other count of lanes
+        Create,   // Port appears
+        Delete    // Port disappears, its lane is taken by other port
+    };
+
+    using LaneActions = std::array<LaneAction, MaxSlavePorts>;
+    HwPortBreakoutSetting();
+    static uint8_t getLanesPerPort(const PortSplitMode splitMode);
+    /// @retval PortSpeed::Max if port is not split, then it runs at the highest speed of its lanes
+    static PortSpeed getSplitPortSpeed(const PortSplitMode splitMode);
+    static PortLaneNo getLaneNo(const PortSplitMode splitMode, const size_t lane);
+    static LaneActions planLaneActions(const PortSplitMode fromSplitMode, const PortSplitMode toSplitMode);
+    /// Linkscan mode which created ports are initialized with
+    HwPortBreakoutSetting& setLinkScanMode(const LinkScanMode linkScanMode);
     virtual size_t getCommitOrderingResolve() const override;
     virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    /// @return actions taken on lanes by last execute()
+    const LaneActions& getLaneActions() const { return _laneActions; }
+
+  private:
+    using HwPorts = std::array<opennsl_port_t, MaxSlavePorts>;
+    using SlavePorts = std::array<PortId, MaxSlavePorts>;
+    enum class Step : uint8_t {
+        Stopped,
+        LanesSet,
+        LayoutSet,
+        Initialized,
+        SpeedSet
+    };
+
+    struct AppliedStep {
+        Step step;
+        size_t lane;
+    };
+
+    static int stopPort(const int hwUnit, const opennsl_port_t hwPort);
+    int initPort(const int hwUnit, const opennsl_port_t hwPort, const PortSplitMode splitMode) const;
+    static int setPortSpeed(const int hwUnit, const opennsl_port_t hwPort, const PortSplitMode splitMode);
+    static void setLaneGroupLayout(const SlavePorts& slavePorts, const PortSplitMode splitMode);
+    void revert(const HwPorts& hwPorts, const SlavePorts& slavePorts, const PortSplitMode fromSplitMode,
+                const std::vector<AppliedStep>& appliedSteps) const;
+
+    LinkScanMode _linkScanMode;
+    LaneActions _laneActions;
 };
 
-class HwPortParametersSetting : public HwPort {
+class HwPortParametersSetting : public HwPortAttributesSetting {
   public:
     using Handle = std::shared_ptr<HwPortParametersSetting>;
     HwPortParametersSetting& setPortParameters(const PortParameters& parameters);
     virtual size_t getCommitOrderingResolve() const override;
+    virtual Result::Value buildPortInfo(opennsl_port_info_t& portInfo) override;
+};
+
+/// Collects attribute settings of ports within one commit and merges them per port into union
+/// of action_mask/action_mask2, so each port is programmed by exactly one SDK call.
+/// Thanks to it e.g. shutdown and speed change of the same port bounce its link only once.
+/// @note There is one instance per command factory, so commits are done only in ASIC thread (see
+/// HwCommandProcessor). Settings of other threads don't join commit, they are programmed directly.
+class HwPortAttributesCoalescing : public HwPort {
+  public:
+    using Handle = std::shared_ptr<HwPortAttributesCoalescing>;
+    struct Statistics {
+        uint64_t mergedSettings; // SDK calls which would be issued without coalescing
+        uint64_t sdkCalls;
+        uint64_t failedCalls;
+    };
+
+    HwPortAttributesCoalescing();
+    virtual ~HwPortAttributesCoalescing() override = default;
+    /// Starts collecting settings of calling thread. Until execute() is called, settings are only merged.
+    /// @retval Result::Value::AlreadyExists if commit of other thread is being collected
+    Result::Value begin();
+    /// @retval true if commit of calling thread is being collected
+    bool isCollecting() const;
+    Result::Value addPortSetting(HwPortAttributesSetting& setting);
+    /// Drops collected settings without programming them and stops collecting
+    void abort();
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Programs all collected settings and stops collecting. Ports which failed are logged and
+    /// skipped, the rest is still programmed; Fail is returned if any port failed.
     virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    /// Result of each h/w port of last commit, ports of aborted commit have failed
+    const std::map<opennsl_port_t, Result::Value>& getPortResults() const { return _portResults; }
+    Statistics getStatistics() const;
+
+  private:
+    static void mergePortInfo(opennsl_port_info_t& target, const opennsl_port_info_t& source);
+
+    std::atomic<std::thread::id> _collectingThreadId; // Default id if nothing is being collected
+    std::map<opennsl_port_t, opennsl_port_info_t> _pendingPortInfos;
+    std::map<opennsl_port_t, Result::Value> _portResults;
+    Statistics _statistics;
 };
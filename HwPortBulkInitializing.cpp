@@ -0,0 +1,101 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HwPortBulkInitializing.hpp"
+
+extern "C" {
+#   include <opennsl/error.h>
+#   include <opennsl/port.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+HwPortBulkInitializing::HwPortBulkInitializing(const int hwUnit, std::vector<opennsl_port_t> hwPorts, const size_t groupsCount)
+    : _hwUnit { hwUnit }, _hwPorts { std::move(hwPorts) }, _groupsCount { std::max<size_t>(groupsCount, 1) }, _phaseTimings {} {
+    // Nothing more to do
+}
+
+int HwPortBulkInitializing::getEthernetPorts(const int hwUnit, std::vector<opennsl_port_t>& hwPorts) {
+    hwPorts.clear();
+    opennsl_port_config_t portConfig;
+    opennsl_port_config_t_init(&portConfig);
+    const int rc = opennsl_port_config_get(hwUnit, &portConfig);
+    if (OPENNSL_FAILURE(rc)) {
+        return rc;
+    }
+
+    opennsl_port_t hwPort {};
+    OPENNSL_PBMP_ITER(portConfig.e, hwPort) { // Member .e contains all eth ports
+        hwPorts.push_back(hwPort);
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+const char* HwPortBulkInitializing::getPhaseName(const Phase phase) {
+    switch (phase) {
+      case Phase::StpSet:
+            return "stp_set";
+      case Phase::AttributesSet:
+            return "attributes_set";
+      case Phase::VlanMemberSet:
+            return "vlan_member_set";
+      case Phase::StatClear:
+            return "stat_clear";
+      case Phase::AbilitiesPopulate:
+            return "abilities_populate";
+      default:
+            return "unknown";
+    }
+}
+
+size_t HwPortBulkInitializing::runPhase(const Phase phase, const PortCall& portCall) {
+    const auto startedAt = std::chrono::steady_clock::now();
+    const size_t groupsCount = std::max<size_t>(std::min(_groupsCount, _hwPorts.size() / MinPortsPerGroup), 1);
+    const size_t portsPerGroup = (_hwPorts.size() + groupsCount - 1) / groupsCount;
+    std::atomic<size_t> failedPortsCount { 0 };
+    auto programGroup = [&](const size_t groupIndex) {
+        const auto groupBegin = std::min(groupIndex * portsPerGroup, _hwPorts.size());
+        const auto groupEnd = std::min(groupBegin + portsPerGroup, _hwPorts.size());
+        size_t groupFailedPortsCount = 0;
+        for (size_t portIndex = groupBegin; portIndex < groupEnd; ++portIndex) {
+            if (OPENNSL_FAILURE(portCall(_hwUnit, _hwPorts[portIndex]))) {
+                ++groupFailedPortsCount;
+            }
+        }
+
+        failedPortsCount.fetch_add(groupFailedPortsCount, std::memory_order_relaxed);
+    };
+
+    // Calling thread programs the first group itself
+    std::vector<std::thread> groupThreads {};
+    groupThreads.reserve(groupsCount - 1);
+    for (size_t groupIndex = 1; groupIndex < groupsCount; ++groupIndex) {
+        groupThreads.emplace_back(programGroup, groupIndex);
+    }
+
+    programGroup(0);
+    for (auto& groupThread : groupThreads) {
+        groupThread.join();
+    }
+
+    auto& phaseTiming = _phaseTimings[static_cast<size_t>(phase)];
+    phaseTiming.duration = std::chrono::steady_clock::now() - startedAt;
+    phaseTiming.ports = static_cast<uint32_t>(_hwPorts.size());
+    phaseTiming.failedPorts = static_cast<uint32_t>(failedPortsCount.load(std::memory_order_relaxed));
+    phaseTiming.groups = static_cast<uint32_t>(groupsCount);
+    return failedPortsCount.load(std::memory_order_relaxed);
+}
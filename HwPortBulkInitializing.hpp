@@ -0,0 +1,76 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Types.hpp"
+
+extern "C" {
+#   include <opennsl/types.h>
+}
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// Brings up Ethernet ports of unit in phases. Each phase issues one kind of per-port SDK call for
+/// all ports. Ports are split into groups, which are programmed concurrently, because SDK calls of
+/// different ports don't depend on each other and most of their time is spent waiting for register
+/// and PHY access. Duration of each phase is recorded, so regression of boot-to-forwarding time
+/// can be tracked down to the phase which caused it.
+class HwPortBulkInitializing final {
+  public:
+    enum class Phase : size_t {
+        StpSet,
+        AttributesSet,
+        VlanMemberSet,
+        StatClear,
+        AbilitiesPopulate,
+        Count
+    };
+
+    struct PhaseTiming {
+        std::chrono::nanoseconds duration;
+        uint32_t ports;
+        uint32_t failedPorts;
+        uint32_t groups; // Programmed concurrently
+    };
+
+    using PhaseTimings = std::array<PhaseTiming, static_cast<size_t>(Phase::Count)>;
+    using PortCall = std::function<int(const int hwUnit, const opennsl_port_t hwPort)>;
+    static constexpr size_t DefaultGroupsCount = 4;
+    /// Smaller groups don't pay off cost of thread start
+    static constexpr size_t MinPortsPerGroup = 8;
+
+    /// @param groupsCount 1 programs all ports serially in calling thread
+    HwPortBulkInitializing(const int hwUnit, std::vector<opennsl_port_t> hwPorts, const size_t groupsCount = DefaultGroupsCount);
+    /// Reads Ethernet ports of unit from SDK port configuration to @p hwPorts, unit can have none of them
+    /// @return SDK error code of reading port configuration
+    static int getEthernetPorts(const int hwUnit, std::vector<opennsl_port_t>& hwPorts);
+    static const char* getPhaseName(const Phase phase);
+    /// Calls @p portCall for all ports and returns once all calls of the phase are done. Group threads
+    /// are started anew for each phase, so calls of one port in different phases can be issued from
+    /// different threads, but never concurrently.
+    /// @return count of ports whose call failed
+    size_t runPhase(const Phase phase, const PortCall& portCall);
+    const PhaseTimings& getPhaseTimings() const { return _phaseTimings; }
+
+  private:
+    int _hwUnit;
+    std::vector<opennsl_port_t> _hwPorts;
+    size_t _groupsCount;
+    PhaseTimings _phaseTimings;
+};
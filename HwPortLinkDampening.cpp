@@ -0,0 +1,183 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HwPortLinkDampening.hpp"
+#include "LoggingFacility.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+HwPortLinkDampening::HwPortLinkDampening(const size_t hwPortsCount)
+    : _maxPenalty { 0 }, _portStates(std::min(hwPortsCount, MaxHwPorts)), _statistics {} {
+    setParameters(Parameters {});
+}
+
+Result::Value HwPortLinkDampening::setParameters(const Parameters& parameters) {
+    auto newParameters = parameters;
+    newParameters.reuseThreshold = std::max<uint32_t>(newParameters.reuseThreshold, 1);
+    newParameters.halfLife = std::max(newParameters.halfLife, std::chrono::milliseconds { 1 });
+    // Penalty which decays to reuse threshold exactly after max suppress time
+    const double maxPenalty = newParameters.reuseThreshold
+            * std::exp2(static_cast<double>(newParameters.maxSuppressTime.count()) / static_cast<double>(newParameters.halfLife.count()));
+    if (maxPenalty < newParameters.suppressThreshold) {
+        VLOG_ERR("Max penalty %.0f is below suppress threshold %u", maxPenalty, newParameters.suppressThreshold);
+        return Result::Value::Fail;
+    }
+
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    _parameters = newParameters;
+    _maxPenalty = maxPenalty;
+    if (not _parameters.dampeningEnabled) {
+        // Suppressed port without penalty is reused as soon as held changes are released
+        for (auto& portState : _portStates) {
+            portState.penalty = 0;
+        }
+    }
+
+    return Result::Value::Success;
+}
+
+HwPortLinkDampening::Parameters HwPortLinkDampening::getParameters() const {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    return _parameters;
+}
+
+HwPortLinkDampening::Statistics HwPortLinkDampening::getStatistics() const {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    return _statistics;
+}
+
+void HwPortLinkDampening::onLinkStatusChange(const opennsl_port_t hwPort, const bool linkedUp, const uint32_t linkDowns,
+                                             const Clock::time_point now, LinkChanges& changesToReport) {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    ++_statistics.linkChanges;
+    if ((hwPort < 0) || (static_cast<size_t>(hwPort) >= _portStates.size())) {
+        ++_statistics.reportedChanges;
+        changesToReport.emplace_back(hwPort, linkedUp);
+        return;
+    }
+
+    auto& portState = _portStates[static_cast<size_t>(hwPort)];
+    portState.linkedUp = linkedUp;
+    if (_parameters.dampeningEnabled && (linkDowns > 0)) {
+        decayPenalty(portState, now);
+        portState.penalty = std::min(portState.penalty + static_cast<double>(linkDowns) * _parameters.penaltyPerFlap, _maxPenalty);
+        if ((not portState.suppressed) && (portState.penalty >= _parameters.suppressThreshold)) {
+            portState.suppressed = true;
+            _heldPorts.set(hwPort);
+            ++_statistics.suppressions;
+            // Suppressed port is held down, pending change is replaced by link down reported now
+            _statistics.coalescedChanges += portState.pendingChanges;
+            portState.changePending = false;
+            portState.pendingChanges = 0;
+            report(hwPort, portState, changesToReport);
+            return;
+        }
+    }
+
+    if (portState.suppressed) {
+        ++_statistics.suppressedChanges;
+        return;
+    }
+
+    if (_parameters.coalescingWindow.count() <= 0) {
+        // Observers get every drained change, e.g. link up after merged down/up still flushes FDB
+        report(hwPort, portState, changesToReport, true);
+        return;
+    }
+
+    if (not portState.changePending) {
+        portState.changePending = true;
+        portState.pendingUntil = now + _parameters.coalescingWindow;
+        _heldPorts.set(hwPort);
+    }
+
+    ++portState.pendingChanges;
+}
+
+void HwPortLinkDampening::releaseHeldChanges(const Clock::time_point now, LinkChanges& changesToReport) {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    for (const auto hwPort : _heldPorts) {
+        auto& portState = _portStates[static_cast<size_t>(hwPort)];
+        if (portState.suppressed) {
+            decayPenalty(portState, now);
+            if (portState.penalty >= _parameters.reuseThreshold) {
+                continue;
+            }
+
+            portState.suppressed = false;
+            ++_statistics.reuses;
+            report(hwPort, portState, changesToReport);
+        } else if (portState.changePending && (portState.pendingUntil <= now)) {
+            // Changes within window are merged into one, or into none if link status is back where it was
+            const bool reported = report(hwPort, portState, changesToReport);
+            _statistics.coalescedChanges += portState.pendingChanges - (reported ? 1 : 0);
+            portState.changePending = false;
+            portState.pendingChanges = 0;
+        }
+
+        if ((not portState.suppressed) && (not portState.changePending)) {
+            _heldPorts.reset(hwPort);
+        }
+    }
+}
+
+HwPortLinkDampening::Clock::time_point HwPortLinkDampening::getNextDeadline() const {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    auto nextDeadline = Clock::time_point::max();
+    for (const auto hwPort : _heldPorts) {
+        const auto& portState = _portStates[static_cast<size_t>(hwPort)];
+        nextDeadline = std::min(nextDeadline, portState.suppressed ? getReuseTime(portState) : portState.pendingUntil);
+    }
+
+    return nextDeadline;
+}
+
+bool HwPortLinkDampening::isSuppressed(const opennsl_port_t hwPort) const {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    return (hwPort >= 0) && (static_cast<size_t>(hwPort) < _portStates.size()) && _portStates[static_cast<size_t>(hwPort)].suppressed;
+}
+
+void HwPortLinkDampening::decayPenalty(PortState& portState, const Clock::time_point now) const {
+    if (portState.penalty > 0) {
+        const auto elapsed = std::chrono::duration<double, std::milli> { now - portState.penaltyUpdatedAt };
+        portState.penalty *= std::exp2(-elapsed.count() / static_cast<double>(_parameters.halfLife.count()));
+    }
+
+    portState.penaltyUpdatedAt = now;
+}
+
+HwPortLinkDampening::Clock::time_point HwPortLinkDampening::getReuseTime(const PortState& portState) const {
+    if (portState.penalty < _parameters.reuseThreshold) {
+        return portState.penaltyUpdatedAt;
+    }
+
+    const double halfLives = std::log2(portState.penalty / _parameters.reuseThreshold);
+    return portState.penaltyUpdatedAt
+            + std::chrono::duration_cast<Clock::duration>(halfLives * std::chrono::duration<double, std::milli> { _parameters.halfLife });
+}
+
+bool HwPortLinkDampening::report(const opennsl_port_t hwPort, PortState& portState, LinkChanges& changesToReport,
+                                 const bool force) {
+    // Suppressed port is reported as down regardless of its real link status
+    const bool linkedUp = portState.linkedUp && (not portState.suppressed);
+    if ((not force) && (linkedUp == portState.reportedLinkedUp)) {
+        return false;
+    }
+
+    portState.reportedLinkedUp = linkedUp;
+    ++_statistics.reportedChanges;
+    changesToReport.emplace_back(hwPort, linkedUp);
+    return true;
+}
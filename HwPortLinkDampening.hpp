@@ -0,0 +1,108 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Bitmap.hpp"
+#include "Types.hpp"
+
+extern "C" {
+#   include <opennsl/types.h>
+}
+
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/// Filters link status changes of flapping ports before they are passed to observers (FDB flush,
+/// VLAN reprogramming), so one bad port can't saturate ASIC command path.
+///  - Coalescing: change is reported after coalescing window, so burst like up/down/up within
+///    the window is reported once or not at all.
+///  - Dampening: each link down adds penalty, which decays exponentially with half life. Port
+///    whose penalty exceeds suppress threshold is held down until penalty decays below reuse
+///    threshold, then its current link status is reported.
+/// @note Thread safe, all methods are serialized by one mutex, so parameters can be changed while
+///       notifier thread accounts link changes
+class HwPortLinkDampening final {
+  public:
+    using Clock = std::chrono::steady_clock;
+    /// Reported changes of h/w ports in order of reporting
+    using LinkChanges = std::vector<std::pair<opennsl_port_t, bool>>;
+    struct Parameters {
+        bool dampeningEnabled = false;
+        uint32_t penaltyPerFlap = 1000;
+        uint32_t suppressThreshold = 2000;
+        uint32_t reuseThreshold = 1000;
+        /// Limits penalty, so port is suppressed at most for this time after last flap
+        std::chrono::milliseconds maxSuppressTime { 20000 };
+        std::chrono::milliseconds halfLife { 5000 };
+        /// Zero reports changes immediately
+        std::chrono::milliseconds coalescingWindow { 0 };
+    };
+
+    struct Statistics {
+        uint64_t linkChanges;
+        uint64_t reportedChanges;
+        uint64_t coalescedChanges; // Changes merged with other changes of the same port
+        uint64_t suppressedChanges; // Changes hidden, because port was suppressed
+        uint64_t suppressions; // Times when any port became suppressed
+        uint64_t reuses; // Times when any port stopped to be suppressed
+    };
+
+    explicit HwPortLinkDampening(const size_t hwPortsCount);
+    /// Disabling dampening clears penalties, so suppressed ports are reported by next releaseHeldChanges()
+    /// @retval Result::Value::Fail if max suppress time limits penalty below suppress threshold, so port
+    ///         could never be suppressed
+    Result::Value setParameters(const Parameters& parameters);
+    Parameters getParameters() const;
+    Statistics getStatistics() const;
+    /// Accounts link status change of port and reports it to @p changesToReport if it isn't held back
+    /// @param linkDowns number of times link went down since previous call for this port, because
+    ///        many changes can be merged into one before they are drained from linkscan callback
+    void onLinkStatusChange(const opennsl_port_t hwPort, const bool linkedUp, const uint32_t linkDowns,
+                            const Clock::time_point now, LinkChanges& changesToReport);
+    /// Reports changes whose coalescing window expired and link status of ports which are not suppressed anymore
+    void releaseHeldChanges(const Clock::time_point now, LinkChanges& changesToReport);
+    /// @return time of the nearest releaseHeldChanges() which can report anything, Clock::time_point::max() if none
+    Clock::time_point getNextDeadline() const;
+    bool isSuppressed(const opennsl_port_t hwPort) const;
+
+  private:
+    static constexpr size_t MaxHwPorts = MaxPorts;
+    struct PortState {
+        bool linkedUp;
+        bool reportedLinkedUp;
+        bool suppressed;
+        bool changePending;
+        uint32_t pendingChanges;
+        double penalty;
+        Clock::time_point penaltyUpdatedAt;
+        Clock::time_point pendingUntil;
+    };
+
+    void decayPenalty(PortState& portState, const Clock::time_point now) const;
+    Clock::time_point getReuseTime(const PortState& portState) const;
+    /// @param force reports link status even if observers have already been told about it
+    /// @return true if link status has been reported
+    bool report(const opennsl_port_t hwPort, PortState& portState, LinkChanges& changesToReport,
+                const bool force = false);
+
+    mutable std::mutex _stateMtx; // Guards parameters, state of ports and statistics
+    Parameters _parameters;
+    double _maxPenalty;
+    std::vector<PortState> _portStates; // Indexed by h/w port
+    Bitmap<MaxHwPorts, opennsl_port_t> _heldPorts; // Suppressed or with pending change
+    Statistics _statistics;
+};
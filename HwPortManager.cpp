@@ -13,81 +13,137 @@
 // limitations under the License.
 
 #include "HwPortManager.hpp"
+#include "LatencyTracer.hpp"
 
 extern "C" {
 #include <opennsl/error.h>
 }
 
-#include <functional>
+#include <chrono>
 
 HwPortCommandFactory::HwPortCommandFactory()
-    : _defaultParametersSetting { std::make_shared<HwPortDefaultParametersSetting>() },
+    : _attributesCoalescing { std::make_shared<HwPortAttributesCoalescing>() },
+      _breakoutSetting { std::make_shared<HwPortBreakoutSetting>() },
+      _defaultParametersSetting { std::make_shared<HwPortDefaultParametersSetting>() },
       _fdbFlushingCmd { std::make_shared<HwPortFdbFlushing>() },
+      _linkScanModeSetting { std::make_shared<HwPortLinkScanModeSetting>() },
       _parametersSetting { std::make_shared<HwPortParametersSetting>() },
+      _shutdownSetting { std::make_shared<HwPortShutdownSetting>() },
       _speedSettingCmd { std::make_shared<HwPortSpeedSetting>() } {
     // Nothing more to do
 }
 
-static std::mutex gRecentlyLinkStatusChangedOnHwPortsMtx;
-static std::mutex gRecentlyLinkStatusChangedOnPortsMtx;
-static std::condition_variable gRecentlyLinkStatusChangedOnHwPortsCondVar;
+static_assert(Asic::getHwUnitsCount() <= HwPortLinkScanHandling::MaxHwUnits, "Linkscan can't be handled on all units");
+static_assert(Asic::getHwUnitsCount() <= HwPortAbilityCache::MaxHwUnits, "Abilities can't be cached on all units");
+static_assert(Asic::getHwUnitsCount() <= OpenNos::HwPortMapping::MaxHwUnits, "Ports can't be mapped on all units");
+static_assert(Asic::getHwUnitsCount() <= LatencyTracer::MaxHwUnits, "Link events can't be traced on all units");
 
-template <typename T>
-struct Callback;
+std::array<std::atomic<HwPortLinkScanHandling*>, HwPortLinkScanHandling::MaxHwUnits> HwPortLinkScanHandling::_registeredHandlings {};
 
-template <typename Ret, typename... Params>
-struct Callback<Ret(Params...)> {
-    template <typename... Args>
-    static Ret callback(Args... args) { return func(args...); }
-    static std::function<Ret(Params...)> func;
-};
+HwPortLinkScanHandling::HwPortLinkScanHandling(const int hwUnit)
+    : _hwUnit { hwUnit }, _hwPortsLinkedUp {}, _hwPortsLinkDowns {}, _dirtyHwPorts {}, _notifierWakeUpPending { false }, _running { false },
+      _callbacks { 0 }, _ignoredCallbacks { 0 }, _notifierWakeUps { 0 }, _drainedPorts { 0 }, _linkDampening { MaxHwPorts },
+      _drainedLinkEventTimestamps {}, _linkEventBatchPool { MaxHwPorts, 2, MaxPooledLinkEventBatches },
+      _drainedLinkEvents { _linkEventBatchPool.acquire() } {
+    _hwPortsChangesToReport.reserve(MaxHwPorts);
+    _notifiedLinkEventTimestamps.reserve(MaxHwPorts);
+    if ((_hwUnit < 0) || (_hwUnit >= MaxHwUnits)) {
+        VLOG_ERR("Linkscan can't be handled on unit %d", _hwUnit);
+        return;
+    }
+
+    _registeredHandlings[static_cast<size_t>(_hwUnit)].store(this, std::memory_order_release);
+}
 
-// Initialize the static member.
-template <typename Ret, typename... Params>
-std::function<Ret(Params...)> Callback<Ret(Params...)>::func;
+HwPortLinkScanHandling::~HwPortLinkScanHandling() {
+    stop();
+    if ((_hwUnit >= 0) && (_hwUnit < MaxHwUnits)) {
+        // Unit is left without handling, unless other handling has replaced this one already
+        auto registeredHandling = this;
+        _registeredHandlings[static_cast<size_t>(_hwUnit)].compare_exchange_strong(registeredHandling, nullptr,
+                                                                                   std::memory_order_acq_rel);
+    }
+}
+
+Result::Value HwPortLinkScanHandling::start() {
+    if (_running.exchange(true)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    _notifierThread = std::thread { &HwPortLinkScanHandling::changeLinkStatusOnHwPortsNotifier, this };
+    return Result::Value::Success;
+}
 
-HwPortLinkScanHandling::HwPortLinkScanHandling()
-    : _linkStatusHwPortsUpdated { false } {
-    // Store member function and the instance using std::bind
-     Callback<void(int, opennsl_port_t, opennsl_port_info_t*)>::func = std::bind(&HwPortLinkScanHandling::portLinkStatusUpdate, *this,
-                                                                                 std::placeholders::_1, std::placeholders::_2,
-                                                                                 std::placeholders::_3);
-     // Convert callback-function to c-pointer
-     _linkScanHandler = static_cast<decltype(_linkScanHandler)>(Callback<void(int, opennsl_port_t, opennsl_port_info_t*)>::callback);
+void HwPortLinkScanHandling::stop() {
+    if (not _running.exchange(false)) {
+        return;
+    }
+
+    _linkStatusHwPortsUpdated.notify();
+    if (_notifierThread.joinable()) {
+        _notifierThread.join();
+    }
+}
+
+void HwPortLinkScanHandling::dispatchLinkStatusUpdate(int unit, opennsl_port_t port, opennsl_port_info_t* info) {
+    if ((unit < 0) || (unit >= MaxHwUnits)) {
+        return;
+    }
+
+    if (auto linkScanHandling = _registeredHandlings[static_cast<size_t>(unit)].load(std::memory_order_acquire)) {
+        linkScanHandling->portLinkStatusUpdate(unit, port, info);
+    }
 }
 
 void HwPortLinkScanHandling::portLinkStatusUpdate(int unit, opennsl_port_t port, opennsl_port_info_t* info) {
-    if (Asic::getDefaultHwUnit() != unit) {
+    _callbacks.fetch_add(1, std::memory_order_relaxed);
+    if ((_hwUnit != unit) || (port < 0) || (static_cast<size_t>(port) >= MaxHwPorts)) {
+        _ignoredCallbacks.fetch_add(1, std::memory_order_relaxed);
         return;
     }
-    // Save physical port link status for use later.
-    // Also update VLAN membership configuration.
-    std::unique_lock<std::mutex> mtx(gRecentlyLinkStatusChangedOnHwPortsMtx);
-    _recentlyLinkStatusChangedOnHwPorts.insert_or_assign(port, OPENNSL_PORT_LINK_STATUS_UP == info->linkstatus);
-    _linkStatusHwPortsUpdated = true;
-    mtx.unlock();
 
-    gRecentlyLinkStatusChangedOnHwPortsCondVar.notify_one();
+    // Save physical port link status, notifier reports it to observers
+    const auto tracedAt = LatencyTracer::getInstance().traceLinkEvent(unit, port);
+    const auto hwPort = static_cast<size_t>(port);
+    const bool linkedUp = OPENNSL_PORT_LINK_STATUS_UP == info->linkstatus;
+    _hwPortsLinkedUp[hwPort].store(linkedUp, std::memory_order_relaxed);
+    if (not linkedUp) {
+        _hwPortsLinkDowns[hwPort].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _dirtyHwPorts[hwPort / 64].fetch_or(uint64_t { 1 } << (hwPort % 64), std::memory_order_release);
+    // Notifier is woken up only if it is going to sleep, otherwise it picks up this change in next drain
+    if (not _notifierWakeUpPending.exchange(true, std::memory_order_seq_cst)) {
+        _linkStatusHwPortsUpdated.notify();
+    }
 
+    if (tracedAt != 0) {
+        LatencyTracer::getInstance().record(TraceStage::LinkScanCallback, LatencyTracer::now() - tracedAt);
+    }
 }
 
 void HwPortLinkScanHandling::changeLinkStatusOnHwPortsNotifier() {
-    while (true) {
-        std::map<opennsl_port_t, bool> currLinkStatusOnHwPorts {};
-        std::unique_lock<std::mutex> mlock(gRecentlyLinkStatusChangedOnHwPortsMtx);
-        gRecentlyLinkStatusChangedOnHwPortsCondVar.wait(mlock, std::bind(&HwPortLinkScanHandling::_linkStatusHwPortsUpdated, this));
-        currLinkStatusOnHwPorts.swap(_recentlyLinkStatusChangedOnHwPorts);
-        _linkStatusHwPortsUpdated = false;
-        mlock.unlock();
-
-        for (auto& portLinkStatus : currLinkStatusOnHwPorts) {
-            PortId portNo;
-            /// @todo portNo = Port::Mapping::HwPortToPanelPort(portLinkStatus.first);
-            _recentlyLinkStatusChangedOnPorts.insert_or_assign(portNo, portLinkStatus.second);
+    while (_running.load(std::memory_order_acquire)) {
+        // Wakes up also when dampening releases held changes, e.g. suppressed port can be reused
+        if (_linkStatusHwPortsUpdated.wait(getTimeToNextDampeningDeadline())) {
+            _notifierWakeUps.fetch_add(1, std::memory_order_relaxed);
         }
 
-        notifyAllObservers(UpdateReason::LinkStatusUpdate);
-        _recentlyLinkStatusChangedOnPorts.clear();
+        // Keep polling for a while after last change, so during link storm SDK thread finds wake-up
+        // still pending and doesn't need to make system call to wake up notifier
+        auto idleSince = std::chrono::steady_clock::now();
+        while (_running.load(std::memory_order_acquire)) {
+            if (drainDirtyHwPorts() > 0) {
+                notifyAboutDrainedChanges();
+                idleSince = std::chrono::steady_clock::now();
+            } else if (std::chrono::steady_clock::now() - idleSince < NotifierLingerTime) {
+                std::this_thread::yield();
+            } else if (processLinkStatusChanges() > 0) {
+                idleSince = std::chrono::steady_clock::now();
+            } else {
+                break;
+            }
+        }
     }
 }
 
@@ -95,12 +151,140 @@ size_t HwPortLinkScanHandling::getCommitOrderingResolve() const {
     return CommitOrderingResolve::Unordered;
 }
 
-Result::Value HwPortLinkScanHandling::execute(ResultCallback::Handle& /* callback */) {
-    return Result::Value::Fail;
+Result::Value HwPortLinkScanHandling::execute(ResultCallback::Handle& callback) {
+    if (_running.load(std::memory_order_acquire)) {
+        // Drained changes are owned by notifier thread, so it is only woken up to report them
+        _linkStatusHwPortsUpdated.notify();
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+    processLinkStatusChanges();
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+size_t HwPortLinkScanHandling::processLinkStatusChanges() {
+    if (0 == drainDirtyHwPorts()) {
+        // Notifier is going to sleep, so next change has to wake it up. Drain again to pick up
+        // changes marked as dirty in the meantime by SDK thread which still saw pending wake-up.
+        _notifierWakeUpPending.store(false, std::memory_order_seq_cst);
+        drainDirtyHwPorts();
+    }
+
+    // Even without dirty ports dampening could release held changes
+    return notifyAboutDrainedChanges();
+}
+
+size_t HwPortLinkScanHandling::notifyAboutDrainedChanges() {
+    const size_t changedPortsCount = _drainedLinkEvents->size();
+    if (changedPortsCount > 0) {
+        // Observers get events with the update, batch goes back to pool once they release it. Observer,
+        // which needs events after its update returns, keeps the handle instead of copying them.
+        const LinkEventBatch::Handle linkEvents { std::move(_drainedLinkEvents) };
+        _drainedLinkEvents = _linkEventBatchPool.acquire();
+        notifyAllObservers(UpdateReason::LinkStatusUpdate, linkEvents);
+        const auto notifiedAt = LatencyTracer::now();
+        for (const auto linkEventTimestamp : _notifiedLinkEventTimestamps) {
+            LatencyTracer::getInstance().record(TraceStage::LinkStatusNotified, notifiedAt - linkEventTimestamp);
+        }
+
+        _notifiedLinkEventTimestamps.clear();
+    }
+
+    return changedPortsCount;
+}
+
+size_t HwPortLinkScanHandling::drainDirtyHwPorts() {
+    size_t drainedPortsCount = 0;
+    const auto now = HwPortLinkDampening::Clock::now();
+    for (size_t wordIndex = 0; wordIndex < _dirtyHwPorts.size(); ++wordIndex) {
+        uint64_t dirtyWord = _dirtyHwPorts[wordIndex].exchange(0, std::memory_order_acq_rel);
+        while (dirtyWord) {
+            const auto hwPort = wordIndex * 64 + static_cast<size_t>(__builtin_ctzll(dirtyWord));
+            dirtyWord &= dirtyWord - 1;
+            const auto linkDowns = _hwPortsLinkDowns[hwPort].exchange(0, std::memory_order_relaxed);
+            const bool linkedUp = _hwPortsLinkedUp[hwPort].load(std::memory_order_relaxed);
+            const auto linkEventTimestamp = LatencyTracer::getInstance().traceLinkEventDrained(_hwUnit, static_cast<opennsl_port_t>(hwPort), linkedUp);
+            // The earliest event is kept, while port is held back by dampening
+            if (0 == _drainedLinkEventTimestamps[hwPort]) {
+                _drainedLinkEventTimestamps[hwPort] = linkEventTimestamp;
+            }
+
+            _linkDampening.onLinkStatusChange(static_cast<opennsl_port_t>(hwPort), linkedUp, linkDowns, now, _hwPortsChangesToReport);
+            ++drainedPortsCount;
+        }
+    }
+
+    _linkDampening.releaseHeldChanges(now, _hwPortsChangesToReport);
+    const auto drainedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    for (const auto& hwPortLinkStatus : _hwPortsChangesToReport) {
+        const PortId portNo = Mapping::hwPortToPanelPort(_hwUnit, hwPortLinkStatus.first);
+        auto& linkEventTimestamp = _drainedLinkEventTimestamps[static_cast<size_t>(hwPortLinkStatus.first)];
+        if (portNo == PortParameters::InvalidPort) { // H/w port is not wired to front panel
+            linkEventTimestamp = 0;
+            continue;
+        }
+
+        _drainedLinkEvents->add({ portNo, hwPortLinkStatus.second, static_cast<int64_t>(drainedAt) });
+        if (linkEventTimestamp != 0) {
+            _notifiedLinkEventTimestamps.push_back(linkEventTimestamp);
+            linkEventTimestamp = 0;
+        }
+    }
+
+    _hwPortsChangesToReport.clear();
+    _drainedPorts.fetch_add(drainedPortsCount, std::memory_order_relaxed);
+    return drainedPortsCount;
+}
+
+std::chrono::milliseconds HwPortLinkScanHandling::getTimeToNextDampeningDeadline() const {
+    const auto nextDeadline = _linkDampening.getNextDeadline();
+    if (HwPortLinkDampening::Clock::time_point::max() == nextDeadline) {
+        return std::chrono::milliseconds { -1 };
+    }
+
+    const auto now = HwPortLinkDampening::Clock::now();
+    if (nextDeadline <= now) {
+        return std::chrono::milliseconds { 0 };
+    }
+
+    // Rounded up, so notifier doesn't wake up just before deadline
+    return std::chrono::ceil<std::chrono::milliseconds>(nextDeadline - now);
+}
+
+Result::Value HwPortLinkScanHandling::setLinkDampeningParameters(const HwPortLinkDampening::Parameters& parameters) {
+    const auto result = _linkDampening.setParameters(parameters);
+    if (Result::Failed(result)) {
+        return result;
+    }
+
+    // Notifier has to recalculate its sleep time and report ports which aren't suppressed anymore
+    _linkStatusHwPortsUpdated.notify();
+    return Result::Value::Success;
 }
 
-HwPortModuleInitializing::HwPortModuleInitializing(HwPortLinkScanHandling::Handle& linkScanHandle)
-    : _linkScanHandle { linkScanHandle } {
+HwPortLinkDampening::Parameters HwPortLinkScanHandling::getLinkDampeningParameters() const {
+    return _linkDampening.getParameters();
+}
+
+HwPortLinkDampening::Statistics HwPortLinkScanHandling::getLinkDampeningStatistics() const {
+    return _linkDampening.getStatistics();
+}
+
+LinkEventBatchPool::Statistics HwPortLinkScanHandling::getLinkEventBatchPoolStatistics() const {
+    return _linkEventBatchPool.getStatistics();
+}
+
+HwPortLinkScanHandling::Statistics HwPortLinkScanHandling::getStatistics() const {
+    Statistics statistics {};
+    statistics.callbacks = _callbacks.load(std::memory_order_relaxed);
+    statistics.ignoredCallbacks = _ignoredCallbacks.load(std::memory_order_relaxed);
+    statistics.notifierWakeUps = _notifierWakeUps.load(std::memory_order_relaxed);
+    statistics.drainedPorts = _drainedPorts.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+HwPortModuleInitializing::HwPortModuleInitializing(HwPortLinkScanHandling::Handle& linkScanHandle, const size_t groupsCount)
+    : _linkScanHandle { linkScanHandle }, _groupsCount { groupsCount }, _phaseTimings {} {
     // Nothing more to do
 }
 
@@ -109,15 +293,14 @@ size_t HwPortModuleInitializing::getCommitOrderingResolve() const {
 }
 
 Result::Value HwPortModuleInitializing::execute(ResultCallback::Handle& callback) {
-    opennsl_port_t hw_port {};
-    opennsl_port_config_t pcfg {};
     int rc = OPENNSL_E_NONE;
+    const int hwUnit = _linkScanHandle->getHwUnit();
     // Update CPU port's L2 learning behavior to forward frames with
     // unknown src MACs.  This is the way it's always been, but the
     // default changed somehow when we upgraded from SDK-5.6.2 to
     // 5.9.0.  See Broadcom support case #382115.
-    rc = opennsl_port_control_set(Asic::getDefaultHwUnit(),
-                                  Asic::getCpuPort(Asic::getDefaultHwUnit()),
+    rc = opennsl_port_control_set(hwUnit,
+                                  Asic::getCpuPort(hwUnit),
                                   opennslPortControlL2Move,
                                   OPENNSL_PORT_LEARN_FWD);
     if (OPENNSL_FAILURE(rc)) {
@@ -131,7 +314,7 @@ Result::Value HwPortModuleInitializing::execute(ResultCallback::Handle& callback
     // Note that all ports come up by default in a disabled
     // state.  So until intfd is ready to enable the ports,
     // we should not get any callbacks.
-    rc = opennsl_linkscan_register(Asic::getDefaultHwUnit(), _linkScanHandle->getLinkScanCallback());
+    rc = opennsl_linkscan_register(hwUnit, _linkScanHandle->getLinkScanCallback());
     if (OPENNSL_FAILURE(rc)) {
         VLOG_ERR("Linkscan registration error, err=%d (%s)",
                  rc, opennsl_errmsg(rc));
@@ -143,29 +326,49 @@ Result::Value HwPortModuleInitializing::execute(ResultCallback::Handle& callback
     // for all Ethernet interfaces defined in the system.
     // Clear the stats for all Ethernet interfaces during initialization
     // This improvement is necessary for AS7712
-    if (OPENNSL_SUCCESS(opennsl_port_config_get(Asic::getDefaultHwUnit(), &pcfg))) {
-        OPENNSL_PBMP_ITER(pcfg.e, hw_port) {
-            rc = opennsl_port_vlan_member_set(Asic::getDefaultHwUnit(), hw_port,
-                                              (OPENNSL_PORT_VLAN_MEMBER_INGRESS |
-                                               OPENNSL_PORT_VLAN_MEMBER_EGRESS));
-            if (OPENNSL_FAILURE(rc)) {
-                VLOG_ERR("Failed to set unit %d hw_port %d VLAN filter "
-                         "mode, err=%d (%s)",
-                         hw_unit, hw_port, rc, opennsl_errmsg(rc));
-            }
-            rc = opennsl_stat_clear(Asic::getDefaultHwUnit(), hw_port);
-            if (OPENNSL_FAILURE(rc)) {
-                VLOG_ERR("Failed to clear stat unit %d hw_port %d "
-                         "err=%d (%s)",
-                         hw_unit, hw_port, rc, opennsl_errmsg(rc));
-            }
-        }
-    } else {
-        VLOG_ERR("Failed to get switch port configuration");
+    std::vector<opennsl_port_t> hwPorts {};
+    rc = HwPortBulkInitializing::getEthernetPorts(hwUnit, hwPorts);
+    if (OPENNSL_FAILURE(rc)) {
+        VLOG_ERR("Failed to get switch port configuration, err=%d (%s)",
+                 rc, opennsl_errmsg(rc));
         callback->onCommandResult(Result::Value::Fail);
         return Result::Value::Fail;
     }
 
+    // Unit without Ethernet ports is initialized already, phases below have nothing to do
+    if (not hwPorts.empty()) {
+        HwPortAbilityCache::reserve(hwUnit, static_cast<size_t>(hwPorts.back()) + 1);
+    }
+
+    HwPortAbilityCache::invalidateUnit(hwUnit);
+    HwPortBulkInitializing bulkInitializing { hwUnit, std::move(hwPorts), _groupsCount };
+    bulkInitializing.runPhase(HwPortBulkInitializing::Phase::VlanMemberSet, [](const int hwUnit, const opennsl_port_t hw_port) {
+        const int rc = opennsl_port_vlan_member_set(hwUnit, hw_port, (OPENNSL_PORT_VLAN_MEMBER_INGRESS | OPENNSL_PORT_VLAN_MEMBER_EGRESS));
+        if (OPENNSL_FAILURE(rc)) {
+            VLOG_ERR("Failed to set unit %d hw_port %d VLAN filter "
+                     "mode, err=%d (%s)",
+                     hwUnit, hw_port, rc, opennsl_errmsg(rc));
+        }
+
+        return rc;
+    });
+    bulkInitializing.runPhase(HwPortBulkInitializing::Phase::StatClear, [](const int hwUnit, const opennsl_port_t hw_port) {
+        const int rc = opennsl_stat_clear(hwUnit, hw_port);
+        if (OPENNSL_FAILURE(rc)) {
+            VLOG_ERR("Failed to clear stat unit %d hw_port %d "
+                     "err=%d (%s)",
+                     hwUnit, hw_port, rc, opennsl_errmsg(rc));
+        }
+
+        return rc;
+    });
+    // Abilities are read only once here, later settings take them from cache
+    bulkInitializing.runPhase(HwPortBulkInitializing::Phase::AbilitiesPopulate, [](const int hwUnit, const opennsl_port_t hw_port) {
+        HwPortAbilityCache::populate(hwUnit, hw_port);
+        return OPENNSL_E_NONE;
+    });
+    _phaseTimings = bulkInitializing.getPhaseTimings();
+
     callback->onCommandResult(Result::Value::Success);
     return Result::Value::Success;
 }
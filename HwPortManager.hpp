@@ -14,7 +14,15 @@
 
 #pragma once
 
+#include "EventNotifier.hpp"
 #include "HwPort.hpp"
+#include "HwPortLinkDampening.hpp"
+#include "LinkEventBatch.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 class HwPortManager : public Command, public ObservedSubject {
   public:
@@ -24,63 +32,133 @@ class HwPortManager : public Command, public ObservedSubject {
 class HwPortLinkScanHandling : public HwPort, public ObservedSubject {
   public:
     using Handle = std::shared_ptr<HwPortLinkScanHandling>;
-    HwPortLinkScanHandling();
-    virtual ~HwPortLinkScanHandling() override = default;
+    static constexpr size_t MaxHwPorts = MaxPorts;
+    static constexpr int MaxHwUnits = 8;
+    /// Time of polling for next link changes before notifier goes to sleep
+    static constexpr std::chrono::microseconds NotifierLingerTime { 50 };
+    /// Batches of link events held by observers at once, which are recycled without allocation
+    static constexpr size_t MaxPooledLinkEventBatches = 16;
+    struct Statistics {
+        uint64_t callbacks;
+        uint64_t ignoredCallbacks; // From other unit or about port out of range
+        uint64_t notifierWakeUps;
+        uint64_t drainedPorts;
+    };
+
+    /// Handling is registered as the one which SDK linkscan callback of @p hwUnit is dispatched to.
+    /// Handling created later for the same unit replaces it.
+    /// @note SDK callback has to be unregistered before handling is destroyed
+    explicit HwPortLinkScanHandling(const int hwUnit = Asic::getDefaultHwUnit());
+    virtual ~HwPortLinkScanHandling() override;
+    int getHwUnit() const { return _hwUnit; }
+    /// Starts thread which notifies observers about link status changes
+    Result::Value start();
+    void stop();
     inline opennsl_linkscan_handler_t getLinkScanCallback() const;
-    inline std::map<PortId, bool> getRecentlyLinkStatusChangedOnPorts() const;
     virtual size_t getCommitOrderingResolve() const override;
+    /// Notifies observers about link status changes collected from SDK linkscan callback since last call,
+    /// they get them by Observer::updateLinkStatus(). After start() it only wakes up notifier thread,
+    /// which reports the changes.
+    /// @note Not thread safe with start() and stop()
     virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    Statistics getStatistics() const;
+    /// Ports suppressed by dampening are reported by notifier as soon as dampening is disabled
+    Result::Value setLinkDampeningParameters(const HwPortLinkDampening::Parameters& parameters);
+    HwPortLinkDampening::Parameters getLinkDampeningParameters() const;
+    HwPortLinkDampening::Statistics getLinkDampeningStatistics() const;
+    LinkEventBatchPool::Statistics getLinkEventBatchPoolStatistics() const;
 
   private:
+    /// SDK linkscan callback of all units. It calls handling registered for unit directly, without
+    /// any lock or allocation.
+    static void dispatchLinkStatusUpdate(int unit, opennsl_port_t port, opennsl_port_info_t* info);
+    /// Called in SDK linkscan thread. It never blocks nor allocates, because time spent here delays
+    /// detection of link changes on other ports.
     void portLinkStatusUpdate(int unit, opennsl_port_t port, opennsl_port_info_t* info);
     /// We need keep notifies observers about link status update in separated thread,
     /// because Broadcom linkscan callback is called in SDK thread so we can't stuck
     /// in handling observer's callbacks.
     void changeLinkStatusOnHwPortsNotifier();
-    opennsl_linkscan_handler_t _linkScanHandler;
-    bool _linkStatusHwPortsUpdated;
-    std::map<opennsl_port_t, bool> _recentlyLinkStatusChangedOnHwPorts;
-    std::map<PortId, bool> _recentlyLinkStatusChangedOnPorts;
+    /// @return number of ports which observers have been notified about
+    size_t processLinkStatusChanges();
+    /// Passes drained changes through dampening, so only changes not held back reach observers
+    size_t drainDirtyHwPorts();
+    size_t notifyAboutDrainedChanges();
+    std::chrono::milliseconds getTimeToNextDampeningDeadline() const;
+    static std::array<std::atomic<HwPortLinkScanHandling*>, MaxHwUnits> _registeredHandlings; // Indexed by unit
+    const int _hwUnit;
+    // Link status of port is stored before port is marked as dirty, so notifier always reads
+    // the latest status of dirty port. Many changes of one port before drain are merged.
+    std::array<std::atomic<bool>, MaxHwPorts> _hwPortsLinkedUp;
+    // Link downs merged into one dirty mark still have to be accounted by dampening
+    std::array<std::atomic<uint32_t>, MaxHwPorts> _hwPortsLinkDowns;
+    std::array<std::atomic<uint64_t>, (MaxHwPorts + 63) / 64> _dirtyHwPorts;
+    std::atomic<bool> _notifierWakeUpPending;
+    EventNotifier _linkStatusHwPortsUpdated;
+    std::atomic<bool> _running;
+    std::thread _notifierThread;
+    std::atomic<uint64_t> _callbacks;
+    std::atomic<uint64_t> _ignoredCallbacks;
+    std::atomic<uint64_t> _notifierWakeUps;
+    std::atomic<uint64_t> _drainedPorts;
+    HwPortLinkDampening _linkDampening;
+    // Members below are used only by notifier thread, or by execute() while notifier is not running
+    HwPortLinkDampening::LinkChanges _hwPortsChangesToReport;
+    // Traced link events
+    std::array<int64_t, MaxHwPorts> _drainedLinkEventTimestamps; // Indexed by h/w port
+    std::vector<int64_t> _notifiedLinkEventTimestamps;
+    LinkEventBatchPool _linkEventBatchPool;
+    std::shared_ptr<LinkEventBatch> _drainedLinkEvents; // Not shared until observers are notified
 };
 
-opennsl_linkscan_handler_t HwPortLinkScanHandling::getLinkScanCallback() const { return _linkScanHandler; }
-
-std::map<PortId, bool> HwPortLinkScanHandling::getRecentlyLinkStatusChangedOnPorts() const {
-    return _recentlyLinkStatusChangedOnPorts;
-}
+opennsl_linkscan_handler_t HwPortLinkScanHandling::getLinkScanCallback() const { return &dispatchLinkStatusUpdate; }
 
 class HwPortModuleInitializing final : public HwPort {
   public:
     using Handle = std::shared_ptr<HwPortModuleInitializing>;
-    HwPortModuleInitializing(HwPortLinkScanHandling::Handle& linkScanHandle);
+    /// @param groupsCount groups of ports initialized concurrently
+    HwPortModuleInitializing(HwPortLinkScanHandling::Handle& linkScanHandle,
+                             const size_t groupsCount = HwPortBulkInitializing::DefaultGroupsCount);
     virtual ~HwPortModuleInitializing() override = default;
     virtual size_t getCommitOrderingResolve() const override;
     virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    const HwPortBulkInitializing::PhaseTimings& getPhaseTimings() const { return _phaseTimings; }
 
   private:
     HwPortLinkScanHandling::Handle _linkScanHandle;
+    size_t _groupsCount;
+    HwPortBulkInitializing::PhaseTimings _phaseTimings;
 };
 
 class HwPortCommandFactory {
   public:
     using Handle = std::shared_ptr<HwPortCommandFactory>;
     HwPortCommandFactory();
+    inline HwPortAttributesCoalescing::Handle& getAttributesCoalescingCmd();
+    inline HwPortBreakoutSetting::Handle& getBreakoutSettingCmd();
     inline HwPortDefaultParametersSetting::Handle& getDefaultParametersSettingCmd();
     inline HwPortFdbFlushing::Handle& getFdbFlushingCmd();
+    inline HwPortLinkScanModeSetting::Handle& getLinkScanModeSettingCmd();
     inline HwPortParametersSetting::Handle& getParametersSettingCmd();
     inline HwPortShutdownSetting::Handle& getHwPortShutdownSettingCmd();
     inline HwPortSpeedSetting::Handle& getSpeedSettingCmd();
 
   private:
+    HwPortAttributesCoalescing::Handle _attributesCoalescing;
+    HwPortBreakoutSetting::Handle _breakoutSetting;
     HwPortDefaultParametersSetting::Handle _defaultParametersSetting;
     HwPortFdbFlushing::Handle _fdbFlushingCmd;
+    HwPortLinkScanModeSetting::Handle _linkScanModeSetting;
     HwPortParametersSetting::Handle _parametersSetting;
     HwPortShutdownSetting::Handle _shutdownSetting;
     HwPortSpeedSetting::Handle _speedSettingCmd;
 };
 
+HwPortAttributesCoalescing::Handle& HwPortCommandFactory::getAttributesCoalescingCmd() { return _attributesCoalescing; }
+HwPortBreakoutSetting::Handle& HwPortCommandFactory::getBreakoutSettingCmd() { return _breakoutSetting; }
 HwPortDefaultParametersSetting::Handle& HwPortCommandFactory::getDefaultParametersSettingCmd() { return _defaultParametersSetting; }
 HwPortFdbFlushing::Handle& HwPortCommandFactory::getFdbFlushingCmd() { return _fdbFlushingCmd; }
+HwPortLinkScanModeSetting::Handle& HwPortCommandFactory::getLinkScanModeSettingCmd() { return _linkScanModeSetting; }
 HwPortParametersSetting::Handle& HwPortCommandFactory::getParametersSettingCmd() { return _parametersSetting; }
 HwPortShutdownSetting::Handle& HwPortCommandFactory::getHwPortShutdownSettingCmd() { return _shutdownSetting; }
 HwPortSpeedSetting::Handle& HwPortCommandFactory::getSpeedSettingCmd() { return _speedSettingCmd; }
@@ -16,27 +16,181 @@
 
 #include "LoggingFacility.hpp"
 
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace OpenNos;
 
-opennsl_port_t HwPortMapping::panelPortToHwPort(const PortId /* portNo */) {
-    return 0;
+HwPortMapping::HwPortMapping() {
+    reset();
+}
+
+HwPortMapping::HwPortMapping(Unmapped) {
+    clear();
+}
+
+void HwPortMapping::clear() {
+    _hwPorts.fill(InvalidHwPort);
+    _hwUnits.fill(Asic::getDefaultHwUnit());
+    for (auto& panelPorts : _panelPorts) {
+        panelPorts.fill(PortParameters::InvalidPort);
+    }
+
+    PortLayout invalidPortLayout {};
+    invalidPortLayout.splitMode = PortSplitMode::None;
+    invalidPortLayout.parentPort = PortParameters::InvalidPort;
+    invalidPortLayout.slavePorts.fill(PortParameters::InvalidPort);
+    _portLayouts.fill(invalidPortLayout);
+    _panelPortNames.fill(PanelPortName {});
+}
+
+void HwPortMapping::reset() {
+    clear();
+    for (size_t portNo = 0; portNo < MaxPorts; ++portNo) {
+        if (portNo < MaxHwPorts) {
+            _hwPorts[portNo] = static_cast<opennsl_port_t>(portNo);
+            _panelPorts[Asic::getDefaultHwUnit()][portNo] = static_cast<PortId>(portNo);
+        }
+
+        _portLayouts[portNo].parentPort = static_cast<PortId>(portNo);
+        setPanelPortName(static_cast<PortId>(portNo));
+    }
+}
+
+void HwPortMapping::setPanelPortName(const PortId portNo) {
+    auto& portName = _panelPortNames[portNo];
+    const auto& portLayout = _portLayouts[portNo];
+    if (portNo == 0) {
+        std::snprintf(portName.data(), portName.size(), "cpu0");
+    }
+    else if (portLayout.splitMode != PortSplitMode::None) {
+        std::snprintf(portName.data(), portName.size(), "port-%hu:%hu", portLayout.parentPort,
+                      static_cast<unsigned short>(portLayout.laneNo));
+    }
+    else {
+        std::snprintf(portName.data(), portName.size(), "port-%hu", portNo);
+    }
+}
+
+void HwPortMapping::setPortLayout(const PortId portNo, const PortSplitMode splitMode, const PortLaneNo laneNo) {
+    if (portNo >= MaxPorts) {
+        return;
+    }
+
+    _portLayouts[portNo].splitMode = splitMode;
+    _portLayouts[portNo].laneNo = laneNo;
+    setPanelPortName(portNo);
 }
 
-PortId HwPortMapping::hwPortToPanelPort(const opennsl_port_t /* hwPort */) {
-    return 0;
+Result::Value HwPortMapping::load(const PlatformPortRecord* records, const size_t recordsCount) {
+    // Tables are built aside, so mapping in use is not touched by invalid records
+    std::unique_ptr<HwPortMapping> hwPortMapping { new HwPortMapping { Unmapped {} } };
+    auto& panelPorts = hwPortMapping->_panelPorts[Asic::getDefaultHwUnit()];
+    for (size_t i = 0; i < recordsCount; ++i) {
+        const auto& record = records[i];
+        if ((record.panelPort >= MaxPorts) || (record.hwPort >= MaxHwPorts) || (record.parentPort >= MaxPorts)) {
+            ERROR_LOG(stringFormat("Port %hu mapped to h/w port %hu is out of range", record.panelPort, record.hwPort));
+            return Result::Value::Fail;
+        }
+
+        if ((hwPortMapping->_hwPorts[record.panelPort] != InvalidHwPort)
+                || (panelPorts[record.hwPort] != PortParameters::InvalidPort)) {
+            ERROR_LOG(stringFormat("Port %hu or h/w port %hu is mapped twice", record.panelPort, record.hwPort));
+            return Result::Value::Fail;
+        }
+
+        if ((record.splitMode > static_cast<uint8_t>(PortSplitMode::_2x200))
+                || (record.laneNo > static_cast<uint8_t>(PortLaneNo::Lane_3_4))) {
+            ERROR_LOG(stringFormat("Port %hu has unknown split mode %hu or lane %hu", record.panelPort,
+                                   static_cast<unsigned short>(record.splitMode), static_cast<unsigned short>(record.laneNo)));
+            return Result::Value::Fail;
+        }
+
+        hwPortMapping->_hwPorts[record.panelPort] = static_cast<opennsl_port_t>(record.hwPort);
+        panelPorts[record.hwPort] = record.panelPort;
+        auto& portLayout = hwPortMapping->_portLayouts[record.panelPort];
+        portLayout.splitMode = static_cast<PortSplitMode>(record.splitMode);
+        portLayout.laneNo = static_cast<PortLaneNo>(record.laneNo);
+        portLayout.parentPort = record.parentPort;
+        for (size_t slave = 0; slave < MaxSlavePorts; ++slave) {
+            if ((record.slavePorts[slave] >= MaxPorts) && (record.slavePorts[slave] != PortParameters::InvalidPort)) {
+                ERROR_LOG(stringFormat("Slave port %hu of port %hu is out of range", record.slavePorts[slave], record.panelPort));
+                return Result::Value::Fail;
+            }
+
+            portLayout.slavePorts[slave] = record.slavePorts[slave];
+        }
+
+        hwPortMapping->setPanelPortName(record.panelPort);
+    }
+
+    *this = *hwPortMapping;
+    return Result::Value::Success;
 }
 
-std::string HwPortMapping::getPanelPortName(const PortParameters portParameters) const {
-    std::string portName {};
-    if (portParameters.portNo == 0) {
-        portName = "cpu0";
+Result::Value HwPortMapping::load(const std::string& platformFilePath) {
+    const int fd = ::open(platformFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return Result::Value::NotExists;
+        }
+
+        ERROR_LOG(stringFormat("Failed to open platform file %s (%d)", platformFilePath.c_str(), errno));
+        return Result::Value::Fail;
     }
-    else if (portParameters.splitMode != PortSplitMode::None) {
-        portName = stringFormat("port-%hu:%hu", portParameters.parentPort, portParameters.laneNo);
+
+    struct stat fileStat {};
+    if ((::fstat(fd, &fileStat) != 0) || (static_cast<size_t>(fileStat.st_size) < sizeof(PlatformFileHeader))) {
+        ERROR_LOG(stringFormat("Platform file %s is truncated", platformFilePath.c_str()));
+        ::close(fd);
+        return Result::Value::Fail;
+    }
+
+    const size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    void* fileData = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (fileData == MAP_FAILED) {
+        ERROR_LOG(stringFormat("Failed to map platform file %s (%d)", platformFilePath.c_str(), errno));
+        return Result::Value::Fail;
+    }
+
+    Result::Value result = Result::Value::Fail;
+    const auto header = static_cast<const PlatformFileHeader*>(fileData);
+    if ((header->magic != PlatformFileMagic) || (header->version != PlatformFileVersion)) {
+        ERROR_LOG(stringFormat("Platform file %s has unknown format", platformFilePath.c_str()));
+    }
+    else if (fileSize != sizeof(PlatformFileHeader) + header->portsCount * sizeof(PlatformPortRecord)) {
+        ERROR_LOG(stringFormat("Platform file %s has size not matching %hu ports", platformFilePath.c_str(), header->portsCount));
     }
     else {
-        portName = stringFormat("port-%hu", portParameters.parentPort, portParameters.laneNo);
+        // Records start at offset aligned enough for them, because mapping is page aligned
+        result = load(reinterpret_cast<const PlatformPortRecord*>(header + 1), header->portsCount);
+    }
+
+    ::munmap(fileData, fileSize);
+    return result;
+}
+
+Result::Value HwPortMapping::store(const std::string& platformFilePath, const std::vector<PlatformPortRecord>& records) {
+    if (records.size() > MaxPorts) {
+        return Result::Value::Fail;
+    }
+
+    std::ofstream platformFile { platformFilePath, std::ios::binary | std::ios::trunc };
+    const PlatformFileHeader header { PlatformFileMagic, PlatformFileVersion, static_cast<uint16_t>(records.size()) };
+    platformFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    platformFile.write(reinterpret_cast<const char*>(records.data()),
+                       static_cast<std::streamsize>(records.size() * sizeof(PlatformPortRecord)));
+    if (!platformFile) {
+        ERROR_LOG(stringFormat("Failed to write platform file %s", platformFilePath.c_str()));
+        return Result::Value::Fail;
     }
 
-    return portName;
+    return Result::Value::Success;
 }
@@ -14,23 +14,129 @@
 
 #pragma once
 
+#include "Asic.hpp"
 #include "Compile.hpp"
 #include "Types.hpp"
 
-#include <string>
-
 extern "C" {
 #include <opennsl/port.h>
 }
 
+#include <algorithm>
+#include <array>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 namespace OpenNos {
 
+/// Front panel port as it is stored in platform file. Parent port of lane group has slave ports of
+/// its lanes, the first of them is parent port itself, each slave port has it as parent. Port which is
+/// not split has lane 0.
+struct PlatformPortRecord {
+    uint16_t panelPort;
+    uint16_t hwPort;
+    uint8_t splitMode; // PortSplitMode
+    uint8_t laneNo; // PortLaneNo, 0 if port is not a lane of split port
+    uint16_t parentPort;
+    std::array<uint16_t, MaxSlavePorts> slavePorts; // PortParameters::InvalidPort if not used
+};
+
+static_assert(sizeof(PlatformPortRecord) == 16, "Layout of platform file record has changed");
+
+/// Platform file starts with this header which is followed by records of ports
+struct PlatformFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t portsCount;
+};
+
+static_assert(sizeof(PlatformFileHeader) == 8, "Layout of platform file header has changed");
+
+/// Translates front panel ports to h/w ports of ASIC units and back. Link event and port command goes
+/// through translation, so both directions are single loads from dense tables. Unit or port out of range
+/// is clamped to the extra last entry, which is invalid, so translation has no branches.
+/// H/w port is identified by unit and port, the same port number of other unit is another port.
+/// Until platform file is loaded, panel port is mapped to h/w port of the same number on default unit.
+/// Platform file doesn't store unit, so ports loaded from it are on default unit too, ports of other
+/// units stay unmapped. H/w ports are limited by size of SDK port bitmap, panel ports above it stay unmapped.
 class HwPortMapping FINAL {
   public:
     using Handle = std::shared_ptr<HwPortMapping>;
-    opennsl_port_t panelPortToHwPort(const PortId portNo);
-    PortId hwPortToPanelPort(const opennsl_port_t hwPort);
-    std::string getPanelPortName(const PortParameters portParameters) const;
+    static constexpr size_t MaxHwPorts = std::min<size_t>(MaxPorts, OPENNSL_PBMP_PORT_MAX);
+    static constexpr int MaxHwUnits = 8;
+    static constexpr opennsl_port_t InvalidHwPort = -1;
+    static constexpr uint32_t PlatformFileMagic = 0x4d504e4f; // "ONPM"
+    static constexpr uint16_t PlatformFileVersion = 1;
+    static constexpr auto DefaultPlatformFilePath { "/etc/opennos/platform-ports.bin" };
+    static constexpr size_t MaxPanelPortNameSize = 16;
+
+    /// Breakout layout of port
+    struct PortLayout {
+        PortSplitMode splitMode;
+        PortLaneNo laneNo;
+        PortId parentPort;
+        std::array<PortId, MaxSlavePorts> slavePorts;
+    };
+
+    /// Mapping of this switch, it is defined in header to let translation be inlined
+    static HwPortMapping& getInstance() {
+        static HwPortMapping hwPortMapping {};
+        return hwPortMapping;
+    }
+
+    HwPortMapping();
+    /// Replaces mapping by ports of platform file, which is memory-mapped for time of loading.
+    /// Mapping has to be loaded before ports are created, it is not synchronized with translation.
+    /// @retval NotExists if there is no platform file, then mapping is left unchanged
+    Result::Value load(const std::string& platformFilePath);
+    /// Replaces mapping by @p records, mapping is left unchanged if any of them is invalid
+    Result::Value load(const PlatformPortRecord* records, const size_t recordsCount);
+    static Result::Value store(const std::string& platformFilePath, const std::vector<PlatformPortRecord>& records);
+    /// Restores identity mapping of all ports, none of them is split
+    void reset();
+    /// Called by breakout when lanes of port are reassigned, it is not synchronized with translation
+    void setPortLayout(const PortId portNo, const PortSplitMode splitMode, const PortLaneNo laneNo);
+
+    /// @retval InvalidHwPort if port is not mapped
+    opennsl_port_t panelPortToHwPort(const PortId portNo) const {
+        return _hwPorts[std::min<size_t>(portNo, MaxPorts)];
+    }
+
+    /// @return unit of h/w port which panel port is mapped to
+    int panelPortToHwUnit(const PortId portNo) const {
+        return _hwUnits[std::min<size_t>(portNo, MaxPorts)];
+    }
+
+    /// @retval PortParameters::InvalidPort if h/w port of @p hwUnit is not mapped
+    PortId hwPortToPanelPort(const int hwUnit, const opennsl_port_t hwPort) const {
+        return _panelPorts[std::min<size_t>(static_cast<unsigned int>(hwUnit), MaxHwUnits)]
+                          [std::min<size_t>(static_cast<std::make_unsigned_t<opennsl_port_t>>(hwPort), MaxHwPorts)];
+    }
+
+    const PortLayout& getPortLayout(const PortId portNo) const {
+        return _portLayouts[std::min<size_t>(portNo, MaxPorts)];
+    }
+
+    /// @return name precomputed when mapping was loaded, empty if port is not mapped
+    const char* getPanelPortName(const PortId portNo) const {
+        return _panelPortNames[std::min<size_t>(portNo, MaxPorts)].data();
+    }
+
+  private:
+    using PanelPortName = std::array<char, MaxPanelPortNameSize>;
+    struct Unmapped {};
+    /// Creates mapping without any port mapped
+    explicit HwPortMapping(Unmapped);
+    void clear();
+    void setPanelPortName(const PortId portNo);
+
+    // Each table has extra last entry of invalid port
+    std::array<opennsl_port_t, MaxPorts + 1> _hwPorts; // Indexed by panel port
+    std::array<int, MaxPorts + 1> _hwUnits; // Indexed by panel port
+    std::array<std::array<PortId, MaxHwPorts + 1>, MaxHwUnits + 1> _panelPorts; // Indexed by unit, then by h/w port
+    std::array<PortLayout, MaxPorts + 1> _portLayouts; // Indexed by panel port
+    std::array<PanelPortName, MaxPorts + 1> _panelPortNames; // Indexed by panel port
 };
 
 } // namespace OpenNos
@@ -14,7 +14,250 @@
 
 #include "HwVlan.hpp"
 
-HwVlan::HwVlan()
-{
+#include "Asic.hpp"
+#include "HwPort.hpp"
+#include "LoggingFacility.hpp"
 
+extern "C" {
+#   include <opennsl/error.h>
+#   include <opennsl/vlan.h>
+}
+
+namespace {
+
+VlanMemberPorts getLinkedUpMemberPorts(const VlanMemberPorts& memberPorts, const PortBitmap& linkedUpPorts) {
+    return { memberPorts.tagged & linkedUpPorts, memberPorts.untagged & linkedUpPorts };
+}
+
+} // namespace
+
+HwVlanMemberPortsSetting::HwVlanMemberPortsSetting(std::vector<Change> changes)
+    : _changes { std::move(changes) } {
+    _linkedUpPorts.setRange(0, static_cast<PortId>(MaxPorts - 1));
+}
+
+size_t HwVlanMemberPortsSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::VlanAddMemberPorts;
+}
+
+Result::Value HwVlanMemberPortsSetting::execute(ResultCallback::Handle& callback) {
+    HwMemberPortsDelta delta {};
+    for (size_t changeIndex = 0; changeIndex < _changes.size(); ++changeIndex) {
+        const auto& change = _changes[changeIndex];
+        if (Result::Failed(programMemberPorts(change.vid, getLinkedUpMemberPorts(change.before, _linkedUpPorts),
+                                              getLinkedUpMemberPorts(change.after, _linkedUpPorts), delta))) {
+            ERROR_LOG(stringFormat("Failed to set member ports of VLAN %hu", change.vid));
+            HwMemberPortsDelta revertingDelta {};
+            while (changeIndex-- > 0) {
+                const auto& revertedChange = _changes[changeIndex];
+                programMemberPorts(revertedChange.vid, getLinkedUpMemberPorts(revertedChange.after, _linkedUpPorts),
+                                   getLinkedUpMemberPorts(revertedChange.before, _linkedUpPorts), revertingDelta);
+            }
+
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+Result::Value HwVlanMemberPortsSetting::undo(ResultCallback::Handle& callback) {
+    Result::Value result = Result::Value::Success;
+    HwMemberPortsDelta delta {};
+    for (auto changeIt = _changes.rbegin(); changeIt != _changes.rend(); ++changeIt) {
+        if (Result::Failed(programMemberPorts(changeIt->vid, getLinkedUpMemberPorts(changeIt->after, _linkedUpPorts),
+                                              getLinkedUpMemberPorts(changeIt->before, _linkedUpPorts), delta))) {
+            ERROR_LOG(stringFormat("Failed to restore member ports of VLAN %hu", changeIt->vid));
+            result = Result::Value::Fail;
+        }
+    }
+
+    callback->onCommandResult(result);
+    return result;
+}
+
+void HwVlanMemberPortsSetting::toHwPortBitmap(const PortBitmap& ports, opennsl_pbmp_t& hwPorts) {
+    OPENNSL_PBMP_CLEAR(hwPorts);
+    for (const auto portNo : ports) {
+        const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(portNo);
+        if (hwPort == OpenNos::HwPortMapping::InvalidHwPort) {
+            continue;
+        }
+
+        if (hwPort >= OPENNSL_PBMP_PORT_MAX) {
+            ERROR_LOG(stringFormat("H/w port %d of port %hu doesn't fit in SDK port bitmap", hwPort, portNo));
+            continue;
+        }
+
+        OPENNSL_PBMP_PORT_ADD(hwPorts, hwPort);
+    }
+}
+
+Result::Value HwVlanMemberPortsSetting::programMemberPorts(const VlanId vid, const VlanMemberPorts& from, const VlanMemberPorts& to,
+                                                           HwMemberPortsDelta& delta) {
+    const int hwUnit = Asic::getDefaultHwUnit();
+    const bool retaggingInPlace = HwVlanPortRetagging::isInPlace(hwUnit);
+    if ((not delta.converted) || (delta.from != from) || (delta.to != to) || (delta.retaggingInPlace != retaggingInPlace)) {
+        // Contains also re-tagged ports
+        const PortBitmap portsToAdd { (to.tagged - from.tagged) | (to.untagged - from.untagged) };
+        const PortBitmap retaggedPorts { portsToAdd & from.getMembers() };
+        PortBitmap portsToRemove { from.getMembers() - to.getMembers() };
+        if (not retaggingInPlace) {
+            portsToRemove |= retaggedPorts;
+        }
+
+        toHwPortBitmap(portsToRemove, delta.hwPortsToRemove);
+        toHwPortBitmap(portsToAdd, delta.hwPortsToAdd);
+        toHwPortBitmap(portsToAdd & to.untagged, delta.hwUntaggedPortsToAdd);
+        toHwPortBitmap(retaggedPorts, delta.hwRetaggedPorts);
+        delta.removing = not portsToRemove.empty();
+        delta.adding = not portsToAdd.empty();
+        delta.retagging = retaggingInPlace && (not retaggedPorts.empty());
+        delta.retaggingInPlace = retaggingInPlace;
+        delta.from = from;
+        delta.to = to;
+        delta.converted = true;
+    }
+
+    if (delta.removing) {
+        const int rv = opennsl_vlan_port_remove(hwUnit, vid, delta.hwPortsToRemove);
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed on BCM API call: %s (%d)", opennsl_errmsg(rv), rv));
+            return Result::Value::Fail;
+        }
+    }
+
+    if (delta.adding) {
+        const int rv = opennsl_vlan_port_add(hwUnit, vid, delta.hwPortsToAdd, delta.hwUntaggedPortsToAdd);
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed on BCM API call: %s (%d)", opennsl_errmsg(rv), rv));
+            return Result::Value::Fail;
+        }
+    }
+
+    if (delta.retagging) {
+        const int rv = HwVlanPortRetagging::verifyInPlace(hwUnit, vid, delta.hwRetaggedPorts, delta.hwUntaggedPortsToAdd);
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to re-tag ports of VLAN %hu: %s (%d)", vid, opennsl_errmsg(rv), rv));
+            return Result::Value::Fail;
+        }
+    }
+
+    return Result::Value::Success;
+}
+
+HwVlanRangeSetting::HwVlanRangeSetting(const Action action, const VlanBitmap& vids)
+    : _action { action }, _vids { vids } {
+    // Nothing more to do
+}
+
+size_t HwVlanRangeSetting::getCommitOrderingResolve() const {
+    return Action::Create == _action ? CommitOrderingResolve::VlanCreate : CommitOrderingResolve::VlanDelete;
+}
+
+Result::Value HwVlanRangeSetting::execute(ResultCallback::Handle& callback) {
+    VlanBitmap applied {};
+    if (Result::Failed(apply(_action, _vids, applied))) {
+        VlanBitmap reverted {};
+        apply(getReverseAction(_action), applied, reverted);
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+Result::Value HwVlanRangeSetting::undo(ResultCallback::Handle& callback) {
+    VlanBitmap reverted {};
+    const Result::Value result = apply(getReverseAction(_action), _vids, reverted);
+    callback->onCommandResult(result);
+    return result;
+}
+
+Result::Value HwVlanRangeSetting::apply(const Action action, const VlanBitmap& vids, VlanBitmap& applied) {
+    // OpenNSL has no call which creates or destroys many VLANs at once
+    for (const auto vid : vids) {
+        const int rv = Action::Create == action ? opennsl_vlan_create(Asic::getDefaultHwUnit(), vid)
+                                                : opennsl_vlan_destroy(Asic::getDefaultHwUnit(), vid);
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to %s VLAN %hu: %s (%d)", Action::Create == action ? "create" : "destroy",
+                                   vid, opennsl_errmsg(rv), rv));
+            return Result::Value::Fail;
+        }
+
+        applied.set(vid);
+    }
+
+    return Result::Value::Success;
+}
+
+std::array<std::atomic<HwVlanPortRetagging::InPlace>, HwVlanPortRetagging::MaxHwUnits> HwVlanPortRetagging::_inPlace {};
+
+bool HwVlanPortRetagging::isInPlace(const int hwUnit) {
+    if ((hwUnit < 0) || (hwUnit >= MaxHwUnits)) {
+        return false;
+    }
+
+    // Unit not verified yet is tried in place, verifyInPlace() falls back if it isn't
+    return _inPlace[static_cast<size_t>(hwUnit)].load(std::memory_order_relaxed) != InPlace::NotSupported;
+}
+
+int HwVlanPortRetagging::verifyInPlace(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwRetaggedPorts,
+                                       const opennsl_pbmp_t& hwUntaggedPorts) {
+    if ((hwUnit < 0) || (hwUnit >= MaxHwUnits)) {
+        return OPENNSL_E_UNIT;
+    }
+
+    auto& inPlace = _inPlace[static_cast<size_t>(hwUnit)];
+    if (inPlace.load(std::memory_order_relaxed) != InPlace::Unknown) {
+        return OPENNSL_E_NONE;
+    }
+
+    opennsl_pbmp_t hwMemberPorts;
+    opennsl_pbmp_t hwProgrammedUntaggedPorts;
+    const int rv = opennsl_vlan_port_get(hwUnit, vid, &hwMemberPorts, &hwProgrammedUntaggedPorts);
+    if (OPENNSL_FAILURE(rv)) {
+        return rv;
+    }
+
+    opennsl_port_t hwPort {};
+    OPENNSL_PBMP_ITER(hwRetaggedPorts, hwPort) {
+        if (OPENNSL_PBMP_MEMBER(hwUntaggedPorts, hwPort) != OPENNSL_PBMP_MEMBER(hwProgrammedUntaggedPorts, hwPort)) {
+            INFO_LOG(stringFormat("Unit %d doesn't re-tag VLAN member ports in place, they are removed and added again", hwUnit));
+            inPlace.store(InPlace::NotSupported, std::memory_order_relaxed);
+            return readdPorts(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+        }
+    }
+
+    inPlace.store(InPlace::Supported, std::memory_order_relaxed);
+    return OPENNSL_E_NONE;
+}
+
+int HwVlanPortRetagging::retag(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwRetaggedPorts,
+                               const opennsl_pbmp_t& hwUntaggedPorts) {
+    if (not isInPlace(hwUnit)) {
+        return readdPorts(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+    }
+
+    const int rv = opennsl_vlan_port_add(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+    if (OPENNSL_FAILURE(rv)) {
+        return rv;
+    }
+
+    return verifyInPlace(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+}
+
+void HwVlanPortRetagging::reset(const int hwUnit) {
+    if ((hwUnit >= 0) && (hwUnit < MaxHwUnits)) {
+        _inPlace[static_cast<size_t>(hwUnit)].store(InPlace::Unknown, std::memory_order_relaxed);
+    }
+}
+
+int HwVlanPortRetagging::readdPorts(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwPorts,
+                                    const opennsl_pbmp_t& hwUntaggedPorts) {
+    const int rv = opennsl_vlan_port_remove(hwUnit, vid, hwPorts);
+    if (OPENNSL_FAILURE(rv)) {
+        return rv;
+    }
+
+    return opennsl_vlan_port_add(hwUnit, vid, hwPorts, hwUntaggedPorts);
 }
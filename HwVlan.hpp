@@ -14,26 +14,125 @@
 
 #pragma once
 
-#include "Vlan.hpp"
+#include "Command.hpp"
+#include "VlanMembership.hpp"
 
-// This class maps front panel ports into ASIC port.
-class HwVlan
-{
+extern "C" {
+#   include <opennsl/types.h>
+}
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+/// Changes tagging mode of ports which stay members of VLAN. Adding of existing member by
+/// opennsl_vlan_port_add() updates its untagged flag in place, so its traffic isn't interrupted, but SDK
+/// API doesn't promise it. The first re-tagging on each unit is read back, and if tagging wasn't updated,
+/// ports of the unit are re-tagged by remove and add from then on.
+/// @note Thread safe
+class HwVlanPortRetagging final {
+  public:
+    static constexpr int MaxHwUnits = 8;
+    /// @retval false if ports of @p hwUnit have to be removed from VLAN before they are added with new tagging
+    static bool isInPlace(const int hwUnit);
+    /// Called after @p hwRetaggedPorts have been added to VLAN in place. Until it is known whether unit
+    /// re-tags in place, tagging is read back and fixed by remove and add if it wasn't updated.
+    /// @param hwUntaggedPorts ports which have to be untagged, others of @p hwRetaggedPorts tagged
+    static int verifyInPlace(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwRetaggedPorts,
+                             const opennsl_pbmp_t& hwUntaggedPorts);
+    /// Re-tags member ports by one add call, or by remove and add where it can't be done in place
+    static int retag(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwRetaggedPorts,
+                     const opennsl_pbmp_t& hwUntaggedPorts);
+    /// Forgets whether @p hwUnit re-tags in place, e.g. after its SDK has been reinitialized
+    static void reset(const int hwUnit);
+
+  private:
+    enum class InPlace : uint8_t {
+        Unknown,
+        Supported,
+        NotSupported
+    };
+
+    static int readdPorts(const int hwUnit, const opennsl_vlan_t vid, const opennsl_pbmp_t& hwPorts, const opennsl_pbmp_t& hwUntaggedPorts);
+    static std::array<std::atomic<InPlace>, MaxHwUnits> _inPlace; // Indexed by unit
+};
+
+/// Programs changes of VLAN member ports into ASIC. One command carries all VLANs changed by
+/// one commit, so whole commit is passed to ASIC thread by one queue operation.
+/// Only member ports which link is up are programmed, see setLinkedUpPorts().
+class HwVlanMemberPortsSetting final : public UndoableCommand {
   public:
-    HwVlan(Vlan::Handle vlan) : _vlan { vlan } {}
+    using Handle = std::shared_ptr<HwVlanMemberPortsSetting>;
+    struct Change {
+        VlanId vid;
+        VlanMemberPorts before;
+        VlanMemberPorts after;
+    };
+
+    explicit HwVlanMemberPortsSetting(std::vector<Change> changes);
+    virtual ~HwVlanMemberPortsSetting() override = default;
+    virtual size_t getCommitOrderingResolve() const override;
+    /// If programming of any VLAN fails, already programmed VLANs are reverted
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override;
+    const std::vector<Change>& getChanges() const { return _changes; }
+    /// Member ports out of @p linkedUpPorts are left out of ASIC VLANs by execute() and undo(), so port
+    /// which link is down isn't programmed only to be removed right after. All ports are programmed by default.
+    void setLinkedUpPorts(const PortBitmap& linkedUpPorts) { _linkedUpPorts = linkedUpPorts; }
+    const PortBitmap& getLinkedUpPorts() const { return _linkedUpPorts; }
+    static void toHwPortBitmap(const PortBitmap& ports, opennsl_pbmp_t& hwPorts);
 
   private:
-    Vlan::Handle _vlan;
+    /// Change of member ports converted into h/w port bitmaps
+    struct HwMemberPortsDelta {
+        VlanMemberPorts from;
+        VlanMemberPorts to;
+        opennsl_pbmp_t hwPortsToRemove;
+        opennsl_pbmp_t hwPortsToAdd;
+        opennsl_pbmp_t hwUntaggedPortsToAdd;
+        opennsl_pbmp_t hwRetaggedPorts;
+        bool removing;
+        bool adding;
+        bool retagging;
+        bool retaggingInPlace;
+        bool converted;
+    };
+
+    /// Programs delta between @p from and @p to by at most one remove and one add call. Ports which only
+    /// change tagging mode are re-added in place where ASIC updates their untagged flag without removing
+    /// them from VLAN (see HwVlanPortRetagging), so their traffic isn't interrupted. VLANs changed by range
+    /// commands have the same change, so @p delta converted for previous VLAN is reused as long as change
+    /// doesn't differ.
+    static Result::Value programMemberPorts(const VlanId vid, const VlanMemberPorts& from, const VlanMemberPorts& to,
+                                            HwMemberPortsDelta& delta);
+
+    std::vector<Change> _changes;
+    PortBitmap _linkedUpPorts;
 };
 
-/// todo Should be notified about commit command?
-class HwAddingVlanMemberPorts : public Observer, public Command::ResultNotifier {
+/// Creates or destroys range of VLANs in ASIC. One command carries all VLANs created or destroyed
+/// by one commit, so whole range is passed to ASIC thread by one queue operation and it is
+/// reverted as a whole.
+class HwVlanRangeSetting final : public UndoableCommand {
   public:
-    HwAddingVlanMemberPorts(ManagingVlanMemberPorts::Handle addingVlanMemberPortsHandle)
-        : _addingVlanMemberPortsHandle { addingVlanMemberPortsHandle } {}
+    using Handle = std::shared_ptr<HwVlanRangeSetting>;
+    enum class Action {
+        Create,
+        Destroy
+    };
 
-    virtual void onCommandResultEvent(const Result result, const std::string msg) override;
+    HwVlanRangeSetting(const Action action, const VlanBitmap& vids);
+    virtual ~HwVlanRangeSetting() override = default;
+    virtual size_t getCommitOrderingResolve() const override;
+    /// If any VLAN fails, VLANs already created or destroyed by this command are reverted
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override;
 
   private:
-    ManagingVlanMemberPorts::Handle _addingVlanMemberPortsHandle;
+    /// @param [out] applied VLANs which have been created or destroyed before failure
+    static Result::Value apply(const Action action, const VlanBitmap& vids, VlanBitmap& applied);
+    static Action getReverseAction(const Action action) { return Action::Create == action ? Action::Destroy : Action::Create; }
+
+    Action _action;
+    VlanBitmap _vids;
 };
@@ -14,11 +14,23 @@
 
 #pragma once
 
+#include "Bitmap.hpp"
+#include "Types.hpp"
+
 #include <memory>
 
 class Lag {
   public:
-    using Handle = std::shared_ptr<Lag>;
-    using Id = uint16_t;
+    using Handle = LagHandle;
+    using Id = LagId;
+    using PortBitmap = Bitmap<MaxPorts, PortId>;
+    explicit Lag(const Id lagId) : _lagId { lagId } { /* Nothing more to do */ }
+    Id id() const { return _lagId; }
+    void setMemberPorts(const PortBitmap& memberPorts) { _memberPorts = memberPorts; }
+    const PortBitmap& getMemberPorts() const { return _memberPorts; }
+
+  private:
+    Id _lagId;
+    PortBitmap _memberPorts;
 };
 
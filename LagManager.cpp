@@ -14,3 +14,28 @@
 
 #include "LagManager.hpp"
 #include "PortManager.hpp"
+
+Result::Value LagManager::setMemberPorts(const Lag::Id lagId, const Lag::PortBitmap& memberPorts) {
+    auto lag = get(getHandle(lagId));
+    if (not lag) {
+        return Result::Value::NotExists;
+    }
+
+    lag->setMemberPorts(memberPorts);
+    _portManager->setLagMemberPorts(lagId, memberPorts);
+    return Result::Value::Success;
+}
+
+Result::Value LagManager::execute(ResultCallback::Handle& callback) {
+    // Macro evaluates its argument twice, so manager must not be executed inside it
+    const auto result = CommandManager::execute(callback);
+    if (Result::Failed(result)) {
+        return result;
+    }
+
+    for (const auto lagId : _mementoRemoved) {
+        _portManager->setLagMemberPorts(lagId, {});
+    }
+
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
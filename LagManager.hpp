@@ -18,9 +18,15 @@
 #include "Lag.hpp"
 #include "PortManager.hpp"
 
-class LagManager final : public CommandManager<Lag, Lag::Id, Lag::Handle> {
+class LagManager final : public CommandManager<Lag, Lag::Id, DenseCommandStorage<MaxLags>> {
   public:
+    using Handle = std::shared_ptr<LagManager>;
     inline LagManager(PortManager::Handle& portManager);
+    /// Member ports are passed to PortManager, so FDB of LAG is flushed only when its last member is gone
+    /// @return NotExists if LAG is not configured
+    Result::Value setMemberPorts(const Lag::Id lagId, const Lag::PortBitmap& memberPorts);
+    /// Member ports of removed LAGs are released
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
 
   private:
     PortManager::Handle _portManager;
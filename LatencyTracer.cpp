@@ -0,0 +1,216 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "LatencyTracer.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+const char* getStageName(const TraceStage stage) {
+    switch (stage) {
+      case TraceStage::LinkScanCallback: return "LinkScanCallback";
+      case TraceStage::NotifierDrain: return "NotifierDrain";
+      case TraceStage::ObserverUpdate: return "ObserverUpdate";
+      case TraceStage::LinkStatusNotified: return "LinkStatusNotified";
+      case TraceStage::FdbFlushed: return "FdbFlushed";
+      default: return "Unknown";
+    }
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : _buckets {}, _count { 0 }, _sumNs { 0 }, _maxNs { 0 } {
+    // Nothing more to do
+}
+
+size_t LatencyHistogram::getBucket(const uint64_t value) {
+    if (value < LinearBucketsCount) {
+        return static_cast<size_t>(value);
+    }
+
+    // Keep 7 significant bits, the highest one is always set
+    const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(value));
+    const size_t shift = msb - SubBucketBits;
+    return LinearBucketsCount + (shift - 1) * SubBucketsCount + static_cast<size_t>((value >> shift) - SubBucketsCount);
+}
+
+uint64_t LatencyHistogram::getBucketHighestValue(const size_t bucket) {
+    if (bucket < LinearBucketsCount) {
+        return bucket;
+    }
+
+    const size_t shift = (bucket - LinearBucketsCount) / SubBucketsCount + 1;
+    const uint64_t subBucket = (bucket - LinearBucketsCount) % SubBucketsCount + SubBucketsCount;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(const int64_t valueNs) {
+    const uint64_t value = static_cast<uint64_t>(std::max<int64_t>(valueNs, 0));
+    _buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sumNs.fetch_add(value, std::memory_order_relaxed);
+    auto maxNs = _maxNs.load(std::memory_order_relaxed);
+    while ((maxNs < static_cast<int64_t>(value))
+           && (not _maxNs.compare_exchange_weak(maxNs, static_cast<int64_t>(value), std::memory_order_relaxed))) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _sumNs.store(0, std::memory_order_relaxed);
+    _maxNs.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return _count.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::getMaxNs() const {
+    return _maxNs.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMeanNs() const {
+    const auto count = getCount();
+    return count ? static_cast<double>(_sumNs.load(std::memory_order_relaxed)) / static_cast<double>(count) : 0.0;
+}
+
+int64_t LatencyHistogram::getPercentileNs(const double percentile) const {
+    const auto count = getCount();
+    if (0 == count) {
+        return 0;
+    }
+
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count) + 0.5));
+    uint64_t cumulativeCount = 0;
+    for (size_t bucket = 0; bucket < BucketsCount; ++bucket) {
+        cumulativeCount += _buckets[bucket].load(std::memory_order_relaxed);
+        if (cumulativeCount >= rank) {
+            // Bucket can't report more than the real maximum
+            return std::min(static_cast<int64_t>(getBucketHighestValue(bucket)), getMaxNs());
+        }
+    }
+
+    return getMaxNs();
+}
+
+LatencyTracer::LatencyTracer()
+    : _enabled { false }, _linkEventTimestamps {}, _fdbFlushTimestamps {} {
+    // Nothing more to do
+}
+
+LatencyTracer& LatencyTracer::getInstance() {
+    static LatencyTracer latencyTracer {};
+    return latencyTracer;
+}
+
+int64_t LatencyTracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyTracer::setEnabled(const bool enabled) {
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void LatencyTracer::record(const TraceStage stage, const int64_t latencyNs) {
+    _histograms[static_cast<size_t>(stage)].record(latencyNs);
+}
+
+size_t LatencyTracer::getTracedPortIndex(const int hwUnit, const opennsl_port_t hwPort) {
+    if ((hwUnit < 0) || (hwUnit >= MaxHwUnits) || (hwPort < 0) || (static_cast<size_t>(hwPort) >= MaxHwPorts)) {
+        return MaxTracedPorts;
+    }
+
+    return static_cast<size_t>(hwUnit) * MaxHwPorts + static_cast<size_t>(hwPort);
+}
+
+int64_t LatencyTracer::traceLinkEvent(const int hwUnit, const opennsl_port_t hwPort) {
+    const auto tracedPortIndex = getTracedPortIndex(hwUnit, hwPort);
+    if ((not isEnabled()) || (MaxTracedPorts == tracedPortIndex)) {
+        return 0;
+    }
+
+    // Many changes of port before drain are measured from the first one
+    const auto timestamp = now();
+    int64_t noTimestamp = 0;
+    _linkEventTimestamps[tracedPortIndex].compare_exchange_strong(noTimestamp, timestamp, std::memory_order_relaxed);
+    return timestamp;
+}
+
+int64_t LatencyTracer::traceLinkEventDrained(const int hwUnit, const opennsl_port_t hwPort, const bool linkedUp) {
+    const auto tracedPortIndex = getTracedPortIndex(hwUnit, hwPort);
+    if ((not isEnabled()) || (MaxTracedPorts == tracedPortIndex)) {
+        return 0;
+    }
+
+    const auto timestamp = _linkEventTimestamps[tracedPortIndex].exchange(0, std::memory_order_relaxed);
+    if (0 == timestamp) {
+        return 0;
+    }
+
+    record(TraceStage::NotifierDrain, now() - timestamp);
+    if (not linkedUp) {
+        int64_t noTimestamp = 0;
+        _fdbFlushTimestamps[tracedPortIndex].compare_exchange_strong(noTimestamp, timestamp, std::memory_order_relaxed);
+    }
+
+    return timestamp;
+}
+
+void LatencyTracer::traceFdbFlushed(const int hwUnit, const opennsl_port_t hwPort) {
+    const auto tracedPortIndex = getTracedPortIndex(hwUnit, hwPort);
+    if ((not isEnabled()) || (MaxTracedPorts == tracedPortIndex)) {
+        return;
+    }
+
+    const auto timestamp = _fdbFlushTimestamps[tracedPortIndex].exchange(0, std::memory_order_relaxed);
+    if (timestamp != 0) {
+        record(TraceStage::FdbFlushed, now() - timestamp);
+    }
+}
+
+const LatencyHistogram& LatencyTracer::getHistogram(const TraceStage stage) const {
+    return _histograms[static_cast<size_t>(stage)];
+}
+
+void LatencyTracer::reset() {
+    for (auto& histogram : _histograms) {
+        histogram.reset();
+    }
+
+    for (size_t tracedPortIndex = 0; tracedPortIndex < MaxTracedPorts; ++tracedPortIndex) {
+        _linkEventTimestamps[tracedPortIndex].store(0, std::memory_order_relaxed);
+        _fdbFlushTimestamps[tracedPortIndex].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyTracer::dump(std::ostream& os) const {
+    os << std::left << std::setw(20) << "Stage [ns]" << std::right << std::setw(10) << "count" << std::setw(12) << "mean"
+       << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+       << std::setw(12) << "max" << '\n';
+    for (size_t stage = 0; stage < static_cast<size_t>(TraceStage::Count); ++stage) {
+        const auto& histogram = _histograms[stage];
+        os << std::left << std::setw(20) << getStageName(static_cast<TraceStage>(stage)) << std::right
+           << std::setw(10) << histogram.getCount() << std::setw(12) << static_cast<int64_t>(histogram.getMeanNs())
+           << std::setw(12) << histogram.getPercentileNs(50.0) << std::setw(12) << histogram.getPercentileNs(90.0)
+           << std::setw(12) << histogram.getPercentileNs(99.0) << std::setw(12) << histogram.getPercentileNs(99.9)
+           << std::setw(12) << histogram.getMaxNs() << '\n';
+    }
+}
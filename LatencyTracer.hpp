@@ -0,0 +1,102 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Types.hpp"
+
+extern "C" {
+#   include <opennsl/types.h>
+}
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/// Histogram of latencies in nanoseconds with log-linear buckets (like HDR histogram): values below
+/// 128 ns have own buckets, larger ones are bucketed by 7 most significant bits, so each reported
+/// value is within 1.6% of recorded one. Recording is wait-free and can be done from many threads.
+class LatencyHistogram final {
+  public:
+    LatencyHistogram();
+    void record(const int64_t valueNs);
+    void reset();
+    uint64_t getCount() const;
+    int64_t getMaxNs() const;
+    double getMeanNs() const;
+    /// @param percentile in range [0, 100]
+    /// @return the highest value equivalent to recorded one at @p percentile, 0 if empty
+    int64_t getPercentileNs(const double percentile) const;
+
+  private:
+    static constexpr size_t LinearBucketsCount = 128;
+    static constexpr size_t SubBucketBits = 6;
+    static constexpr size_t SubBucketsCount = size_t { 1 } << SubBucketBits;
+    static constexpr size_t BucketsCount = LinearBucketsCount + (63 - SubBucketBits) * SubBucketsCount;
+    static size_t getBucket(const uint64_t value);
+    static uint64_t getBucketHighestValue(const size_t bucket);
+
+    std::array<std::atomic<uint64_t>, BucketsCount> _buckets;
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sumNs;
+    std::atomic<int64_t> _maxNs;
+};
+
+/// Stages of link event handling which latency is traced
+enum class TraceStage : size_t {
+    LinkScanCallback,   // Time spent in SDK linkscan callback
+    NotifierDrain,      // Linkscan callback -> link change drained by notifier thread
+    ObserverUpdate,     // Time spent in single Observer::update()
+    LinkStatusNotified, // Linkscan callback -> all observers (PortManager, VLANs) updated
+    FdbFlushed,         // Linkscan callback -> FDB of port which went down flushed
+    Count
+};
+
+/// Collects trace points of link events into per-stage histograms. Link event is correlated between
+/// stages by unit and h/w port, which keep timestamp of the earliest link change not handled yet.
+/// Tracing is disabled by default, then trace points cost one relaxed load.
+class LatencyTracer final {
+  public:
+    static constexpr int MaxHwUnits = 8;
+    static LatencyTracer& getInstance();
+    static int64_t now();
+    void setEnabled(const bool enabled);
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+    void record(const TraceStage stage, const int64_t latencyNs);
+    /// Called by linkscan callback. Returns timestamp which callback duration is measured from.
+    int64_t traceLinkEvent(const int hwUnit, const opennsl_port_t hwPort);
+    /// Called when link change of port is drained.
+    /// @return timestamp of link event, 0 if not traced
+    int64_t traceLinkEventDrained(const int hwUnit, const opennsl_port_t hwPort, const bool linkedUp);
+    void traceFdbFlushed(const int hwUnit, const opennsl_port_t hwPort);
+    const LatencyHistogram& getHistogram(const TraceStage stage) const;
+    void reset();
+    /// Writes count, mean, p50, p90, p99, p99.9 and max of each stage
+    void dump(std::ostream& os) const;
+
+  private:
+    static constexpr size_t MaxHwPorts = MaxPorts;
+    static constexpr size_t MaxTracedPorts = MaxHwUnits * MaxHwPorts;
+    LatencyTracer();
+    /// @return index of timestamps of port, MaxTracedPorts if port can't be traced
+    static size_t getTracedPortIndex(const int hwUnit, const opennsl_port_t hwPort);
+
+    std::atomic<bool> _enabled;
+    std::array<LatencyHistogram, static_cast<size_t>(TraceStage::Count)> _histograms;
+    // H/w ports are numbered per unit, so the same h/w port of other unit has its own timestamp
+    std::array<std::atomic<int64_t>, MaxTracedPorts> _linkEventTimestamps; // Indexed by getTracedPortIndex()
+    std::array<std::atomic<int64_t>, MaxTracedPorts> _fdbFlushTimestamps; // Indexed by getTracedPortIndex()
+};
@@ -0,0 +1,70 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "LinkEventBatch.hpp"
+
+#include <algorithm>
+
+LinkEventBatch::LinkEventBatch(const size_t capacity) {
+    _linkEvents.reserve(capacity);
+}
+
+LinkEventBatch::Handle LinkEventBatch::merge(const LinkEventBatch& earlier, const LinkEventBatch& later) {
+    auto merged = std::make_shared<LinkEventBatch>(earlier.size() + later.size());
+    merged->_linkEvents.insert(std::end(merged->_linkEvents), std::begin(earlier._linkEvents), std::end(earlier._linkEvents));
+    merged->_linkEvents.insert(std::end(merged->_linkEvents), std::begin(later._linkEvents), std::end(later._linkEvents));
+    return merged;
+}
+
+LinkEventBatchPool::LinkEventBatchPool(const size_t batchCapacity, const size_t preallocatedBatchesCount, const size_t maxBatchesCount)
+    : _batchCapacity { batchCapacity }, _maxBatchesCount { std::max(maxBatchesCount, preallocatedBatchesCount) }, _nextBatchIndex { 0 },
+      _acquiredBatches { 0 }, _allocatedBatches { 0 }, _overflowBatches { 0 } {
+    _batches.reserve(_maxBatchesCount);
+    for (size_t i = 0; i < preallocatedBatchesCount; ++i) {
+        _batches.push_back(std::make_shared<LinkEventBatch>(_batchCapacity));
+    }
+}
+
+std::shared_ptr<LinkEventBatch> LinkEventBatchPool::acquire() {
+    _acquiredBatches.fetch_add(1, std::memory_order_relaxed);
+    // Batches are visited round robin, so the one released the longest time ago is found first
+    for (size_t visited = 0; visited < _batches.size(); ++visited) {
+        auto& batch = _batches[_nextBatchIndex];
+        _nextBatchIndex = (_nextBatchIndex + 1) % _batches.size();
+        // Only pool holds the batch and only pool hands it out, so nobody can take it in the meantime
+        if (1 == batch.use_count()) {
+            // Pairs with release of reference by observer, so its reads of batch happen before reuse
+            std::atomic_thread_fence(std::memory_order_acquire);
+            batch->_linkEvents.clear();
+            return batch;
+        }
+    }
+
+    if (_batches.size() >= _maxBatchesCount) {
+        _overflowBatches.fetch_add(1, std::memory_order_relaxed);
+        return std::make_shared<LinkEventBatch>(_batchCapacity);
+    }
+
+    _allocatedBatches.fetch_add(1, std::memory_order_relaxed);
+    _batches.push_back(std::make_shared<LinkEventBatch>(_batchCapacity));
+    return _batches.back();
+}
+
+LinkEventBatchPool::Statistics LinkEventBatchPool::getStatistics() const {
+    Statistics statistics {};
+    statistics.acquiredBatches = _acquiredBatches.load(std::memory_order_relaxed);
+    statistics.allocatedBatches = _allocatedBatches.load(std::memory_order_relaxed);
+    statistics.overflowBatches = _overflowBatches.load(std::memory_order_relaxed);
+    return statistics;
+}
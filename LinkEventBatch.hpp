@@ -0,0 +1,77 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct LinkEvent {
+    PortId portNo;
+    bool linkedUp;
+    int64_t timestampNs; // Steady clock time when change was drained from SDK linkscan callback
+};
+
+/// Link events notified to observers at once. Batch is immutable once it is handed over to observers,
+/// so all of them share it without copying. Events are ordered as they were drained, so when port
+/// appears more than once, its later event wins.
+class LinkEventBatch final {
+  public:
+    using Handle = std::shared_ptr<const LinkEventBatch>;
+    explicit LinkEventBatch(const size_t capacity);
+    /// @return new batch with events of @p earlier followed by events of @p later
+    static Handle merge(const LinkEventBatch& earlier, const LinkEventBatch& later);
+    void add(const LinkEvent& linkEvent) { _linkEvents.push_back(linkEvent); }
+    const LinkEvent* begin() const { return _linkEvents.data(); }
+    const LinkEvent* end() const { return _linkEvents.data() + _linkEvents.size(); }
+    const LinkEvent& operator[](const size_t index) const { return _linkEvents[index]; }
+    size_t size() const { return _linkEvents.size(); }
+    bool empty() const { return _linkEvents.empty(); }
+
+  private:
+    friend class LinkEventBatchPool;
+    std::vector<LinkEvent> _linkEvents;
+};
+
+/// Batch is recycled once the last observer releases it, so steady flow of link events doesn't
+/// allocate. Pool grows up to @p maxBatchesCount batches; when observers hold all of them, batch is
+/// allocated outside of pool and freed by the last observer, so observer which keeps batches for long
+/// can't make pool grow without bound. Pool is used only by thread which notifies about link events,
+/// except getStatistics(), which is thread safe.
+class LinkEventBatchPool final {
+  public:
+    struct Statistics {
+        uint64_t acquiredBatches;
+        uint64_t allocatedBatches; // Batches added to pool, because observers held all pooled ones
+        uint64_t overflowBatches; // Batches allocated outside of full pool
+    };
+
+    LinkEventBatchPool(const size_t batchCapacity, const size_t preallocatedBatchesCount, const size_t maxBatchesCount);
+    /// @return empty batch not shared with anyone
+    std::shared_ptr<LinkEventBatch> acquire();
+    Statistics getStatistics() const;
+
+  private:
+    size_t _batchCapacity;
+    size_t _maxBatchesCount;
+    std::vector<std::shared_ptr<LinkEventBatch>> _batches;
+    size_t _nextBatchIndex;
+    std::atomic<uint64_t> _acquiredBatches;
+    std::atomic<uint64_t> _allocatedBatches;
+    std::atomic<uint64_t> _overflowBatches;
+};
@@ -0,0 +1,122 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/// Bounded lock-free queue for many producers and single consumer.
+/// Each cell carries sequence number which tells producers and consumer whether the cell
+/// is free to write or ready to read, so no mutex is needed on any side.
+/// @note Capacity is rounded up to the power of two
+template <typename TYPE>
+class BoundedMpscQueue {
+  public:
+    explicit BoundedMpscQueue(const size_t capacity)
+        : _mask { roundUpToPowerOfTwo(capacity) - 1 },
+          _cells { std::make_unique<Cell[]>(_mask + 1) },
+          _enqueuePos { 0 }, _dequeuePos { 0 } {
+        for (size_t pos = 0; pos <= _mask; ++pos) {
+            _cells[pos].sequence.store(pos, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    /// @retval false if queue is full
+    bool push(TYPE&& value) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (0 == diff) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @note Has to be called only from one consumer thread
+    /// @retval false if queue is empty
+    bool pop(TYPE& value) {
+        const size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = _cells[pos & _mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(cell.value);
+        cell.value = TYPE {};
+        _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Producer reserves position before it publishes its item, so size() can count items which can't
+    /// be popped yet
+    /// @note Has to be called only from one consumer thread
+    /// @retval true if next pop() succeeds
+    bool isFrontPublished() const {
+        const size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        const size_t sequence = _cells[pos & _mask].sequence.load(std::memory_order_acquire);
+        return static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1) >= 0;
+    }
+
+    /// Approximated number of items, because producers can push concurrently
+    size_t size() const {
+        const size_t enqueuePos = _enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeuePos = _dequeuePos.load(std::memory_order_relaxed);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        TYPE value;
+    };
+
+    static size_t roundUpToPowerOfTwo(const size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+    // Producers and consumer touch different positions, so keep them in separated cache lines
+    alignas(64) std::atomic<size_t> _enqueuePos;
+    alignas(64) std::atomic<size_t> _dequeuePos;
+};
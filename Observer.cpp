@@ -13,50 +13,219 @@
 // limitations under the License.
 
 #include "Observer.hpp"
+#include "EventBus.hpp"
+#include "LatencyTracer.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
 
-class IsObserverEqualTo final {
-  public:
-    explicit IsObserverEqualTo(const Observer::Handle& observer) : _observer { observer } {}
-    bool operator()(const Observer::Handle& observerToCompare) {
-        return observerToCompare->hash() == _observer->hash();
+namespace {
+
+ObserverId getNextObserverId() {
+    static std::atomic<ObserverId> nextObserverId { 0 };
+    return nextObserverId.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+Observer::Observer(std::initializer_list<UpdateReason> supportedUpdateReasons)
+    : _supportedUpdateReasons { 0 }, _observerId { getNextObserverId() } {
+    for (const auto updateReason : supportedUpdateReasons) {
+        _supportedUpdateReasons |= toUpdateReasonMask(updateReason);
     }
+}
+
+void Observer::updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& /* linkEvents */) {
+    update(subject, UpdateReason::LinkStatusUpdate);
+}
 
-  private:
-    Observer::Handle _observer;
-};
+void Observer::dispatchUpdate(const ObservedSubjectHandle& subject, const UpdateReason updateReason, const LinkEventBatch::Handle& linkEvents) {
+    if (linkEvents && (UpdateReason::LinkStatusUpdate == updateReason)) {
+        updateLinkStatus(subject, linkEvents);
+        return;
+    }
 
-Observer::Observer(std::set<UpdateReason> supportedUpdateReasons)
-    : _supportedUpdateReasons { supportedUpdateReasons } {
+    update(subject, updateReason);
+}
+
+ObservedSubject::ObservedSubject()
+    : _subscribers {}, _epoch { 0 }, _activeNotifications {} {
     // Nothing more to do
 }
 
-const std::set<UpdateReason>& Observer::getSupportedUpdateReasons() const {
-    return _supportedUpdateReasons;
+ObservedSubject::~ObservedSubject() {
+    // Nobody can notify anymore, so all subscribers can be freed
+    for (auto& subscribers : _subscribers) {
+        delete subscribers.load(std::memory_order_relaxed);
+    }
 }
 
-Result::Value ObservedSubject::addObserver(Observer::Handle& observerToAdd) {
-    auto observerIt = std::find_if(std::begin(_observers), std::end(_observers), IsObserverEqualTo(observerToAdd));
-    if (std::end(_observers) == observerIt) {
-        _observers.emplace(observerToAdd);
+Result::Value ObservedSubject::addObserver(Observer::Handle& observerToAdd, std::shared_ptr<EventBus> eventBus) {
+    if (not observerToAdd) {
+        return Result::Value::Fail;
     }
 
+    std::lock_guard<std::mutex> lock { _subscriptionsMtx };
+    if (_subscriptions.count(observerToAdd->getObserverId()) != 0) {
+        return Result::Value::Success;
+    }
+
+    auto& subscription = *_subscriptions.emplace(observerToAdd->getObserverId(), std::make_unique<Subscription>(
+            Subscription { observerToAdd, std::move(eventBus), observerToAdd->getSupportedUpdateReasons(), {} })).first->second;
+    std::vector<Retired> retired {};
+    for (size_t updateReason = 0; updateReason < UpdateReasonsCount; ++updateReason) {
+        if (0 == (subscription.updateReasons & toUpdateReasonMask(static_cast<UpdateReason>(updateReason)))) {
+            continue;
+        }
+
+        auto* subscribers = _subscribers[updateReason].load(std::memory_order_relaxed);
+        if ((nullptr == subscribers) || (subscribers->size.load(std::memory_order_relaxed) == subscribers->slots.size())) {
+            compactSubscribers(updateReason, retired);
+            subscribers = _subscribers[updateReason].load(std::memory_order_relaxed);
+        }
+
+        // Slot is filled before it becomes visible to notification
+        const size_t subscriberIndex = subscribers->size.load(std::memory_order_relaxed);
+        subscription.subscriberIndexes[updateReason] = subscriberIndex;
+        subscribers->slots[subscriberIndex].store(&subscription, std::memory_order_release);
+        subscribers->size.store(subscriberIndex + 1, std::memory_order_release);
+    }
+
+    retire(retired);
     return Result::Value::Success;
 }
 
 void ObservedSubject::removeObserver(Observer::Handle& observerToRemove) {
-    auto observerIt = std::find_if(std::begin(_observers), std::end(_observers), IsObserverEqualTo(observerToRemove));
-    if (observerIt != std::end(_observers)) {
-        _observers.erase(observerIt);
+    if (not observerToRemove) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock { _subscriptionsMtx };
+    auto subscriptionIt = _subscriptions.find(observerToRemove->getObserverId());
+    if (std::end(_subscriptions) == subscriptionIt) {
+        return;
+    }
+
+    std::vector<Retired> retired {};
+    // Notification in progress can still use removed subscription
+    retired.push_back(Retired { nullptr, std::move(subscriptionIt->second), { false, false } });
+    _subscriptions.erase(subscriptionIt);
+    const auto& subscription = *retired.back().subscription;
+    for (size_t updateReason = 0; updateReason < UpdateReasonsCount; ++updateReason) {
+        if (0 == (subscription.updateReasons & toUpdateReasonMask(static_cast<UpdateReason>(updateReason)))) {
+            continue;
+        }
+
+        auto* subscribers = _subscribers[updateReason].load(std::memory_order_relaxed);
+        subscribers->slots[subscription.subscriberIndexes[updateReason]].store(nullptr, std::memory_order_release);
+        ++subscribers->removedCount;
+        if (subscribers->removedCount * 2 > subscribers->size.load(std::memory_order_relaxed)) {
+            compactSubscribers(updateReason, retired);
+        }
     }
+
+    retire(retired);
+}
+
+size_t ObservedSubject::getObserversCount() const {
+    std::lock_guard<std::mutex> lock { _subscriptionsMtx };
+    return _subscriptions.size();
 }
 
-void ObservedSubject::notifyAllObservers(const UpdateReason updateFromReason) const {
-    for (auto& observer : _observers) {
-        const auto& supportedUpdateReasons = observer->getSupportedUpdateReasons();
-        if (supportedUpdateReasons.find(updateFromReason) != std::end(supportedUpdateReasons)) {
-            observer->update(shared_from_this(), updateFromReason);
+void ObservedSubject::compactSubscribers(const size_t updateReason, std::vector<Retired>& retired) {
+    auto* subscribers = _subscribers[updateReason].load(std::memory_order_relaxed);
+    const size_t subscribersCount = subscribers ? subscribers->size.load(std::memory_order_relaxed) - subscribers->removedCount : 0;
+    auto compactedSubscribers = std::make_unique<Subscribers>(std::max(MinSubscribersCapacity, subscribersCount * 2));
+    size_t compactedSize = 0;
+    for (size_t subscriberIndex = 0; subscribers && (subscriberIndex < subscribers->size.load(std::memory_order_relaxed)); ++subscriberIndex) {
+        const Subscription* subscription = subscribers->slots[subscriberIndex].load(std::memory_order_relaxed);
+        if (subscription) {
+            // Only changes of subscriptions use subscriber indexes and they hold mutex
+            _subscriptions.at(subscription->observer->getObserverId())->subscriberIndexes[updateReason] = compactedSize;
+            compactedSubscribers->slots[compactedSize++].store(subscription, std::memory_order_relaxed);
         }
     }
+
+    compactedSubscribers->size.store(compactedSize, std::memory_order_relaxed);
+    auto* replacedSubscribers = _subscribers[updateReason].exchange(compactedSubscribers.release(), std::memory_order_seq_cst);
+    if (replacedSubscribers) {
+        retired.push_back(Retired { std::unique_ptr<Subscribers> { replacedSubscribers }, nullptr, { false, false } });
+    }
+}
+
+void ObservedSubject::retire(std::vector<Retired>& retired) {
+    if (not retired.empty()) {
+        // New notifications are counted in the other parity, so the current one can drain out
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::move(std::begin(retired), std::end(retired), std::back_inserter(_retired));
+    }
+
+    // Notification which can use retired object has started before retirement and it is counted in
+    // one of parities until it ends. It can't be known in which one, so both have to drain out.
+    for (size_t parity = 0; parity < _activeNotifications.size(); ++parity) {
+        if (0 == _activeNotifications[parity].load(std::memory_order_seq_cst)) {
+            for (auto& retiredObject : _retired) {
+                retiredObject.notificationsDrained[parity] = true;
+            }
+        }
+    }
+
+    _retired.erase(std::remove_if(std::begin(_retired), std::end(_retired), [](const Retired& retiredObject) {
+        return retiredObject.notificationsDrained[0] && retiredObject.notificationsDrained[1];
+    }), std::end(_retired));
+}
+
+void ObservedSubject::notifyAllObservers(const UpdateReason updateFromReason, const LinkEventBatch::Handle& linkEvents) const {
+    const auto updateReason = static_cast<size_t>(updateFromReason);
+    if (updateReason >= UpdateReasonsCount) {
+        return;
+    }
+
+    // Subscribers are used only while notification is counted as active
+    class ActiveNotification final {
+      public:
+        explicit ActiveNotification(std::atomic<size_t>& activeNotifications) : _activeNotifications { activeNotifications } {
+            _activeNotifications.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        ~ActiveNotification() { _activeNotifications.fetch_sub(1, std::memory_order_release); }
+
+      private:
+        std::atomic<size_t>& _activeNotifications;
+    };
+
+    const ActiveNotification activeNotification { _activeNotifications[_epoch.load(std::memory_order_seq_cst) & 1] };
+    const Subscribers* subscribers = _subscribers[updateReason].load(std::memory_order_seq_cst);
+    if (nullptr == subscribers) {
+        return;
+    }
+
+    const size_t subscribersSize = subscribers->size.load(std::memory_order_acquire);
+    if (0 == subscribersSize) {
+        return;
+    }
+
+    const auto meAsSubject = shared_from_this();
+    const bool tracingEnabled = LatencyTracer::getInstance().isEnabled();
+    for (size_t subscriberIndex = 0; subscriberIndex < subscribersSize; ++subscriberIndex) {
+        const Subscription* subscription = subscribers->slots[subscriberIndex].load(std::memory_order_acquire);
+        if (nullptr == subscription) {
+            continue;
+        }
+
+        if (subscription->eventBus) {
+            subscription->eventBus->publish(subscription->observer, meAsSubject, updateFromReason, linkEvents);
+            continue;
+        }
+
+        if (not tracingEnabled) {
+            subscription->observer->dispatchUpdate(meAsSubject, updateFromReason, linkEvents);
+            continue;
+        }
+
+        const auto updateStartedAt = LatencyTracer::now();
+        subscription->observer->dispatchUpdate(meAsSubject, updateFromReason, linkEvents);
+        LatencyTracer::getInstance().record(TraceStage::ObserverUpdate, LatencyTracer::now() - updateStartedAt);
+    }
 }
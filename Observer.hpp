@@ -14,17 +14,25 @@
 
 #pragma once
 
+#include "LinkEventBatch.hpp"
 #include "Types.hpp"
 
+#include <array>
+#include <atomic>
+#include <initializer_list>
 #include <map>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 using ObserverId = size_t;
 
+/// Identifies type of observer, see Observer::hash()
 enum class ObserverIdentifier : ObserverId {
     Port,
-    PortManager
+    PortManager,
+    VlanLinkStatusHandling
 };
 
 enum class UpdateReason {
@@ -34,36 +42,108 @@ enum class UpdateReason {
     PortUp,
     VlanCreate,
     VlanDestroy,
-    LinkStatusUpdate
+    LinkStatusUpdate,
+    Count
 };
 
+using UpdateReasonMask = uint32_t;
+static_assert(static_cast<size_t>(UpdateReason::Count) <= sizeof(UpdateReasonMask) * 8, "Update reasons don't fit in mask");
+
+constexpr UpdateReasonMask toUpdateReasonMask(const UpdateReason updateReason) {
+    return UpdateReasonMask { 1 } << static_cast<size_t>(updateReason);
+}
+
+class EventBus;
 class ObservedSubject;
 using ObservedSubjectHandle = std::shared_ptr<const ObservedSubject>;
 
 class Observer {
   public:
     using Handle = std::shared_ptr<Observer>;
-    Observer(std::set<UpdateReason> supportedUpdateReasons);
+    Observer(std::initializer_list<UpdateReason> supportedUpdateReasons);
     virtual ~Observer() = default;
+    /// @return identifier of observer type
     virtual ObserverId hash() = 0;
     virtual void update(const ObservedSubjectHandle& subject, const UpdateReason updateReason) = 0;
-    const std::set<UpdateReason>& getSupportedUpdateReasons() const;
+    /// Link status update comes with link events it notifies about, because subject can notify about
+    /// next ones before observer updated by EventBus gets them. By default update() is called.
+    virtual void updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& linkEvents);
+    /// Calls updateLinkStatus() if @p linkEvents are passed, otherwise update()
+    void dispatchUpdate(const ObservedSubjectHandle& subject, const UpdateReason updateReason, const LinkEventBatch::Handle& linkEvents);
+    /// @return identifier unique for each observer instance
+    ObserverId getObserverId() const { return _observerId; }
+    UpdateReasonMask getSupportedUpdateReasons() const { return _supportedUpdateReasons; }
+    bool isUpdateReasonSupported(const UpdateReason updateReason) const {
+        return (_supportedUpdateReasons & toUpdateReasonMask(updateReason)) != 0;
+    }
 
   protected:
-    std::set<UpdateReason> _supportedUpdateReasons;
+    UpdateReasonMask _supportedUpdateReasons;
+
+  private:
+    const ObserverId _observerId;
 };
 
+/// Observers are subscribed for each of their update reasons when they are added, so notification
+/// visits only observers interested in notified reason. Observer added with event bus is updated
+/// asynchronously by the bus, otherwise it is updated in context of thread which notifies.
+/// Observers can be added and removed from any thread, also during notification, which iterates
+/// subscribers without locks:
+///  - added subscriber is appended into free slot and then published by size of subscribers,
+///  - removed subscriber leaves empty slot behind,
+///  - when there is no free slot or half of slots are empty, subscribers are copied into new array
+///    (copy-on-write), so add and remove take amortized O(1).
+/// Replaced arrays and removed subscriptions are freed by later changes once no notification can
+/// use them (epoch based reclamation).
 class ObservedSubject : public std::enable_shared_from_this<ObservedSubject> {
   public:
-    virtual ~ObservedSubject() = default;
-    Result::Value addObserver(Observer::Handle& observerToAdd);
+    ObservedSubject();
+    virtual ~ObservedSubject();
+    /// Adding the same observer instance again does nothing
+    Result::Value addObserver(Observer::Handle& observerToAdd, std::shared_ptr<EventBus> eventBus = nullptr);
     void removeObserver(Observer::Handle& observerToRemove);
+    size_t getObserversCount() const;
 
   protected:
-    void notifyAllObservers(const UpdateReason updateFromReason) const;
+    /// @param linkEvents passed with UpdateReason::LinkStatusUpdate, see Observer::updateLinkStatus()
+    void notifyAllObservers(const UpdateReason updateFromReason, const LinkEventBatch::Handle& linkEvents = nullptr) const;
 
   private:
-    std::set<Observer::Handle> _observers;
+    static constexpr size_t UpdateReasonsCount = static_cast<size_t>(UpdateReason::Count);
+    static constexpr size_t MinSubscribersCapacity = 8;
+    struct Subscription {
+        Observer::Handle observer;
+        std::shared_ptr<EventBus> eventBus; // Null if observer is updated synchronously
+        UpdateReasonMask updateReasons;
+        std::array<size_t, UpdateReasonsCount> subscriberIndexes; // Slot in subscribers of each reason
+    };
+
+    struct Subscribers {
+        explicit Subscribers(const size_t capacity) : slots(capacity), size { 0 }, removedCount { 0 } {}
+        std::vector<std::atomic<const Subscription*>> slots; // Null if subscriber has been removed
+        std::atomic<size_t> size; // Slots visible to notification
+        size_t removedCount;
+    };
+
+    struct Retired {
+        std::unique_ptr<Subscribers> subscribers;
+        std::unique_ptr<const Subscription> subscription;
+        std::array<bool, 2> notificationsDrained; // Of each epoch parity since retirement
+    };
+
+    /// Copies subscribers of @p updateReason into new array with space for at least one more
+    void compactSubscribers(const size_t updateReason, std::vector<Retired>& retired);
+    /// Lets notifications, which could use @p retired, drain out and frees what is not used anymore
+    void retire(std::vector<Retired>& retired);
+
+    mutable std::mutex _subscriptionsMtx; // Serializes changes of subscriptions
+    std::unordered_map<ObserverId, std::unique_ptr<Subscription>> _subscriptions; // By observer instance
+    std::array<std::atomic<Subscribers*>, UpdateReasonsCount> _subscribers; // By update reason
+    std::vector<Retired> _retired;
+    // Notification is counted in parity of epoch in which it started, change of subscriptions moves
+    // epoch, so notifications which could use retired objects drain out
+    std::atomic<size_t> _epoch;
+    mutable std::array<std::atomic<size_t>, 2> _activeNotifications;
 };
 
 //class DependentUser {
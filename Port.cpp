@@ -13,11 +13,18 @@
 // limitations under the License.
 
 #include "Asic.hpp"
+#include "HwPortMapping.hpp"
 #include "Port.hpp"
 
 Port::Port(const PortId portNo)
-    : Observer { {UpdateReason::LinkStatusUpdate} }, _parameters { } {
+    : Observer { {UpdateReason::LinkStatusUpdate} }, _created { false }, _linkedUp { false }, _hasPendingParameters { false },
+      _parameters { }, _pendingParameters { } {
     _parameters.portNo = portNo;
+    const auto& portLayout = OpenNos::HwPortMapping::getInstance().getPortLayout(portNo);
+    _parameters.splitMode = portLayout.splitMode;
+    _parameters.laneNo = portLayout.laneNo;
+    _parameters.parentPort = portLayout.parentPort;
+    _parameters.slavePorts = portLayout.slavePorts;
 }
 
 Port::~Port() {
@@ -43,7 +50,7 @@ Result::Value Port::destroy() {
         return Result::Value::Success;
     }
 
-    _hwPortCommandFactory->getFdbFlushingCmd()->addPortToFlushing(_parameters.portNo).execute();
+    _hwPortCommandFactory->getFdbFlushingCmd()->addPortToFlushing(_parameters.portNo).commit();
     _created = false;
     return Result::Value::Success;
 }
@@ -53,19 +60,16 @@ bool Port::isShutdowned() const {
 }
 
 Result::Value Port::shutdown(const bool disable) {
-    if ((disable && _parameters.shutdowned)
-            || ((not disable) && (not _parameters.shutdowned))) {
+    auto parameters = getLatestParameters();
+    if ((disable && parameters.shutdowned)
+            || ((not disable) && (not parameters.shutdowned))) {
         return Result::Value::Success;
     }
 
-    auto parameters = _parameters;
     parameters.shutdowned = disable;
-    const auto result = _hwPortCommandFactory->getHwPortShutdownSettingCmd()->setPortParameters(parameters).execute();
-    if (not Result::Failed(result)) {
-        _parameters.shutdowned = disable;
-    }
-
-    return result;
+    auto& shutdownSetting = _hwPortCommandFactory->getHwPortShutdownSettingCmd();
+    shutdownSetting->setPortParameters(parameters);
+    return programHwPortAttributes(*shutdownSetting, parameters);
 }
 
 bool Port::isOperable() const {
@@ -81,19 +85,92 @@ PortSpeed Port::getSpeed() const {
 }
 
 Result::Value Port::setSpeed(const PortSpeed speed) {
-    auto parameters = _parameters;
+    auto parameters = getLatestParameters();
     parameters.speed = speed;
-    const auto result = _hwPortCommandFactory->getSpeedSettingCmd()->setPortParameters(parameters).execute();
+    auto& speedSetting = _hwPortCommandFactory->getSpeedSettingCmd();
+    speedSetting->setPortParameters(parameters);
+    return programHwPortAttributes(*speedSetting, parameters);
+}
+
+LinkScanMode Port::getLinkScanMode() const {
+    return _parameters.linkScanMode;
+}
+
+Result::Value Port::setLinkScanMode(const LinkScanMode linkScanMode) {
+    auto parameters = getLatestParameters();
+    parameters.linkScanMode = linkScanMode;
+    auto& linkScanModeSetting = _hwPortCommandFactory->getLinkScanModeSettingCmd();
+    linkScanModeSetting->setPortParameters(parameters);
+    return programHwPortAttributes(*linkScanModeSetting, parameters);
+}
+
+PortSplitMode Port::getSplitMode() const {
+    return _parameters.splitMode;
+}
+
+Result::Value Port::applyBreakout(const bool reinitialized) {
+    // Breakout has already programmed layout and speed, pending parameters follow it too
+    const auto& portLayout = OpenNos::HwPortMapping::getInstance().getPortLayout(_parameters.portNo);
+    for (auto parameters : { &_parameters, &_pendingParameters }) {
+        parameters->splitMode = portLayout.splitMode;
+        parameters->laneNo = portLayout.laneNo;
+        parameters->speed = HwPortBreakoutSetting::getSplitPortSpeed(portLayout.splitMode);
+    }
+
+    if (not reinitialized) {
+        return Result::Value::Success; // Speed has been already programmed by breakout
+    }
+
+    const auto parameters = getLatestParameters();
+    auto& parametersSetting = _hwPortCommandFactory->getParametersSettingCmd();
+    parametersSetting->setPortParameters(parameters);
+    const auto result = programHwPortAttributes(*parametersSetting, parameters);
+    if (Result::Failed(result)) {
+        return result;
+    }
+
+    auto& linkScanModeSetting = _hwPortCommandFactory->getLinkScanModeSettingCmd();
+    linkScanModeSetting->setPortParameters(parameters);
+    return programHwPortAttributes(*linkScanModeSetting, parameters);
+}
+
+void Port::applyPendingParameters(const bool programmed) {
+    if (programmed && _hasPendingParameters) {
+        _parameters = _pendingParameters;
+    }
+
+    _hasPendingParameters = false;
+}
+
+Result::Value Port::programHwPortAttributes(HwPortAttributesSetting& setting, const PortParameters& parameters) {
+    auto& attributesCoalescing = _hwPortCommandFactory->getAttributesCoalescingCmd();
+    if (attributesCoalescing->isCollecting()) {
+        const auto result = attributesCoalescing->addPortSetting(setting);
+        if (not Result::Failed(result)) {
+            _pendingParameters = parameters;
+            _hasPendingParameters = true;
+        }
+
+        return result;
+    }
+
+    const auto result = setting.execute();
     if (not Result::Failed(result)) {
-        _parameters.speed = speed;
+        _parameters = parameters;
     }
 
     return result;
 }
 
+const PortParameters& Port::getLatestParameters() const {
+    return _hasPendingParameters ? _pendingParameters : _parameters;
+}
+
 void Port::setLinkStatus(const bool linkedUp) {
     _linkedUp = linkedUp;
-    if (not linkedUp) {
-        _hwPortCommandFactory->getFdbFlushingCmd()->addPortToFlushing(_parameters.portNo).execute();
+    if (linkedUp) {
+        _hwPortCommandFactory->getFdbFlushingCmd()->setPortLinkedUp(_parameters.portNo);
+    } else {
+        _hwPortCommandFactory->getFdbFlushingCmd()->addPortToFlushing(_parameters.portNo);
     }
 }
@@ -45,10 +45,21 @@ class Port final : public Observer, public ObservedSubject {
     Result::Value shutdown(const bool disable);
     Result::Value setSpeed(const PortSpeed speed);
     PortSpeed getSpeed() const;
+    Result::Value setLinkScanMode(const LinkScanMode linkScanMode);
+    LinkScanMode getLinkScanMode() const;
+    PortSplitMode getSplitMode() const;
+    /// Takes over layout of lanes and speed after breakout of lane group of the port. Port which was
+    /// reinitialized by breakout is programmed back to its configuration.
+    Result::Value applyBreakout(const bool reinitialized);
+    /// Link down only collects port for FDB flushing, which is committed by caller together for all ports
     void setLinkStatus(const bool linkedUp);
     /// @retval false if link is down
     /// @retval true if link is up
     bool isOperable() const;
+    /// Settings merged into commit of port settings change parameters only once the commit has
+    /// programmed the port. Getters return programmed parameters until then.
+    /// @param programmed false drops pending parameters, e.g. if commit has failed or has been aborted
+    void applyPendingParameters(const bool programmed);
 
     Memento::Handle createMemento();
     Result::Value setMemento(Memento::Handle);
@@ -56,10 +67,17 @@ class Port final : public Observer, public ObservedSubject {
   private:
     friend struct PortCompare;
     friend struct MemberPortOwnerCompare;
+    /// Programs setting immediately or merges it into pending commit of port settings
+    /// @param parameters are applied once @p setting is programmed
+    Result::Value programHwPortAttributes(HwPortAttributesSetting& setting, const PortParameters& parameters);
+    /// Parameters with changes of pending commit, later settings of the same commit build on them
+    const PortParameters& getLatestParameters() const;
 
     bool _created;
     bool _linkedUp;
+    bool _hasPendingParameters;
     PortParameters _parameters;
+    PortParameters _pendingParameters;
     HwPortCommandFactory::Handle _hwPortCommandFactory;
 };
 
@@ -17,48 +17,74 @@
 #include "PortManager.hpp"
 #include "LoggingFacility.hpp"
 
+extern "C" {
+#include <opennsl/error.h>
+}
+
+#include <algorithm>
+
 PortManager::PortManager()
     : Observer({ UpdateReason::LinkStatusUpdate }),
       _hwPortCommandFactory { std::make_shared<HwPortCommandFactory>() },
-      _hwPortLinkScanHandling { std::make_shared<HwPortLinkScanHandling>() },
-      _hwPortModuleInitializing { std::make_shared<HwPortModuleInitializing>(_hwPortLinkScanHandling) } {
-    // Nothing more to do
+      _hwPortLinkScanHandlings {}, _bringUpPhaseTimings {} {
+    for (int hwUnit = 0; hwUnit < Asic::getHwUnitsCount(); ++hwUnit) {
+        _hwPortLinkScanHandlings.push_back(std::make_shared<HwPortLinkScanHandling>(hwUnit));
+    }
 }
 
 Result::Value PortManager::init() {
     std::shared_ptr<Observer> meAsObserver { shared_from_this() };
-    _hwPortLinkScanHandling->addObserver(meAsObserver);
-    return HwPortModuleInitializing(_hwPortLinkScanHandling).execute();
-}
+    for (auto& hwPortLinkScanHandling : _hwPortLinkScanHandlings) {
+        hwPortLinkScanHandling->addObserver(meAsObserver);
+        HwPortModuleInitializing hwPortModuleInitializing { hwPortLinkScanHandling };
+        const auto result = hwPortModuleInitializing.execute();
+        // Units are initialized one by one, so time of phase is summed over units
+        const auto& phaseTimings = hwPortModuleInitializing.getPhaseTimings();
+        for (size_t phase = 0; phase < phaseTimings.size(); ++phase) {
+            _bringUpPhaseTimings[phase].duration += phaseTimings[phase].duration;
+            _bringUpPhaseTimings[phase].ports += phaseTimings[phase].ports;
+            _bringUpPhaseTimings[phase].failedPorts += phaseTimings[phase].failedPorts;
+            _bringUpPhaseTimings[phase].groups = std::max(_bringUpPhaseTimings[phase].groups, phaseTimings[phase].groups);
+        }
 
-void PortManager::update(const ObservedSubjectHandle& subject, const UpdateReason updateReason) {
-    switch (updateReason) {
-      case UpdateReason::LinkStatusUpdate: {
-        const auto hwPortLinkScanHandler = std::dynamic_pointer_cast<HwPortLinkScanHandling const>(subject);
-        if (not hwPortLinkScanHandler) {
-            ERROR_LOG("Got link scan update from unknown source");
-            return;
+        if (Result::Failed(result)) {
+            return result;
         }
 
-        const auto& recentlyLinkStatusChangedOnPorts { hwPortLinkScanHandler->getRecentlyLinkStatusChangedOnPorts() };
-        for (const auto& portLinkStatus : recentlyLinkStatusChangedOnPorts) {
-            const PortId portNo = portLinkStatus.first;
-            const bool linkedUp = portLinkStatus.second;
-            _portsLinkStatus.insert_or_assign(portNo, linkedUp);
-            if (_configured.find(portNo) != std::end(_configured)) {
-                if (auto port = getHandle(portNo).lock()) { // Has to be copied into a shared_ptr before usage
-                    port->setLinkStatus(linkedUp);
-                }
-            }
+        const auto startResult = hwPortLinkScanHandling->start();
+        if (Result::Failed(startResult)) {
+            return startResult;
         }
+    }
 
-        break;
-      }
+    return Result::Value::Success;
+}
 
-      default: {
+void PortManager::update(const ObservedSubjectHandle& /* subject */, const UpdateReason updateReason) {
+    // Link status changes come with link events by updateLinkStatus()
+    if (UpdateReason::LinkStatusUpdate == updateReason) {
+        ERROR_LOG("Got link scan update without link events");
+    }
+}
+
+void PortManager::updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& linkEvents) {
+    if (not std::dynamic_pointer_cast<HwPortLinkScanHandling const>(subject)) {
+        ERROR_LOG("Got link scan update from unknown source");
         return;
-      }
     }
+
+    std::lock_guard<std::mutex> lock { _linkStatusUpdateMtx };
+    for (const auto& linkEvent : *linkEvents) {
+        const PortId portNo = linkEvent.portNo;
+        const bool linkedUp = linkEvent.linkedUp;
+        _portsLinkStatus.insert_or_assign(portNo, linkedUp);
+        if (auto port = get(getHandle(portNo))) {
+            port->setLinkStatus(linkedUp);
+        }
+    }
+
+    // All ports which went down are flushed in one pass
+    _hwPortCommandFactory->getFdbFlushingCmd()->commit();
 }
 
 ObserverId PortManager::hash() {
@@ -66,10 +92,14 @@ ObserverId PortManager::hash() {
 }
 
 Result::Value PortManager::execute(ResultCallback::Handle& callback) {
-    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(CommandManager::execute(callback), callback);
+    // Macro evaluates its argument twice, so manager must not be executed inside it
+    const auto result = CommandManager::execute(callback);
+    if (Result::Failed(result)) {
+        return result;
+    }
 
     for (const auto& portNo : _mementoAdded) {
-        if (auto portPtr = getHandle(portNo).lock()) {
+        if (auto portPtr = get(getHandle(portNo))) {
             portPtr->setHwPortCommandFactory(_hwPortCommandFactory);
         }
     }
@@ -77,6 +107,223 @@ Result::Value PortManager::execute(ResultCallback::Handle& callback) {
     CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
 }
 
+Result::Value PortManager::commitPortSettings(std::vector<UndoableCommand::Handle>& portSettings, ResultCallback::Handle& callback) {
+    const auto result = _hwCommandProcessor
+            ? _hwCommandProcessor->runAndWait([this, &portSettings] { return programPortSettings(portSettings); })
+            : programPortSettings(portSettings);
+    CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+}
+
+Result::Value PortManager::programPortSettings(std::vector<UndoableCommand::Handle>& portSettings) {
+    auto& attributesCoalescing = _hwPortCommandFactory->getAttributesCoalescingCmd();
+    const auto beginResult = attributesCoalescing->begin();
+    if (Result::Failed(beginResult)) {
+        return beginResult;
+    }
+
+    auto portSettingIt = std::begin(portSettings);
+    for (; portSettingIt != std::end(portSettings); ++portSettingIt) {
+        if (Result::Failed((*portSettingIt)->execute())) {
+            break;
+        }
+    }
+
+    Result::Value result = Result::Value::Fail;
+    if (portSettingIt == std::end(portSettings)) {
+        result = attributesCoalescing->execute();
+    } else {
+        attributesCoalescing->abort();
+    }
+
+    applyPendingPortParameters();
+    if (Result::Failed(result)) {
+        // Revert settings in reverse order directly in h/w, because coalescing is not active anymore
+        for (auto revertIt = std::make_reverse_iterator(portSettingIt); revertIt != std::rend(portSettings); ++revertIt) {
+            (*revertIt)->undo();
+        }
+    }
+
+    return result;
+}
+
+void PortManager::applyPendingPortParameters() {
+    for (const auto& portResult : _hwPortCommandFactory->getAttributesCoalescingCmd()->getPortResults()) {
+        const PortId portNo = HwPort::Mapping::hwPortToPanelPort(Asic::getDefaultHwUnit(), portResult.first);
+        if (auto port = get(getHandle(portNo))) {
+            port->applyPendingParameters(not Result::Failed(portResult.second));
+        }
+    }
+}
+
+HwPortAttributesCoalescing::Statistics PortManager::getPortAttributesCoalescingStatistics() const {
+    return _hwPortCommandFactory->getAttributesCoalescingCmd()->getStatistics();
+}
+
+Result::Value PortManager::addLinkStatusObserver(Observer::Handle& observer, std::shared_ptr<EventBus> eventBus) {
+    for (auto& hwPortLinkScanHandling : _hwPortLinkScanHandlings) {
+        const auto result = hwPortLinkScanHandling->addObserver(observer, eventBus);
+        if (Result::Failed(result)) {
+            return result;
+        }
+    }
+
+    return Result::Value::Success;
+}
+
+Result::Value PortManager::setLinkDampeningParameters(const HwPortLinkDampening::Parameters& parameters) {
+    for (auto& hwPortLinkScanHandling : _hwPortLinkScanHandlings) {
+        // Parameters are validated the same way on all units, so either all or none of them accept them
+        const auto result = hwPortLinkScanHandling->setLinkDampeningParameters(parameters);
+        if (Result::Failed(result)) {
+            return result;
+        }
+    }
+
+    return Result::Value::Success;
+}
+
+HwPortLinkDampening::Statistics PortManager::getLinkDampeningStatistics() const {
+    HwPortLinkDampening::Statistics statistics {};
+    for (const auto& hwPortLinkScanHandling : _hwPortLinkScanHandlings) {
+        const auto unitStatistics = hwPortLinkScanHandling->getLinkDampeningStatistics();
+        statistics.linkChanges += unitStatistics.linkChanges;
+        statistics.reportedChanges += unitStatistics.reportedChanges;
+        statistics.coalescedChanges += unitStatistics.coalescedChanges;
+        statistics.suppressedChanges += unitStatistics.suppressedChanges;
+        statistics.suppressions += unitStatistics.suppressions;
+        statistics.reuses += unitStatistics.reuses;
+    }
+
+    return statistics;
+}
+
+void PortManager::setHwCommandProcessor(HwCommandProcessor::Handle hwCommandProcessor) {
+    _hwCommandProcessor = hwCommandProcessor;
+    _hwPortCommandFactory->getFdbFlushingCmd()->setHwCommandProcessor(hwCommandProcessor);
+}
+
+void PortManager::setLagMemberPorts(const LagId lagId, const HwPortFdbFlushing::PortBitmap& memberPorts) {
+    _hwPortCommandFactory->getFdbFlushingCmd()->setTrunkMemberPorts(static_cast<opennsl_trunk_t>(lagId), memberPorts);
+}
+
+HwPortFdbFlushing::Statistics PortManager::getFdbFlushingStatistics() const {
+    return _hwPortCommandFactory->getFdbFlushingCmd()->getStatistics();
+}
+
+const HwPortBulkInitializing::PhaseTimings& PortManager::getBringUpPhaseTimings() const {
+    return _bringUpPhaseTimings;
+}
+
+Result::Value PortManager::setDefaultLinkScanMode(const LinkScanMode linkScanMode) {
+    _hwPortCommandFactory->getDefaultParametersSettingCmd()->setLinkScanMode(linkScanMode);
+    _hwPortCommandFactory->getBreakoutSettingCmd()->setLinkScanMode(linkScanMode);
+    return Result::Value::Success;
+}
+
+Result::Value PortManager::setLinkScanInterval(const std::chrono::microseconds interval) {
+    for (int hwUnit = 0; hwUnit < Asic::getHwUnitsCount(); ++hwUnit) {
+        const int rv = opennsl_linkscan_enable_set(hwUnit, static_cast<int>(interval.count()));
+        if (OPENNSL_FAILURE(rv)) {
+            VLOG_ERR("Failed to set linkscan interval on unit %d, err=%d (%s)", hwUnit, rv, opennsl_errmsg(rv));
+            return Result::Value::Fail;
+        }
+    }
+
+    return Result::Value::Success;
+}
+
+Result::Value PortManager::changePortBreakout(const PortId parentPort, const PortSplitMode splitMode) {
+    if (_hwCommandProcessor) {
+        return _hwCommandProcessor->runAndWait([this, parentPort, splitMode] { return breakOutPort(parentPort, splitMode); });
+    }
+
+    return breakOutPort(parentPort, splitMode);
+}
+
+Result::Value PortManager::breakOutPort(const PortId parentPort, const PortSplitMode splitMode) {
+    auto& breakoutSetting = _hwPortCommandFactory->getBreakoutSettingCmd();
+    PortParameters parameters {};
+    parameters.portNo = parentPort;
+    parameters.splitMode = splitMode;
+    breakoutSetting->setPortParameters(parameters);
+    const auto result = breakoutSetting->execute();
+    if (Result::Failed(result)) {
+        return result;
+    }
+
+    // Lane actions are applied to all ports of lane group, even if some of them fails
+    Result::Value portsResult = Result::Value::Success;
+    const auto& laneActions = breakoutSetting->getLaneActions();
+    const auto& slavePorts = OpenNos::HwPortMapping::getInstance().getPortLayout(parentPort).slavePorts;
+    auto& fdbFlushing = _hwPortCommandFactory->getFdbFlushingCmd();
+    // Settings of reinitialized ports join commit of port settings if breakout is part of it
+    auto& attributesCoalescing = _hwPortCommandFactory->getAttributesCoalescingCmd();
+    // If commit can't be begun, reinitialized ports are programmed directly
+    const bool ownCommit = (not attributesCoalescing->isCollecting()) && (not Result::Failed(attributesCoalescing->begin()));
+
+    for (size_t lane = 0; lane < laneActions.size(); ++lane) {
+        const PortId portNo = slavePorts[lane];
+        switch (laneActions[lane]) {
+          case HwPortBreakoutSetting::LaneAction::Delete:
+            fdbFlushing->addPortToFlushing(portNo);
+            destroyBreakoutPort(portNo);
+            break;
+
+          case HwPortBreakoutSetting::LaneAction::Create:
+            createBreakoutPort(portNo);
+            break;
+
+          case HwPortBreakoutSetting::LaneAction::Reinit:
+          case HwPortBreakoutSetting::LaneAction::SpeedSet:
+            if (auto port = get(getHandle(portNo))) {
+                const auto portResult = port->applyBreakout(HwPortBreakoutSetting::LaneAction::Reinit == laneActions[lane]);
+                portsResult = Result::Failed(portsResult) ? portsResult : portResult;
+            }
+
+            break;
+
+          default:
+            break; // Sibling port keeping its lanes and speed is left untouched
+        }
+    }
+
+    Result::Value attributesResult = Result::Value::Success;
+    if (ownCommit) {
+        attributesResult = attributesCoalescing->execute();
+        applyPendingPortParameters();
+    }
+
+    fdbFlushing->commit();
+    return Result::Failed(portsResult) ? portsResult : attributesResult;
+}
+
+void PortManager::createBreakoutPort(const PortId portNo) {
+    _toAdding.erase(portNo);
+    _toRemoving.erase(portNo);
+    if (_configured.count(portNo) != 0) {
+        return;
+    }
+
+    auto port = createObject(portNo);
+    port->setHwPortCommandFactory(_hwPortCommandFactory);
+    // Lanes and speed of port have been already programmed by breakout
+    port->applyBreakout(false);
+    _objects.emplace(portNo, port);
+    _configured.emplace(portNo);
+}
+
+void PortManager::destroyBreakoutPort(const PortId portNo) {
+    {
+        std::lock_guard<std::mutex> lock { _linkStatusUpdateMtx };
+        _portsLinkStatus.erase(portNo);
+    }
+
+    _toAdding.erase(portNo);
+    _toRemoving.erase(portNo);
+    _objects.erase(portNo);
+    _configured.erase(portNo);
+}
+
 PortSettingExecutor::PortSettingExecutor(PortManager::Handle& portManager, const PortId portNo)
     : _portManager { portManager }, _portNo { portNo }, _executed { false } {
     PortSettingMemento::Handle nullPortSettingMemento = std::make_shared<NullPortSettingMemento>();
@@ -86,11 +333,7 @@ PortSettingExecutor::PortSettingExecutor(PortManager::Handle& portManager, const
 }
 
 Result::Value PortSettingExecutor::execute(ResultCallback::Handle& callback) {
-    if (not _portManager->exists(_portNo)) {
-        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(Result::Value::PortNotExists, callback);
-    }
-
-    if (auto portPtr = _portManager->getHandle(_portNo).lock()) {
+    if (auto portPtr = _portManager->get(_portManager->getHandle(_portNo))) {
         createMemento(*portPtr);
         CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(_portSettingProcessing->processCommand(*portPtr), callback);
         _executed = true;
@@ -105,11 +348,7 @@ Result::Value PortSettingExecutor::undo(ResultCallback::Handle& callback) {
         CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(Result::Value::CommandNotUndoable, callback);
     }
 
-    if (not _portManager->exists(_portNo)) {
-        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(Result::Value::PortNotExists, callback);
-    }
-
-    if (auto portPtr = _portManager->getHandle(_portNo).lock()) {
+    if (auto portPtr = _portManager->get(_portManager->getHandle(_portNo))) {
         CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL(setMemento(*portPtr), callback);
         _executed = false;
         CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
@@ -166,3 +405,21 @@ PortSpeedSetting::PortSpeedSetting(PortManager::Handle& portManager, const PortI
 size_t PortSpeedSetting::getCommitOrderingResolve() const {
     return CommitOrderingResolve::PortSet;
 }
+
+PortBreakoutSetting::PortBreakoutSetting(PortManager::Handle& portManager, const PortId portNo, const PortSplitMode splitMode)
+    : PortCommandImplement{ portManager, portNo }, _splitMode { splitMode }, _splitModeMemento { PortSplitMode::None } {
+    PORT_SETTING_MEMENTO_AND_PROCESSING_INIT();
+}
+
+size_t PortBreakoutSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::PortSettingToEnabledBreakoutMode;
+}
+
+PortLinkScanModeSetting::PortLinkScanModeSetting(PortManager::Handle& portManager, const PortId portNo, const LinkScanMode linkScanMode)
+    : PortCommandImplement{ portManager, portNo }, _linkScanMode { linkScanMode }, _linkScanModeMemento { LinkScanMode::Software } {
+    PORT_SETTING_MEMENTO_AND_PROCESSING_INIT();
+}
+
+size_t PortLinkScanModeSetting::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::PortSet;
+}
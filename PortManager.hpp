@@ -20,7 +20,11 @@
 #include "Port.hpp"
 #include "Types.hpp"
 
-class PortManager final : public CommandManager<Port, PortId, PortHandle>, public Observer,
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+class PortManager final : public CommandManager<Port, PortId, DenseCommandStorage<MaxPorts>>, public Observer,
                           public std::enable_shared_from_this<PortManager> {
   public:
     using Handle = std::shared_ptr<PortManager>;
@@ -28,13 +32,54 @@ class PortManager final : public CommandManager<Port, PortId, PortHandle>, publi
     virtual ~PortManager() override = default;
     Result::Value init();
     virtual void update(const ObservedSubjectHandle& subject, const UpdateReason updateReason) override;
+    virtual void updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& linkEvents) override;
     virtual ObserverId hash() override;
     virtual Result::Value execute(ResultCallback::Handle& callback) override;
+    /// Executes port settings which belong to one commit. Attribute changes of the same port
+    /// are merged, so each port is programmed by one SDK call. If any setting fails,
+    /// all of them are reverted. Commit is done in ASIC thread if h/w command processor is set.
+    Result::Value commitPortSettings(std::vector<UndoableCommand::Handle>& portSettings,
+                                     ResultCallback::Handle& callback = gNullResultCallback);
+    HwPortAttributesCoalescing::Statistics getPortAttributesCoalescingStatistics() const;
+    /// Registers observer which will be notified about link status changes of ports of all units.
+    /// Observer is updated concurrently by pipelines of different units, or by workers of @p eventBus
+    /// if passed, so slow observer doesn't delay notification of link changes.
+    Result::Value addLinkStatusObserver(Observer::Handle& observer, std::shared_ptr<EventBus> eventBus = nullptr);
+    /// Flapping ports are held down by dampening before their link changes reach observers
+    Result::Value setLinkDampeningParameters(const HwPortLinkDampening::Parameters& parameters);
+    HwPortLinkDampening::Statistics getLinkDampeningStatistics() const;
+    /// FDB of ports which went down is flushed in ASIC thread of @p hwCommandProcessor
+    void setHwCommandProcessor(HwCommandProcessor::Handle hwCommandProcessor);
+    /// MACs of LAG member ports are flushed by LAG, not by member port
+    void setLagMemberPorts(const LagId lagId, const HwPortFdbFlushing::PortBitmap& memberPorts);
+    HwPortFdbFlushing::Statistics getFdbFlushingStatistics() const;
+    /// @return time spent in phases of port module initialization by init()
+    const HwPortBulkInitializing::PhaseTimings& getBringUpPhaseTimings() const;
+    /// Linkscan mode which ports are initialized with, mode of port is changed by PortLinkScanModeSetting
+    Result::Value setDefaultLinkScanMode(const LinkScanMode linkScanMode);
+    /// Sets interval of polling PHYs of ports in software linkscan mode on all units. Zero stops linkscan.
+    Result::Value setLinkScanInterval(const std::chrono::microseconds interval);
+    /// Changes split mode of @p parentPort by reprogramming only its lane group in ASIC thread, sibling
+    /// ports keeping their lanes keep their configuration. Ports which appear or disappear are created
+    /// or destroyed right away, pending add or remove of them is dropped.
+    Result::Value changePortBreakout(const PortId parentPort, const PortSplitMode splitMode);
 
   private:
+    /// Port attributes are coalesced, which has to be done in ASIC thread (see HwPortAttributesCoalescing)
+    Result::Value programPortSettings(std::vector<UndoableCommand::Handle>& portSettings);
+    Result::Value breakOutPort(const PortId parentPort, const PortSplitMode splitMode);
+    /// Applies parameters of ports which last commit of port attributes has programmed
+    void applyPendingPortParameters();
+    void createBreakoutPort(const PortId portNo);
+    void destroyBreakoutPort(const PortId portNo);
+
     HwPortCommandFactory::Handle _hwPortCommandFactory;
-    HwPortLinkScanHandling::Handle _hwPortLinkScanHandling;
-    HwPortModuleInitializing::Handle _hwPortModuleInitializing;
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    /// Link changes of each unit are handled by its own pipeline, indexed by unit
+    std::vector<HwPortLinkScanHandling::Handle> _hwPortLinkScanHandlings;
+    /// Link status updates come concurrently from pipelines of all units
+    std::mutex _linkStatusUpdateMtx;
+    HwPortBulkInitializing::PhaseTimings _bringUpPhaseTimings;
     /// Let's backup ports link status to have known of port link status in case when
     /// port will be created in future
     std::map<PortId, bool> _portsLinkStatus;
@@ -124,3 +169,32 @@ class PortSpeedSetting final : public PortCommandImplement,
     PortSpeed _speed;
     PortSpeed _speedMemento;
 };
+
+/// Breakout of lane group which @p portNo is parent of
+class PortBreakoutSetting final : public PortCommandImplement,
+                                  public std::enable_shared_from_this<PortBreakoutSetting> {
+  public:
+    PortBreakoutSetting(PortManager::Handle& portManager, const PortId portNo, const PortSplitMode splitMode);
+    virtual size_t getCommitOrderingResolve() const override;
+
+  private:
+    virtual void createMemento(Port& port) override { _splitModeMemento = port.getSplitMode(); }
+    virtual Result::Value setMemento(Port& /* port */) override { return _portManager->changePortBreakout(_portNo, _splitModeMemento); }
+    virtual Result::Value processCommand(Port& /* port */) override { return _portManager->changePortBreakout(_portNo, _splitMode); }
+    PortSplitMode _splitMode;
+    PortSplitMode _splitModeMemento;
+};
+
+class PortLinkScanModeSetting final : public PortCommandImplement,
+                                      public std::enable_shared_from_this<PortLinkScanModeSetting> {
+  public:
+    PortLinkScanModeSetting(PortManager::Handle& portManager, const PortId portNo, const LinkScanMode linkScanMode);
+    virtual size_t getCommitOrderingResolve() const override;
+
+  private:
+    virtual void createMemento(Port& port) override { _linkScanModeMemento = port.getLinkScanMode(); }
+    virtual Result::Value setMemento(Port& port) override { return port.setLinkScanMode(_linkScanModeMemento); }
+    virtual Result::Value processCommand(Port& port) override { return port.setLinkScanMode(_linkScanMode); }
+    LinkScanMode _linkScanMode;
+    LinkScanMode _linkScanModeMemento;
+};
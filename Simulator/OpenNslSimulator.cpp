@@ -0,0 +1,708 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OpenNslSimulator.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#   include <opennsl/error.h>
+#   include <opennsl/l2.h>
+#   include <opennsl/stg.h>
+#   include <opennsl/vlan.h>
+#   include <sal/driver.h>
+}
+
+using namespace OpenNos;
+
+OpenNslSimulator& OpenNslSimulator::getInstance() {
+    static OpenNslSimulator simulator {};
+    return simulator;
+}
+
+namespace {
+
+constexpr std::chrono::microseconds DefaultLinkInterruptLatency { 20 };
+
+} // namespace
+
+OpenNslSimulator::OpenNslSimulator()
+    : _linkScanStopping { false }, _linkInterruptLatency { DefaultLinkInterruptLatency }, _vlanPortAddRetagging { true },
+      _invokedLinkScanHandlers { 0 } {
+    reset();
+}
+
+OpenNslSimulator::~OpenNslSimulator() {
+    waitForLinkScanScript();
+    stopLinkScan();
+}
+
+void OpenNslSimulator::reset() {
+    waitForLinkScanScript();
+    stopLinkScan();
+    for (auto& callSetting : _callSettings) {
+        callSetting.latencyNs = 0;
+        callSetting.failEveryNth = 0;
+        callSetting.errorCode = OPENNSL_E_FAIL;
+        callSetting.callsCount = 0;
+    }
+
+    _vlanPortAddRetagging = true;
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    _linkInterruptLatency = DefaultLinkInterruptLatency;
+    for (auto& unitState : _units) {
+        resetUnit(unitState, DefaultEthernetPortsCount);
+    }
+}
+
+void OpenNslSimulator::resetUnit(UnitState& unitState, const int portsCount) {
+    // Port 0 is CPU port and all ports have to fit in port bitmaps
+    unitState.ethernetPortsCount = std::max(0, std::min(portsCount, OPENNSL_PBMP_PORT_MAX - 1));
+    unitState.ports.assign(static_cast<size_t>(unitState.ethernetPortsCount + 1), PortState {});
+    for (auto& port : unitState.ports) {
+        std::memset(&port.info, 0, sizeof(port.info));
+        std::memset(&port.localAbility, 0, sizeof(port.localAbility));
+        port.localAbility.speed_full_duplex = OPENNSL_PORT_ABILITY_10GB | OPENNSL_PORT_ABILITY_25GB
+                | OPENNSL_PORT_ABILITY_40GB | OPENNSL_PORT_ABILITY_50GB | OPENNSL_PORT_ABILITY_100GB;
+        port.localAbility.pause = OPENNSL_PORT_ABILITY_PAUSE;
+        port.advertAbility = port.localAbility;
+        port.info.linkscan = OPENNSL_LINKSCAN_MODE_NONE;
+        port.stpState = OPENNSL_STG_STP_FORWARD;
+        port.untaggedVlan = OPENNSL_VLAN_DEFAULT;
+        port.linkUp = false;
+        port.physicalLinkUp = false;
+    }
+
+    unitState.vlans.clear();
+    unitState.stgs.clear();
+    unitState.linkScanHandlers.clear();
+    unitState.linkScanIntervalUs = 0;
+    unitState.nextLinkScanAt = {};
+    unitState.linkInterruptPending = false;
+    unitState.linkInterruptAt = {};
+}
+
+void OpenNslSimulator::setEthernetPortsCount(const int unit, const int portsCount) {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    if ((unit >= 0) && (unit < MaxUnits)) {
+        resetUnit(_units[static_cast<size_t>(unit)], portsCount);
+    }
+}
+
+void OpenNslSimulator::setCallLatency(const SdkCall call, const std::chrono::nanoseconds latency) {
+    _callSettings[static_cast<size_t>(call)].latencyNs = latency.count();
+}
+
+void OpenNslSimulator::setCallFailure(const SdkCall call, const uint64_t failEveryNth, const int errorCode) {
+    auto& callSetting = _callSettings[static_cast<size_t>(call)];
+    callSetting.errorCode = errorCode;
+    callSetting.failEveryNth = failEveryNth;
+}
+
+uint64_t OpenNslSimulator::getCallsCount(const SdkCall call) const {
+    return _callSettings[static_cast<size_t>(call)].callsCount;
+}
+
+uint64_t OpenNslSimulator::getTotalCallsCount() const {
+    uint64_t callsCount = 0;
+    for (const auto& callSetting : _callSettings) {
+        callsCount += callSetting.callsCount;
+    }
+
+    return callsCount;
+}
+
+int OpenNslSimulator::enterCall(const SdkCall call) {
+    auto& callSetting = _callSettings[static_cast<size_t>(call)];
+    const uint64_t callNo = ++callSetting.callsCount;
+    const auto latency = std::chrono::nanoseconds { callSetting.latencyNs.load() };
+    if (latency.count() > 0) {
+        // Sleeping is too coarse for microsecond latencies of register access, so spin
+        const auto deadline = std::chrono::steady_clock::now() + latency;
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    const uint64_t failEveryNth = callSetting.failEveryNth;
+    if ((failEveryNth > 0) && (0 == (callNo % failEveryNth))) {
+        return callSetting.errorCode;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+OpenNslSimulator::UnitState* OpenNslSimulator::getUnit(const int unit) {
+    if ((unit < 0) || (unit >= MaxUnits)) {
+        return nullptr;
+    }
+
+    return &_units[static_cast<size_t>(unit)];
+}
+
+OpenNslSimulator::PortState* OpenNslSimulator::getPort(const int unit, const opennsl_port_t port) {
+    auto unitState = getUnit(unit);
+    if ((nullptr == unitState) || (port < 0) || (static_cast<size_t>(port) >= unitState->ports.size())) {
+        return nullptr;
+    }
+
+    return &unitState->ports[static_cast<size_t>(port)];
+}
+
+void OpenNslSimulator::injectLinkEvent(const int unit, const opennsl_port_t port, const bool linkUp) {
+    std::unique_lock<std::mutex> stateLock { _stateMtx };
+    auto portState = getPort(unit, port);
+    if (nullptr == portState) {
+        return;
+    }
+
+    portState->linkUp = linkUp;
+    portState->physicalLinkUp = linkUp;
+    portState->info.linkstatus = linkUp ? OPENNSL_PORT_LINK_STATUS_UP : OPENNSL_PORT_LINK_STATUS_DOWN;
+    invokeLinkScanHandlers(unit, { { port, portState->info } }, stateLock);
+}
+
+void OpenNslSimulator::setPhysicalLinkStatus(const int unit, const opennsl_port_t port, const bool linkUp) {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    auto portState = getPort(unit, port);
+    if (nullptr == portState) {
+        return;
+    }
+
+    portState->physicalLinkUp = linkUp;
+    auto unitState = getUnit(unit);
+    if ((OPENNSL_LINKSCAN_MODE_HW == portState->info.linkscan) && (not unitState->linkInterruptPending)) {
+        unitState->linkInterruptPending = true;
+        unitState->linkInterruptAt = std::chrono::steady_clock::now() + _linkInterruptLatency;
+        if (unitState->linkScanIntervalUs > 0) {
+            wakeUpLinkScan();
+        }
+    }
+}
+
+void OpenNslSimulator::setLinkInterruptLatency(const std::chrono::microseconds latency) {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    _linkInterruptLatency = latency;
+}
+
+void OpenNslSimulator::wakeUpLinkScan() {
+    if (not _linkScanThread.joinable()) {
+        _linkScanThread = std::thread { &OpenNslSimulator::runLinkScan, this };
+    }
+
+    _linkScanCv.notify_all();
+}
+
+void OpenNslSimulator::waitForLinkScanHandlers() {
+    _linkScanHandlersReturned.wait(_stateMtx, [this] { return 0 == _invokedLinkScanHandlers; });
+}
+
+void OpenNslSimulator::stopLinkScan() {
+    if (not _linkScanThread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { _stateMtx };
+        _linkScanStopping = true;
+    }
+
+    _linkScanCv.notify_all();
+    _linkScanThread.join();
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    _linkScanStopping = false;
+}
+
+void OpenNslSimulator::runLinkScan() {
+    std::unique_lock<std::mutex> stateLock { _stateMtx };
+    while (not _linkScanStopping) {
+        auto wakeUpAt = std::chrono::steady_clock::time_point::max();
+        for (int unit = 0; unit < MaxUnits; ++unit) {
+            auto& unitState = _units[static_cast<size_t>(unit)];
+            if (unitState.linkScanIntervalUs <= 0) {
+                continue;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (unitState.linkInterruptPending && (unitState.linkInterruptAt <= now)) {
+                unitState.linkInterruptPending = false;
+                scanLinks(unit, OPENNSL_LINKSCAN_MODE_HW, stateLock);
+            }
+
+            if (unitState.nextLinkScanAt <= now) {
+                unitState.nextLinkScanAt = now + std::chrono::microseconds { unitState.linkScanIntervalUs };
+                scanLinks(unit, OPENNSL_LINKSCAN_MODE_SW, stateLock);
+            }
+
+            wakeUpAt = std::min(wakeUpAt, unitState.nextLinkScanAt);
+            if (unitState.linkInterruptPending) {
+                wakeUpAt = std::min(wakeUpAt, unitState.linkInterruptAt);
+            }
+        }
+
+        if (std::chrono::steady_clock::time_point::max() == wakeUpAt) {
+            _linkScanCv.wait(stateLock);
+        } else {
+            _linkScanCv.wait_until(stateLock, wakeUpAt);
+        }
+    }
+}
+
+void OpenNslSimulator::scanLinks(const int unit, const int linkScanMode, std::unique_lock<std::mutex>& stateLock) {
+    auto& unitState = _units[static_cast<size_t>(unit)];
+    std::vector<std::pair<opennsl_port_t, opennsl_port_info_t>> changedPorts {};
+    for (size_t port = 0; port < unitState.ports.size(); ++port) {
+        auto& portState = unitState.ports[port];
+        if ((linkScanMode != portState.info.linkscan) || (portState.physicalLinkUp == portState.linkUp)) {
+            continue;
+        }
+
+        portState.linkUp = portState.physicalLinkUp;
+        portState.info.linkstatus = portState.linkUp ? OPENNSL_PORT_LINK_STATUS_UP : OPENNSL_PORT_LINK_STATUS_DOWN;
+        changedPorts.emplace_back(static_cast<opennsl_port_t>(port), portState.info);
+    }
+
+    if (not changedPorts.empty()) {
+        invokeLinkScanHandlers(unit, changedPorts, stateLock);
+    }
+}
+
+void OpenNslSimulator::invokeLinkScanHandlers(const int unit, const std::vector<std::pair<opennsl_port_t, opennsl_port_info_t>>& changedPorts,
+                                              std::unique_lock<std::mutex>& stateLock) {
+    // Like SDK, handlers are called without holding any internal lock, so they can call SDK. Unregistering
+    // of handler waits until calls counted here return.
+    const auto linkScanHandlers = _units[static_cast<size_t>(unit)].linkScanHandlers;
+    if (linkScanHandlers.empty()) {
+        return;
+    }
+
+    ++_invokedLinkScanHandlers;
+    stateLock.unlock();
+    for (auto changedPort : changedPorts) {
+        for (auto linkScanHandler : linkScanHandlers) {
+            linkScanHandler(unit, changedPort.first, &changedPort.second);
+        }
+    }
+
+    stateLock.lock();
+    if (0 == --_invokedLinkScanHandlers) {
+        _linkScanHandlersReturned.notify_all();
+    }
+}
+
+void OpenNslSimulator::runLinkScanScript(std::vector<LinkScanEvent> script) {
+    waitForLinkScanScript();
+    _linkScanScriptThread = std::thread { [this, script = std::move(script)] {
+        for (const auto& event : script) {
+            if (event.delay.count() > 0) {
+                std::this_thread::sleep_for(event.delay);
+            }
+
+            injectLinkEvent(event.unit, event.port, event.linkUp);
+        }
+    } };
+}
+
+void OpenNslSimulator::waitForLinkScanScript() {
+    if (_linkScanScriptThread.joinable()) {
+        _linkScanScriptThread.join();
+    }
+}
+
+bool OpenNslSimulator::isLinkUp(const int unit, const opennsl_port_t port) const {
+    std::lock_guard<std::mutex> lock { _stateMtx };
+    auto portState = const_cast<OpenNslSimulator*>(this)->getPort(unit, port);
+    return (nullptr != portState) && portState->linkUp;
+}
+
+#define SIMULATOR_ENTER_CALL(CALL)                                          \
+    auto& simulator = OpenNslSimulator::getInstance();                      \
+    do {                                                                    \
+        const int injectedRc = simulator.enterCall(SdkCall::CALL);          \
+        if (OPENNSL_FAILURE(injectedRc)) {                                  \
+            return injectedRc;                                              \
+        }                                                                   \
+    } while (0);                                                            \
+    std::lock_guard<std::mutex> simulatorStateLock { simulator.getStateMutex() }
+
+#define SIMULATOR_GET_PORT_OR_RETURN(PORT_STATE, UNIT, PORT)                \
+    auto PORT_STATE = simulator.getPort(UNIT, PORT);                        \
+    if (nullptr == PORT_STATE) {                                            \
+        return OPENNSL_E_PORT;                                              \
+    }
+
+#define SIMULATOR_GET_UNIT_OR_RETURN(UNIT_STATE, UNIT)                      \
+    auto UNIT_STATE = simulator.getUnit(UNIT);                              \
+    if (nullptr == UNIT_STATE) {                                            \
+        return OPENNSL_E_UNIT;                                              \
+    }
+
+extern "C" {
+
+int opennsl_driver_init(opennsl_init_t* /* init */) {
+    SIMULATOR_ENTER_CALL(DriverInit);
+    return OPENNSL_E_NONE;
+}
+
+void opennsl_port_info_t_init(opennsl_port_info_t* info) {
+    std::memset(info, 0, sizeof(*info));
+}
+
+void opennsl_port_ability_t_init(opennsl_port_ability_t* ability) {
+    std::memset(ability, 0, sizeof(*ability));
+}
+
+void opennsl_port_config_t_init(opennsl_port_config_t* config) {
+    std::memset(config, 0, sizeof(*config));
+}
+
+int opennsl_port_config_get(int unit, opennsl_port_config_t* config) {
+    SIMULATOR_ENTER_CALL(PortConfigGet);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    opennsl_port_config_t_init(config);
+    OPENNSL_PBMP_PORT_ADD(config->cpu, 0);
+    OPENNSL_PBMP_PORT_ADD(config->all, 0);
+    for (opennsl_port_t port = 1; port <= unitState->ethernetPortsCount; ++port) {
+        OPENNSL_PBMP_PORT_ADD(config->e, port);
+        OPENNSL_PBMP_PORT_ADD(config->port, port);
+        OPENNSL_PBMP_PORT_ADD(config->all, port);
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_selective_set(int unit, opennsl_port_t port, opennsl_port_info_t* info) {
+    SIMULATOR_ENTER_CALL(PortSelectiveSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    auto& current = portState->info;
+    if (info->action_mask & OPENNSL_PORT_ATTR_ENABLE_MASK) {
+        current.enable = info->enable;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_AUTONEG_MASK) {
+        current.autoneg = info->autoneg;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_SPEED_MASK) {
+        current.speed = info->speed;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_DUPLEX_MASK) {
+        current.duplex = info->duplex;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_LINKSCAN_MASK) {
+        current.linkscan = info->linkscan;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_PAUSE_RX_MASK) {
+        current.pause_rx = info->pause_rx;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_PAUSE_TX_MASK) {
+        current.pause_tx = info->pause_tx;
+    }
+
+    if (info->action_mask & OPENNSL_PORT_ATTR_LOCAL_ADVERT_MASK) {
+        portState->advertAbility = info->local_ability;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_ability_local_get(int unit, opennsl_port_t port, opennsl_port_ability_t* local_ability_mask) {
+    SIMULATOR_ENTER_CALL(PortAbilityLocalGet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    *local_ability_mask = portState->localAbility;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_ability_advert_get(int unit, opennsl_port_t port, opennsl_port_ability_t* ability_mask) {
+    SIMULATOR_ENTER_CALL(PortAbilityAdvertGet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    *ability_mask = portState->advertAbility;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_link_status_get(int unit, opennsl_port_t port, int* status) {
+    SIMULATOR_ENTER_CALL(PortLinkStatusGet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    *status = portState->linkUp ? OPENNSL_PORT_LINK_STATUS_UP : OPENNSL_PORT_LINK_STATUS_DOWN;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_stp_set(int unit, opennsl_port_t port, int stp_state) {
+    SIMULATOR_ENTER_CALL(PortStpSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    portState->stpState = stp_state;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_vlan_member_set(int unit, opennsl_port_t port, uint32 /* flags */) {
+    SIMULATOR_ENTER_CALL(PortVlanMemberSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_control_set(int unit, opennsl_port_t port, opennsl_port_control_t /* type */, int /* value */) {
+    SIMULATOR_ENTER_CALL(PortControlSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_port_untagged_vlan_set(int unit, opennsl_port_t port, opennsl_vlan_t vid) {
+    SIMULATOR_ENTER_CALL(PortUntaggedVlanSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    portState->untaggedVlan = vid;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_stat_clear(int unit, opennsl_port_t port) {
+    SIMULATOR_ENTER_CALL(StatClear);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_l2_addr_delete_by_port(int unit, opennsl_module_t /* mod */, opennsl_port_t port, uint32 /* flags */) {
+    SIMULATOR_ENTER_CALL(L2AddrDeleteByPort);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_l2_addr_delete_by_trunk(int unit, opennsl_trunk_t /* tid */, uint32 /* flags */) {
+    SIMULATOR_ENTER_CALL(L2AddrDeleteByTrunk);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_vlan_create(int unit, opennsl_vlan_t vid) {
+    SIMULATOR_ENTER_CALL(VlanCreate);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    OpenNslSimulator::VlanState vlanState {};
+    OPENNSL_PBMP_CLEAR(vlanState.members);
+    OPENNSL_PBMP_CLEAR(vlanState.untagged);
+    if (not unitState->vlans.emplace(vid, vlanState).second) {
+        return OPENNSL_E_EXISTS;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_vlan_destroy(int unit, opennsl_vlan_t vid) {
+    SIMULATOR_ENTER_CALL(VlanDestroy);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    if (0 == unitState->vlans.erase(vid)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_vlan_port_add(int unit, opennsl_vlan_t vid, opennsl_pbmp_t pbmp, opennsl_pbmp_t ubmp) {
+    SIMULATOR_ENTER_CALL(VlanPortAdd);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto foundVlanIt = unitState->vlans.find(vid);
+    if (foundVlanIt == std::end(unitState->vlans)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    // Like h/w, adding already existing member updates its tagging mode, unless disabled
+    auto& vlanState = foundVlanIt->second;
+    const bool retagging = simulator.isVlanPortAddRetagging();
+    opennsl_port_t port {};
+    OPENNSL_PBMP_ITER(pbmp, port) {
+        if ((not retagging) && OPENNSL_PBMP_MEMBER(vlanState.members, port)) {
+            continue;
+        }
+
+        OPENNSL_PBMP_PORT_ADD(vlanState.members, port);
+        if (OPENNSL_PBMP_MEMBER(ubmp, port)) {
+            OPENNSL_PBMP_PORT_ADD(vlanState.untagged, port);
+        } else {
+            OPENNSL_PBMP_PORT_REMOVE(vlanState.untagged, port);
+        }
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_vlan_port_remove(int unit, opennsl_vlan_t vid, opennsl_pbmp_t pbmp) {
+    SIMULATOR_ENTER_CALL(VlanPortRemove);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto foundVlanIt = unitState->vlans.find(vid);
+    if (foundVlanIt == std::end(unitState->vlans)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    opennsl_port_t port {};
+    OPENNSL_PBMP_ITER(pbmp, port) {
+        OPENNSL_PBMP_PORT_REMOVE(foundVlanIt->second.members, port);
+        OPENNSL_PBMP_PORT_REMOVE(foundVlanIt->second.untagged, port);
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_vlan_port_get(int unit, opennsl_vlan_t vid, opennsl_pbmp_t* pbmp, opennsl_pbmp_t* ubmp) {
+    SIMULATOR_ENTER_CALL(VlanPortGet);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto foundVlanIt = unitState->vlans.find(vid);
+    if (foundVlanIt == std::end(unitState->vlans)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    *pbmp = foundVlanIt->second.members;
+    *ubmp = foundVlanIt->second.untagged;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_stg_create(int unit, opennsl_stg_t* stg_ptr) {
+    SIMULATOR_ENTER_CALL(StgCreate);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    opennsl_stg_t stg = 2; // STG 1 is default one
+    while (unitState->stgs.find(stg) != std::end(unitState->stgs)) {
+        ++stg;
+    }
+
+    unitState->stgs.emplace(stg, std::vector<opennsl_vlan_t> {});
+    *stg_ptr = stg;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_stg_destroy(int unit, opennsl_stg_t stg) {
+    SIMULATOR_ENTER_CALL(StgDestroy);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    if (0 == unitState->stgs.erase(stg)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_stg_vlan_add(int unit, opennsl_stg_t stg, opennsl_vlan_t vid) {
+    SIMULATOR_ENTER_CALL(StgVlanAdd);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto foundStgIt = unitState->stgs.find(stg);
+    if (foundStgIt == std::end(unitState->stgs)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    foundStgIt->second.push_back(vid);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_stg_stp_set(int unit, opennsl_stg_t /* stg */, opennsl_port_t port, int stp_state) {
+    SIMULATOR_ENTER_CALL(StgStpSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    portState->stpState = stp_state;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_register(int unit, opennsl_linkscan_handler_t f) {
+    SIMULATOR_ENTER_CALL(LinkscanRegister);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto& handlers = unitState->linkScanHandlers;
+    if (std::find(std::begin(handlers), std::end(handlers), f) != std::end(handlers)) {
+        return OPENNSL_E_EXISTS;
+    }
+
+    handlers.push_back(f);
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_unregister(int unit, opennsl_linkscan_handler_t f) {
+    SIMULATOR_ENTER_CALL(LinkscanUnregister);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    auto& handlers = unitState->linkScanHandlers;
+    auto foundIt = std::find(std::begin(handlers), std::end(handlers), f);
+    if (foundIt == std::end(handlers)) {
+        return OPENNSL_E_NOT_FOUND;
+    }
+
+    handlers.erase(foundIt);
+    // Like SDK, handler isn't called anymore once it is unregistered. State lock is released while
+    // waiting, so handler can't be unregistered from handler itself.
+    simulator.waitForLinkScanHandlers();
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_enable_set(int unit, int us) {
+    SIMULATOR_ENTER_CALL(LinkscanEnableSet);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    unitState->linkScanIntervalUs = us;
+    if (us > 0) {
+        unitState->nextLinkScanAt = std::chrono::steady_clock::now() + std::chrono::microseconds { us };
+        simulator.wakeUpLinkScan();
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_mode_set(int unit, opennsl_port_t port, int mode) {
+    SIMULATOR_ENTER_CALL(LinkscanModeSet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    portState->info.linkscan = mode;
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_mode_set_pbm(int unit, opennsl_pbmp_t pbm, int mode) {
+    SIMULATOR_ENTER_CALL(LinkscanModeSetPbm);
+    SIMULATOR_GET_UNIT_OR_RETURN(unitState, unit);
+    opennsl_port_t port {};
+    OPENNSL_PBMP_ITER(pbm, port) {
+        auto portState = simulator.getPort(unit, port);
+        if (nullptr == portState) {
+            return OPENNSL_E_PORT;
+        }
+
+        portState->info.linkscan = mode;
+    }
+
+    return OPENNSL_E_NONE;
+}
+
+int opennsl_linkscan_mode_get(int unit, opennsl_port_t port, int* mode) {
+    SIMULATOR_ENTER_CALL(LinkscanModeGet);
+    SIMULATOR_GET_PORT_OR_RETURN(portState, unit, port);
+    *mode = portState->info.linkscan;
+    return OPENNSL_E_NONE;
+}
+
+const char* opennsl_errmsg(int rv) {
+    switch (rv) {
+      case OPENNSL_E_NONE: return "Ok";
+      case OPENNSL_E_INTERNAL: return "Internal error";
+      case OPENNSL_E_MEMORY: return "Out of memory";
+      case OPENNSL_E_UNIT: return "Invalid unit";
+      case OPENNSL_E_PARAM: return "Invalid parameter";
+      case OPENNSL_E_EMPTY: return "Table empty";
+      case OPENNSL_E_FULL: return "Table full";
+      case OPENNSL_E_NOT_FOUND: return "Entry not found";
+      case OPENNSL_E_EXISTS: return "Entry exists";
+      case OPENNSL_E_TIMEOUT: return "Operation timed out";
+      case OPENNSL_E_BUSY: return "Operation still running";
+      case OPENNSL_E_FAIL: return "Operation failed";
+      case OPENNSL_E_DISABLED: return "Operation disabled";
+      case OPENNSL_E_BADID: return "Invalid identifier";
+      case OPENNSL_E_RESOURCE: return "No resources for operation";
+      case OPENNSL_E_CONFIG: return "Invalid configuration";
+      case OPENNSL_E_UNAVAIL: return "Feature unavailable";
+      case OPENNSL_E_INIT: return "Feature not initialized";
+      case OPENNSL_E_PORT: return "Invalid port";
+      default: return "Unknown error";
+    }
+}
+
+} // extern "C"
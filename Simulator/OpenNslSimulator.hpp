@@ -0,0 +1,187 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+// C++ Standard Library
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#   include <opennsl/error.h>
+#   include <opennsl/link.h>
+#   include <opennsl/port.h>
+#   include <opennsl/types.h>
+}
+
+namespace OpenNos {
+
+/// SDK calls implemented by simulator
+enum class SdkCall : size_t {
+    DriverInit,
+    PortSelectiveSet,
+    PortAbilityLocalGet,
+    PortAbilityAdvertGet,
+    PortLinkStatusGet,
+    PortConfigGet,
+    PortStpSet,
+    PortVlanMemberSet,
+    PortControlSet,
+    PortUntaggedVlanSet,
+    StatClear,
+    L2AddrDeleteByPort,
+    L2AddrDeleteByTrunk,
+    VlanCreate,
+    VlanDestroy,
+    VlanPortAdd,
+    VlanPortRemove,
+    VlanPortGet,
+    StgCreate,
+    StgDestroy,
+    StgVlanAdd,
+    StgStpSet,
+    LinkscanRegister,
+    LinkscanUnregister,
+    LinkscanEnableSet,
+    LinkscanModeSet,
+    LinkscanModeSetPbm,
+    LinkscanModeGet,
+    Count
+};
+
+/// Simulates OpenNSL library on plain Linux, so control plane can be run and measured without
+/// switch. Simulator is linked instead of SDK library (link-time replacement), application code
+/// stays untouched. Each SDK call can be delayed by configured latency and can be forced to fail.
+/// @note All of opennsl_* functions are implemented in OpenNslSimulator.cpp
+class OpenNslSimulator final {
+  public:
+    static constexpr int MaxUnits = 8;
+    static constexpr int DefaultEthernetPortsCount = 128;
+
+    struct LinkScanEvent {
+        std::chrono::microseconds delay; // Delay after previous event
+        int unit;
+        opennsl_port_t port;
+        bool linkUp;
+    };
+
+    static OpenNslSimulator& getInstance();
+    /// Restores default state of all units, latencies, failures and counters
+    void reset();
+    /// Ethernet ports of unit are numbered from 1, port 0 is CPU port. Count is clamped to size of port bitmap.
+    void setEthernetPortsCount(const int unit, const int portsCount);
+    void setCallLatency(const SdkCall call, const std::chrono::nanoseconds latency);
+    /// Every @p failEveryNth call of @p call fails with @p errorCode. Zero disables injection.
+    void setCallFailure(const SdkCall call, const uint64_t failEveryNth, const int errorCode = OPENNSL_E_FAIL);
+    /// Emulates SDK whose opennsl_vlan_port_add() keeps tagging mode of ports which are members already
+    void setVlanPortAddRetagging(const bool retagging) { _vlanPortAddRetagging = retagging; }
+    bool isVlanPortAddRetagging() const { return _vlanPortAddRetagging; }
+    uint64_t getCallsCount(const SdkCall call) const;
+    uint64_t getTotalCallsCount() const;
+
+    /// Changes link status of port and invokes registered linkscan handlers in context of calling thread
+    void injectLinkEvent(const int unit, const opennsl_port_t port, const bool linkUp);
+    /// Changes link status of PHY. Like SDK, simulated linkscan thread detects it and invokes registered
+    /// handlers: in software mode on next poll of PHYs each linkscan interval, in hardware mode after
+    /// interrupt latency. Linkscan runs while interval set by opennsl_linkscan_enable_set() is not zero.
+    void setPhysicalLinkStatus(const int unit, const opennsl_port_t port, const bool linkUp);
+    /// Time from link change to handling of link interrupt by linkscan thread
+    void setLinkInterruptLatency(const std::chrono::microseconds latency);
+    /// Replays link events in separated thread which emulates SDK linkscan thread
+    void runLinkScanScript(std::vector<LinkScanEvent> script);
+    /// Blocks until script started by runLinkScanScript() is finished
+    void waitForLinkScanScript();
+    bool isLinkUp(const int unit, const opennsl_port_t port) const;
+
+    /// Entry of all simulated SDK calls. Applies latency and failure injection.
+    /// @return OPENNSL_E_NONE or injected error code
+    int enterCall(const SdkCall call);
+
+    // State accessed by simulated SDK calls
+    struct PortState {
+        opennsl_port_info_t info;
+        opennsl_port_ability_t localAbility;
+        opennsl_port_ability_t advertAbility;
+        int stpState;
+        opennsl_vlan_t untaggedVlan;
+        bool linkUp; // Reported to linkscan handlers
+        bool physicalLinkUp;
+    };
+
+    struct VlanState {
+        opennsl_pbmp_t members;
+        opennsl_pbmp_t untagged;
+    };
+
+    struct UnitState {
+        int ethernetPortsCount;
+        std::vector<PortState> ports; // Indexed by h/w port
+        std::map<opennsl_vlan_t, VlanState> vlans;
+        std::map<opennsl_stg_t, std::vector<opennsl_vlan_t>> stgs;
+        std::vector<opennsl_linkscan_handler_t> linkScanHandlers;
+        int linkScanIntervalUs;
+        std::chrono::steady_clock::time_point nextLinkScanAt; // Next poll of PHYs in software mode
+        bool linkInterruptPending;
+        std::chrono::steady_clock::time_point linkInterruptAt; // When pending interrupt is handled
+    };
+
+    std::mutex& getStateMutex() { return _stateMtx; }
+    UnitState* getUnit(const int unit);
+    PortState* getPort(const int unit, const opennsl_port_t port);
+    /// Starts linkscan thread if needed and lets it reschedule polls, has to be called with state mutex locked
+    void wakeUpLinkScan();
+    /// Blocks until no linkscan handler is being invoked, has to be called with state mutex locked. Mutex is
+    /// released while waiting, so handlers can call SDK.
+    void waitForLinkScanHandlers();
+
+  private:
+    OpenNslSimulator();
+    ~OpenNslSimulator();
+    void resetUnit(UnitState& unitState, const int portsCount);
+    void stopLinkScan();
+    void runLinkScan();
+    /// Reports changed link status of ports in @p linkScanMode to handlers of unit
+    void scanLinks(const int unit, const int linkScanMode, std::unique_lock<std::mutex>& stateLock);
+    /// Invokes handlers registered at the moment without state lock, has to be called with state lock locked
+    void invokeLinkScanHandlers(const int unit, const std::vector<std::pair<opennsl_port_t, opennsl_port_info_t>>& changedPorts,
+                                std::unique_lock<std::mutex>& stateLock);
+
+    struct CallSetting {
+        std::atomic<int64_t> latencyNs;
+        std::atomic<uint64_t> failEveryNth;
+        std::atomic<int> errorCode;
+        std::atomic<uint64_t> callsCount;
+    };
+
+    std::array<CallSetting, static_cast<size_t>(SdkCall::Count)> _callSettings;
+    mutable std::mutex _stateMtx;
+    std::array<UnitState, MaxUnits> _units;
+    std::thread _linkScanScriptThread;
+    std::thread _linkScanThread;
+    std::condition_variable _linkScanCv;
+    bool _linkScanStopping;
+    std::chrono::microseconds _linkInterruptLatency;
+    std::atomic<bool> _vlanPortAddRetagging;
+    size_t _invokedLinkScanHandlers; // Calls of handlers which haven't returned yet, guarded by state mutex
+    std::condition_variable_any _linkScanHandlersReturned;
+};
+
+} // namespace OpenNos
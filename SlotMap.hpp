@@ -0,0 +1,174 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+/// Handle of object kept in slot map. It consists of slot index and generation which slot had
+/// when object was put in. Generation is bumped when object is put in and when it is removed,
+/// so odd generation means occupied slot and handle of removed object never matches its slot
+/// again, even when slot is reused. Handle is trivially copyable and ordered, so it can be used
+/// as a key of maps without touching object or its reference count.
+template <typename TYPE>
+class SlotHandle {
+  public:
+    constexpr SlotHandle() : _index { 0 }, _generation { 0 } {}
+    constexpr SlotHandle(const uint32_t index, const uint32_t generation) : _index { index }, _generation { generation } {}
+    uint32_t getIndex() const { return _index; }
+    uint32_t getGeneration() const { return _generation; }
+    /// Null handle doesn't refer to any object
+    bool isNull() const { return 0 == _generation; }
+
+    bool operator==(const SlotHandle& other) const { return (_index == other._index) && (_generation == other._generation); }
+    bool operator!=(const SlotHandle& other) const { return not (*this == other); }
+    bool operator<(const SlotHandle& other) const {
+        return (_index != other._index) ? (_index < other._index) : (_generation < other._generation);
+    }
+
+  private:
+    uint32_t _index;
+    uint32_t _generation;
+};
+
+/// Slot of slot map, object is owned by slot
+template <typename TYPE>
+struct Slot {
+    uint32_t generation;
+    std::shared_ptr<TYPE> object;
+
+    bool isOccupied() const { return (generation & 1) != 0; }
+};
+
+/// Objects indexed directly by their IDs, which are indexes of slots. Resolving handle costs one
+/// compare of generations in slot which holds the object, so it is O(1) without any atomic
+/// operation. Suitable for small and bounded ID spaces like VLANs or ports.
+/// @note Objects are owned by shared pointers, because some of them (e.g. observers) hand out
+/// shared pointers to themselves
+template <typename TYPE, typename TYPE_ID, size_t MAX_IDS>
+class DenseSlotMap {
+  public:
+    using Handle = SlotHandle<TYPE>;
+
+    DenseSlotMap() : _slots {}, _size { 0 } {}
+
+    /// @return null handle if @p id is out of range or it is already occupied
+    Handle emplace(const TYPE_ID id, std::shared_ptr<TYPE> object) {
+        const auto index = static_cast<size_t>(id);
+        if ((index >= MAX_IDS) || _slots[index].isOccupied()) {
+            return Handle {};
+        }
+
+        auto& slot = _slots[index];
+        slot.object = std::move(object);
+        ++slot.generation;
+        ++_size;
+        return Handle { static_cast<uint32_t>(index), slot.generation };
+    }
+
+    size_t erase(const TYPE_ID id) {
+        const auto index = static_cast<size_t>(id);
+        if ((index >= MAX_IDS) || (not _slots[index].isOccupied())) {
+            return 0;
+        }
+
+        auto& slot = _slots[index];
+        ++slot.generation; // Handles of object are stale before object is destroyed
+        slot.object.reset();
+        --_size;
+        return 1;
+    }
+
+    size_t count(const TYPE_ID id) const {
+        const auto index = static_cast<size_t>(id);
+        return ((index < MAX_IDS) && _slots[index].isOccupied()) ? 1 : 0;
+    }
+
+    /// @return null handle if there is no object of @p id
+    Handle getHandle(const TYPE_ID id) const {
+        return (count(id) != 0) ? Handle { static_cast<uint32_t>(id), _slots[static_cast<size_t>(id)].generation } : Handle {};
+    }
+
+    /// @return nullptr if object of @p handle has been removed
+    TYPE* get(const Handle handle) const {
+        const auto& slot = _slots[handle.getIndex() % MAX_IDS];
+        return (slot.generation == handle.getGeneration()) ? slot.object.get() : nullptr;
+    }
+
+    size_t size() const { return _size; }
+
+  private:
+    std::array<Slot<TYPE>, MAX_IDS> _slots;
+    size_t _size;
+};
+
+/// Objects kept in node-based map keyed by their IDs, for sparse or unbounded ID spaces.
+/// Slot of removed object is kept, so its generation is not lost if ID is reused.
+template <typename TYPE, typename TYPE_ID>
+class OrderedSlotMap {
+  public:
+    using Handle = SlotHandle<TYPE>;
+
+    OrderedSlotMap() : _slots {}, _size { 0 } {}
+
+    Handle emplace(const TYPE_ID id, std::shared_ptr<TYPE> object) {
+        auto& slot = _slots[id];
+        if (slot.isOccupied()) {
+            return Handle {};
+        }
+
+        slot.object = std::move(object);
+        ++slot.generation;
+        ++_size;
+        return Handle { static_cast<uint32_t>(id), slot.generation };
+    }
+
+    size_t erase(const TYPE_ID id) {
+        auto slotIt = _slots.find(id);
+        if ((slotIt == _slots.end()) || (not slotIt->second.isOccupied())) {
+            return 0;
+        }
+
+        ++slotIt->second.generation;
+        slotIt->second.object.reset();
+        --_size;
+        return 1;
+    }
+
+    size_t count(const TYPE_ID id) const {
+        const auto slotIt = _slots.find(id);
+        return ((slotIt != _slots.end()) && slotIt->second.isOccupied()) ? 1 : 0;
+    }
+
+    Handle getHandle(const TYPE_ID id) const {
+        const auto slotIt = _slots.find(id);
+        return ((slotIt != _slots.end()) && slotIt->second.isOccupied())
+                ? Handle { static_cast<uint32_t>(id), slotIt->second.generation } : Handle {};
+    }
+
+    TYPE* get(const Handle handle) const {
+        const auto slotIt = _slots.find(static_cast<TYPE_ID>(handle.getIndex()));
+        return ((slotIt != _slots.end()) && (slotIt->second.generation == handle.getGeneration())) ? slotIt->second.object.get() : nullptr;
+    }
+
+    size_t size() const { return _size; }
+
+  private:
+    std::map<TYPE_ID, Slot<TYPE>> _slots;
+    size_t _size;
+};
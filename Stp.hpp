@@ -14,11 +14,13 @@
 
 #pragma once
 
+#include "Types.hpp"
+
 #include <memory>
 
 class Stp {
   public:
-    using Handle = std::shared_ptr<Stp>;
-    using Id = uint16_t;
+    using Handle = StpHandle;
+    using Id = StpId;
 };
 
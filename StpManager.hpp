@@ -19,7 +19,7 @@
 #include "PortManager.hpp"
 #include "Stp.hpp"
 
-class StpManager final : public CommandManager<Stp, Stp::Id, Stp::Handle> {
+class StpManager final : public CommandManager<Stp, Stp::Id, DenseCommandStorage<MaxStps>> {
   public:
     inline StpManager(PortManager::Handle& portManager, LagManager::Handle& lagManager);
 
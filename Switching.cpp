@@ -14,13 +14,17 @@
 
 #include "Switching.hpp"
 
+#include "HwPortMapping.hpp"
+
 extern "C" {
 #   include <opennsl/l2.h>
 }
 
-Switching::Switching(Asic::Handle& asic, PortManager::Handle& portManager, MacLearning::Handle& macLearning)
-    : _asic { asic }, _portManager { portManager } {
-    // Nothing more to do
+Switching::Switching(Asic::Handle& asic, PortManager::Handle& portManager)
+    : _asic { asic }, _portManager { portManager }, _hwCommandProcessor { std::make_shared<HwCommandProcessor>() },
+      _eventBus { std::make_shared<EventBus>() }, _lagManager { std::make_shared<LagManager>(_portManager) },
+      _vlanManager { std::make_shared<VlanManager>(_portManager, _lagManager, _hwCommandProcessor, _eventBus) } {
+    _portManager->setHwCommandProcessor(_hwCommandProcessor);
 }
 
 Result::Value Switching::init() {
@@ -29,6 +33,23 @@ Result::Value Switching::init() {
         return Result::Value::Fail;
     }
 
+    if (Failed(_hwCommandProcessor->start())) {
+        ERROR_LOG("Failed start ASIC thread");
+        return Result::Value::Fail;
+    }
+
+    if (Failed(_eventBus->start())) {
+        ERROR_LOG("Failed start event bus");
+        return Result::Value::Fail;
+    }
+
+    // Ports are mapped 1:1 to h/w ports if platform has no mapping file
+    const auto mappingResult = OpenNos::HwPortMapping::getInstance().load(OpenNos::HwPortMapping::DefaultPlatformFilePath);
+    if (Failed(mappingResult) && (mappingResult != Result::Value::NotExists)) {
+        ERROR_LOG("Failed load mapping of platform ports");
+        return Result::Value::Fail;
+    }
+
     if (Failed(_portManager->init())) {
         ERROR_LOG("Failed initialize port module");
         return Result::Value::Fail;
@@ -15,7 +15,11 @@
 #pragma once
 
 #include <Asic.hpp>
+#include <EventBus.hpp>
+#include <HwCommandProcessor.hpp>
+#include <LagManager.hpp>
 #include <PortManager.hpp>
+#include <VlanManager.hpp>
 
 class MacLearning {
   public:
@@ -35,10 +39,22 @@ class Switching {
   public:
     using Handle = std::shared_ptr<Switching>;
     Switching(Asic::Handle& asic, PortManager::Handle& portManager);
+    /// Starts ASIC thread and event bus before any module is initialized, so SDK calls of all modules
+    /// go through ASIC thread and their link status observers are updated by the bus
     Result::Value init();
+    HwCommandProcessor::Handle& getHwCommandProcessor() { return _hwCommandProcessor; }
+    EventBus::Handle& getEventBus() { return _eventBus; }
+    LagManager::Handle& getLagManager() { return _lagManager; }
+    VlanManager::Handle& getVlanManager() { return _vlanManager; }
 
   private:
     Asic::Handle _asic;
     PortManager::Handle _portManager;
+    /// The only thread which executes commands of managers in ASIC
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    /// Updates observers of link status, so link scan notifier isn't delayed by them
+    EventBus::Handle _eventBus;
+    LagManager::Handle _lagManager;
+    VlanManager::Handle _vlanManager;
 };
 
@@ -14,7 +14,73 @@
 
 #include "TopologicalSorting.hpp"
 
-TopologicalSorting::TopologicalSorting()
-{
+TopologicalSorting::TopologicalSorting() {
+    // Nothing more to do
+}
+
+void TopologicalSorting::addDependency(const Vertex before, const Vertex after) {
+    // Everything what reaches before, reaches also after and all successors of after
+    std::set<Vertex> reachableByEdge { _reachable[after] };
+    reachableByEdge.emplace(after);
+    _reachable.emplace(before, std::set<Vertex> {});
+    for (auto& vertexReachable : _reachable) {
+        if ((vertexReachable.first == before) || (vertexReachable.second.find(before) != std::end(vertexReachable.second))) {
+            vertexReachable.second.insert(std::begin(reachableByEdge), std::end(reachableByEdge));
+        }
+    }
+}
+
+const std::set<TopologicalSorting::Vertex>& TopologicalSorting::getSuccessors(const Vertex vertex) const {
+    static const std::set<Vertex> noSuccessors {};
+    const auto foundIt = _reachable.find(vertex);
+    return foundIt != std::end(_reachable) ? foundIt->second : noSuccessors;
+}
+
+Result::Value TopologicalSorting::sortIntoLevels(const std::set<Vertex>& vertices, std::vector<Level>& levels) const {
+    // Kahn's algorithm on subgraph induced by transitive closure of requested vertices
+    std::map<Vertex, std::set<Vertex>> successors {};
+    std::map<Vertex, size_t> inDegree {};
+    for (const auto vertex : vertices) {
+        inDegree.emplace(vertex, 0);
+    }
+
+    for (const auto vertex : vertices) {
+        const auto& reachable = getSuccessors(vertex);
+        if (reachable.find(vertex) != std::end(reachable)) {
+            return Result::Value::Fail;
+        }
+
+        for (const auto next : reachable) {
+            if (vertices.find(next) != std::end(vertices)) {
+                successors[vertex].emplace(next);
+                ++inDegree[next];
+            }
+        }
+    }
+
+    levels.clear();
+    Level currentLevel {};
+    for (const auto& vertexInDegree : inDegree) {
+        if (0 == vertexInDegree.second) {
+            currentLevel.push_back(vertexInDegree.first);
+        }
+    }
+
+    size_t sortedCount = 0;
+    while (not currentLevel.empty()) {
+        Level nextLevel {};
+        for (const auto vertex : currentLevel) {
+            for (const auto next : successors[vertex]) {
+                if (0 == --inDegree[next]) {
+                    nextLevel.push_back(next);
+                }
+            }
+        }
+
+        sortedCount += currentLevel.size();
+        levels.emplace_back(std::move(currentLevel));
+        currentLevel = std::move(nextLevel);
+    }
 
+    return sortedCount == vertices.size() ? Result::Value::Success : Result::Value::Fail;
 }
@@ -14,10 +14,31 @@
 
 #pragma once
 
+#include "Types.hpp"
 
-class TopologicalSorting
-{
-public:
+#include <map>
+#include <set>
+#include <vector>
+
+/// Sorts vertices of directed acyclic graph into levels. All vertices in the same level
+/// do not depend on each other, so they can be processed together. Each vertex from level N
+/// depends only on vertices from levels lower than N.
+class TopologicalSorting {
+  public:
+    using Vertex = size_t;
+    using Level = std::vector<Vertex>;
     TopologicalSorting();
-};
+    /// Adds edge which means that @p before has to be processed before @p after. Transitive
+    /// closure of graph is updated here, so sorting only reads graph and can run concurrently.
+    void addDependency(const Vertex before, const Vertex after);
+    /// Sorts only requested vertices. Dependencies are resolved transitively, so if A -> B -> C
+    /// and only A and C are requested, then A is still placed before C.
+    /// @retval Result::Value::Fail if graph contains cycle
+    Result::Value sortIntoLevels(const std::set<Vertex>& vertices, std::vector<Level>& levels) const;
 
+  private:
+    /// Returns all vertices which are reachable from @p vertex
+    const std::set<Vertex>& getSuccessors(const Vertex vertex) const;
+
+    std::map<Vertex, std::set<Vertex>> _reachable; // Transitive closure of added edges
+};
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include "SlotMap.hpp"
+
 #include <array>
 #include <cstdint>
 #include <limits>
@@ -34,6 +36,7 @@ namespace Result {
       NoMemory,
       UpdateReasonNotSupported,
       CommandNotUndoable,
+      NotSupported,
       Fail = std::numeric_limits<uint8_t>::max()
   };
 
@@ -45,41 +48,25 @@ namespace Result {
   constexpr auto gResultFailString { "Fail" };
 }
 
-template <typename TYPE_HANDLE>
-struct WeakHandleCompare {
-   bool operator() (const TYPE_HANDLE& lhs, const TYPE_HANDLE& rhs) const {
-       if (auto lhsShared = lhs.lock()) { // Has to be copied into a shared_ptr before usage
-           if (auto rhsShared = rhs.lock()) {
-               return lhsShared->id() < rhsShared->id();
-           }
-
-           return true;
-       }
-
-       return false;
-   }
-};
-
-/// @note Below types are dynamically create and delete so they are define in one place
+/// @note Below types are dynamically create and delete so they are define in one place.
+/// Objects are owned by their managers, handles are generational (see SlotHandle), so checking
+/// whether object still exists costs one compare.
 class Port;
 using MemberPortOwnerHandle = std::shared_ptr<Port>;
 using PortId = uint16_t;
-using PortHandle = std::weak_ptr<Port>;
+using PortHandle = SlotHandle<Port>;
 
 class Lag;
-using LagOwnedHandle = std::weak_ptr<Lag>;
 using LagId = uint16_t;
-using LagHandle = std::weak_ptr<Lag>;
+using LagHandle = SlotHandle<Lag>;
 
 class Stp;
-using StpOwnedHandle = std::weak_ptr<Stp>;
 using StpId = uint16_t;
-using StpHandle = std::weak_ptr<Stp>;
+using StpHandle = SlotHandle<Stp>;
 
 class Vlan;
-using VlanOwnedHandle = std::weak_ptr<Vlan>;
 using VlanId = uint16_t;
-using VlanHandle = std::weak_ptr<Vlan>;
+using VlanHandle = SlotHandle<Vlan>;
 
 enum class PortSpeed : size_t {
     _1Mb   = 1,
@@ -106,6 +93,12 @@ enum class PortSplitMode : uint8_t {
     _2x200
 };
 
+/// How SDK linkscan detects link changes of port
+enum class LinkScanMode : uint8_t {
+    Software, // PHY is polled each linkscan interval
+    Hardware  // ASIC interrupts linkscan on link change
+};
+
 enum class PortLaneNo : uint8_t {
     // 10G/25G/100G mode
     Lane_1 = 1,
@@ -117,6 +110,12 @@ enum class PortLaneNo : uint8_t {
     Lane_3_4
 };
 
+/// Upper bounds of ID spaces, used to size dense tables
+static constexpr size_t MaxPorts = 512; // Front panel ports including breakout ports
+static constexpr size_t MaxVlans = 4096;
+static constexpr size_t MaxLags = 1024;
+static constexpr size_t MaxStps = 512;
+
 static constexpr uint8_t MaxSlavePorts = 4;
 static constexpr uint8_t MacAddressSize = 6;
 
@@ -131,6 +130,7 @@ struct PortParameters {
     bool txPause;
     PortSplitMode splitMode;
     PortSpeed speed;
+    LinkScanMode linkScanMode;
     uint32_t preemphasis;
     uint32_t current;
     PortId parentPort;
@@ -0,0 +1,580 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "VlanLinkStatusHandling.hpp"
+
+#include "Asic.hpp"
+#include "HwPort.hpp"
+#include "HwPortManager.hpp"
+#include "HwVlan.hpp"
+#include "LoggingFacility.hpp"
+
+extern "C" {
+#   include <opennsl/error.h>
+#   include <opennsl/port.h>
+#   include <opennsl/vlan.h>
+}
+
+namespace {
+
+constexpr size_t toIndex(const VlanPortRole role) { return static_cast<size_t>(role); }
+
+constexpr bool isExclusiveRole(const VlanPortRole role) { return VlanPortRole::Subinterface != role; }
+
+/// Runs reconfiguration of VLANs on link change in ASIC thread
+class LinkChangeReconfiguring final : public Command {
+  public:
+    LinkChangeReconfiguring(std::weak_ptr<VlanLinkStatusHandling> linkStatusHandling, const PortBitmap& linkedUpPorts,
+                            const PortBitmap& linkedDownPorts)
+        : _linkStatusHandling { std::move(linkStatusHandling) }, _linkedUpPorts { linkedUpPorts }, _linkedDownPorts { linkedDownPorts } {
+        // Nothing more to do
+    }
+
+    virtual ~LinkChangeReconfiguring() override = default;
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        auto linkStatusHandling = _linkStatusHandling.lock();
+        if (not linkStatusHandling) {
+            CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+        }
+
+        // Macro evaluates its argument more than once, so VLANs mustn't be reconfigured inside it
+        const auto result = linkStatusHandling->reconfigureOnLinkChange(_linkedUpPorts, _linkedDownPorts);
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+    }
+
+  private:
+    std::weak_ptr<VlanLinkStatusHandling> _linkStatusHandling;
+    PortBitmap _linkedUpPorts;
+    PortBitmap _linkedDownPorts;
+};
+
+/// Runs reconfiguration of VLANs by link status read from ASIC in ASIC thread
+class LinkStatusSyncing final : public Command {
+  public:
+    explicit LinkStatusSyncing(std::weak_ptr<VlanLinkStatusHandling> linkStatusHandling)
+        : _linkStatusHandling { std::move(linkStatusHandling) } {
+        // Nothing more to do
+    }
+
+    virtual ~LinkStatusSyncing() override = default;
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        auto linkStatusHandling = _linkStatusHandling.lock();
+        if (not linkStatusHandling) {
+            CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+        }
+
+        const auto result = linkStatusHandling->reconfigureOnLinkStatus();
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+    }
+
+  private:
+    std::weak_ptr<VlanLinkStatusHandling> _linkStatusHandling;
+};
+
+} // namespace
+
+VlanLinkStatusHandling::VlanLinkStatusHandling(HwCommandProcessor::Handle hwCommandProcessor)
+    : Observer({ UpdateReason::LinkStatusUpdate }), _hwCommandProcessor { hwCommandProcessor },
+      _vlanPorts(MaxVlans), _configuredVlansOfPort(MaxPorts), _programmedVlansOfPort(MaxPorts),
+      _collectedPorts(MaxVlans), _statistics {} {
+    // Nothing more to do
+}
+
+ObserverId VlanLinkStatusHandling::hash() {
+    return static_cast<ObserverId>(ObserverIdentifier::VlanLinkStatusHandling);
+}
+
+void VlanLinkStatusHandling::update(const ObservedSubjectHandle& /* subject */, const UpdateReason updateReason) {
+    // Link status changes come with link events by updateLinkStatus()
+    if (UpdateReason::LinkStatusUpdate == updateReason) {
+        ERROR_LOG("Got link scan update without link events");
+    }
+}
+
+void VlanLinkStatusHandling::updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& linkEvents) {
+    if (not std::dynamic_pointer_cast<HwPortLinkScanHandling const>(subject)) {
+        ERROR_LOG("Got link scan update from unknown source");
+        return;
+    }
+
+    PortBitmap linkedUpPorts {};
+    PortBitmap linkedDownPorts {};
+    for (const auto& linkEvent : *linkEvents) {
+        if (not PortBitmap::isValid(linkEvent.portNo)) {
+            continue;
+        }
+
+        // Later event of the same port wins
+        (linkEvent.linkedUp ? linkedUpPorts : linkedDownPorts).set(linkEvent.portNo);
+        (linkEvent.linkedUp ? linkedDownPorts : linkedUpPorts).reset(linkEvent.portNo);
+    }
+
+    // Link events are ordered with VLAN commits by the queue of ASIC thread
+    auto reconfiguring = std::make_shared<LinkChangeReconfiguring>(weak_from_this(), linkedUpPorts, linkedDownPorts);
+    if (Result::Failed(_hwCommandProcessor->addCommandToExecute(reconfiguring))) {
+        ERROR_LOG("Failed to queue VLAN reconfiguration on link change");
+    }
+}
+
+void VlanLinkStatusHandling::syncLinkStatus() {
+    // Link events which come later are queued after reading, so they aren't overwritten by it
+    auto syncing = std::make_shared<LinkStatusSyncing>(weak_from_this());
+    if (Result::Failed(_hwCommandProcessor->addCommandToExecute(syncing))) {
+        ERROR_LOG("Failed to queue VLAN reconfiguration on link status");
+    }
+}
+
+Result::Value VlanLinkStatusHandling::setVlanCreated(const VlanId vid, const bool created) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if (created == _createdVlans.test(vid)) {
+        return Result::Value::Success;
+    }
+
+    if (not created) {
+        collectProgrammedPorts(vid, _linkedUpPorts);
+        const auto result = removeCollectedPorts();
+        _createdVlans.reset(vid);
+        return result;
+    }
+
+    _createdVlans.set(vid);
+    collectPortsToAdd(vid, _linkedUpPorts);
+    return addCollectedPorts();
+}
+
+Result::Value VlanLinkStatusHandling::addPortRole(const VlanId vid, const PortId portNo, const VlanPortRole role) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if ((not PortBitmap::isValid(portNo)) || (VlanPortRole::Count == role)) {
+        return Result::Value::PortNotExists;
+    }
+
+    auto& vlanPorts = _vlanPorts[vid];
+    if (vlanPorts.configured[toIndex(role)].test(portNo)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    Result::Value result = Result::Value::Success;
+    if (isExclusiveRole(role)) {
+        for (size_t otherRole = 0; otherRole < RolesCount; ++otherRole) {
+            if (isExclusiveRole(static_cast<VlanPortRole>(otherRole)) && vlanPorts.configured[otherRole].test(portNo)) {
+                result = removePortRole(vid, portNo, static_cast<VlanPortRole>(otherRole));
+            }
+        }
+    }
+
+    vlanPorts.configured[toIndex(role)].set(portNo);
+    _configuredVlansOfPort[portNo][toIndex(role)].set(vid);
+    if (_linkedUpPorts.test(portNo) && _createdVlans.test(vid)) {
+        _collectedPorts[vid][toIndex(role)].set(portNo);
+        _collectedVlans.set(vid);
+        if (Result::Failed(addCollectedPorts())) {
+            result = Result::Value::Fail;
+        }
+    }
+
+    return result;
+}
+
+Result::Value VlanLinkStatusHandling::removePortRole(const VlanId vid, const PortId portNo, const VlanPortRole role) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if ((not PortBitmap::isValid(portNo)) || (VlanPortRole::Count == role)) {
+        return Result::Value::PortNotExists;
+    }
+
+    auto& vlanPorts = _vlanPorts[vid];
+    if (not vlanPorts.configured[toIndex(role)].test(portNo)) {
+        return Result::Value::PortInVlanNotExists;
+    }
+
+    vlanPorts.configured[toIndex(role)].reset(portNo);
+    _configuredVlansOfPort[portNo][toIndex(role)].reset(vid);
+    if (not vlanPorts.programmed[toIndex(role)].test(portNo)) {
+        return Result::Value::Success;
+    }
+
+    _collectedPorts[vid][toIndex(role)].set(portNo);
+    _collectedVlans.set(vid);
+    return removeCollectedPorts();
+}
+
+Result::Value VlanLinkStatusHandling::reconfigureOnLinkChange(const PortBitmap& linkedUpPorts, const PortBitmap& linkedDownPorts) {
+    ++_statistics.linkEvents;
+    Result::Value result = Result::Value::Success;
+    if (not linkedDownPorts.empty()) {
+        _linkedUpPorts.subtract(linkedDownPorts);
+        VlanBitmap vlans {};
+        for (const auto portNo : linkedDownPorts) {
+            vlans |= _programmedVlansOfPort[portNo];
+        }
+
+        for (const auto vid : vlans) {
+            collectProgrammedPorts(vid, linkedDownPorts);
+        }
+
+        result = removeCollectedPorts();
+    }
+
+    if (not linkedUpPorts.empty()) {
+        _linkedUpPorts |= linkedUpPorts;
+        VlanBitmap vlans {};
+        for (const auto portNo : linkedUpPorts) {
+            for (const auto& configuredVlans : _configuredVlansOfPort[portNo]) {
+                vlans |= configuredVlans;
+            }
+        }
+
+        for (const auto vid : vlans & _createdVlans) {
+            collectPortsToAdd(vid, linkedUpPorts);
+        }
+
+        if (Result::Failed(addCollectedPorts())) {
+            result = Result::Value::Fail;
+        }
+    }
+
+    return result;
+}
+
+Result::Value VlanLinkStatusHandling::reconfigureOnLinkStatus() {
+    PortBitmap linkedUpPorts {};
+    PortBitmap linkedDownPorts {};
+    for (PortId portNo = 0; portNo < MaxPorts; ++portNo) {
+        const opennsl_port_t hwPort = HwPort::Mapping::panelPortToHwPort(portNo);
+        if (OpenNos::HwPortMapping::InvalidHwPort == hwPort) {
+            continue;
+        }
+
+        int linkStatus = OPENNSL_PORT_LINK_STATUS_DOWN;
+        const int rv = opennsl_port_link_status_get(HwPort::Mapping::panelPortToHwUnit(portNo), hwPort, &linkStatus);
+        if (OPENNSL_FAILURE(rv)) {
+            // Mapped port doesn't have to exist in ASIC, e.g. lane of not broken out port
+            continue;
+        }
+
+        (OPENNSL_PORT_LINK_STATUS_UP == linkStatus ? linkedUpPorts : linkedDownPorts).set(portNo);
+    }
+
+    return reconfigureOnLinkChange(linkedUpPorts, linkedDownPorts);
+}
+
+Result::Value VlanLinkStatusHandling::setCommitted(const VlanBitmap& createdVlans, const HwVlanMemberPortsSetting::Handle& memberPortsSetting,
+                                                  const VlanBitmap& destroyedVlans) {
+    static const std::vector<HwVlanMemberPortsSetting::Change> noChanges {};
+    if (not memberPortsSetting) {
+        return applyCommit(createdVlans, noChanges, _linkedUpPorts, false, destroyedVlans);
+    }
+
+    return applyCommit(createdVlans, memberPortsSetting->getChanges(), memberPortsSetting->getLinkedUpPorts(), false, destroyedVlans);
+}
+
+Result::Value VlanLinkStatusHandling::setReverted(const VlanBitmap& createdVlans, const HwVlanMemberPortsSetting::Handle& memberPortsSetting,
+                                                 const VlanBitmap& destroyedVlans) {
+    static const std::vector<HwVlanMemberPortsSetting::Change> noChanges {};
+    // Reverting has destroyed VLANs created by the commit and created again these destroyed by it
+    if (not memberPortsSetting) {
+        return applyCommit(destroyedVlans, noChanges, _linkedUpPorts, true, createdVlans);
+    }
+
+    return applyCommit(destroyedVlans, memberPortsSetting->getChanges(), memberPortsSetting->getLinkedUpPorts(), true, createdVlans);
+}
+
+const VlanBitmap& VlanLinkStatusHandling::getConfiguredVlansOfPort(const PortId portNo, const VlanPortRole role) const {
+    static const VlanBitmap noVlans {};
+    if ((not PortBitmap::isValid(portNo)) || (VlanPortRole::Count == role)) {
+        return noVlans;
+    }
+
+    return _configuredVlansOfPort[portNo][toIndex(role)];
+}
+
+bool VlanLinkStatusHandling::isPortProgrammed(const VlanId vid, const PortId portNo, const VlanPortRole role) const {
+    if ((not VlanBitmap::isValid(vid)) || (VlanPortRole::Count == role)) {
+        return false;
+    }
+
+    return _vlanPorts[vid].programmed[toIndex(role)].test(portNo);
+}
+
+Result::Value VlanLinkStatusHandling::applyCommit(const VlanBitmap& createdVlans, const std::vector<HwVlanMemberPortsSetting::Change>& changes,
+                                                 const PortBitmap& programmedPorts, const bool reverted, const VlanBitmap& destroyedVlans) {
+    _createdVlans |= createdVlans;
+    VlanBitmap changedVlans { createdVlans };
+    for (const auto& change : changes) {
+        setMemberPorts(change.vid, reverted ? change.after : change.before, reverted ? change.before : change.after, programmedPorts);
+        changedVlans.set(change.vid);
+    }
+
+    // Destroyed VLAN has taken all its ports with it
+    for (const auto vid : destroyedVlans) {
+        auto& vlanPorts = _vlanPorts[vid];
+        for (auto& programmedPorts : vlanPorts.programmed) {
+            for (const auto portNo : programmedPorts) {
+                _programmedVlansOfPort[portNo].reset(vid);
+            }
+
+            programmedPorts.clear();
+        }
+    }
+
+    _createdVlans.subtract(destroyedVlans);
+    changedVlans &= _createdVlans;
+    PortBitmap linkedDownPorts {};
+    linkedDownPorts.setRange(0, static_cast<PortId>(MaxPorts - 1));
+    linkedDownPorts.subtract(_linkedUpPorts);
+    for (const auto vid : changedVlans) {
+        collectProgrammedPorts(vid, linkedDownPorts);
+    }
+
+    Result::Value result = removeCollectedPorts();
+    for (const auto vid : changedVlans) {
+        collectPortsToAdd(vid, _linkedUpPorts);
+    }
+
+    if (Result::Failed(addCollectedPorts())) {
+        result = Result::Value::Fail;
+    }
+
+    return result;
+}
+
+void VlanLinkStatusHandling::setMemberPorts(const VlanId vid, const VlanMemberPorts& from, const VlanMemberPorts& to,
+                                            const PortBitmap& programmedPorts) {
+    auto& vlanPorts = _vlanPorts[vid];
+    const VlanMemberPorts programmedFrom { from.tagged & programmedPorts, from.untagged & programmedPorts };
+    const VlanMemberPorts programmedTo { to.tagged & programmedPorts, to.untagged & programmedPorts };
+    const PortBitmap removedPorts { programmedFrom.getMembers() - programmedTo.getMembers() };
+    for (auto& programmedPorts : vlanPorts.programmed) {
+        programmedPorts.subtract(removedPorts);
+    }
+
+    for (const auto portNo : removedPorts) {
+        _programmedVlansOfPort[portNo].reset(vid);
+    }
+
+    const PortBitmap addedUntaggedPorts { programmedTo.untagged - programmedFrom.untagged };
+    const PortBitmap addedTaggedPorts { programmedTo.tagged - programmedFrom.tagged };
+    auto& accessPorts = vlanPorts.programmed[toIndex(VlanPortRole::Access)];
+    auto& trunkPorts = vlanPorts.programmed[toIndex(VlanPortRole::Trunk)];
+    accessPorts = (accessPorts & programmedTo.untagged) | addedUntaggedPorts;
+    trunkPorts = (trunkPorts & programmedTo.tagged) | addedTaggedPorts;
+    for (const auto portNo : addedUntaggedPorts | addedTaggedPorts) {
+        _programmedVlansOfPort[portNo].set(vid);
+    }
+
+    setConfiguredPorts(vid, VlanPortRole::Access, to.untagged);
+    setConfiguredPorts(vid, VlanPortRole::Trunk, to.tagged);
+}
+
+void VlanLinkStatusHandling::setConfiguredPorts(const VlanId vid, const VlanPortRole role, const PortBitmap& ports) {
+    auto& configuredPorts = _vlanPorts[vid].configured[toIndex(role)];
+    for (const auto portNo : configuredPorts - ports) {
+        _configuredVlansOfPort[portNo][toIndex(role)].reset(vid);
+    }
+
+    for (const auto portNo : ports - configuredPorts) {
+        _configuredVlansOfPort[portNo][toIndex(role)].set(vid);
+    }
+
+    configuredPorts = ports;
+}
+
+void VlanLinkStatusHandling::collectPortsToAdd(const VlanId vid, const PortBitmap& ports) {
+    const auto& vlanPorts = _vlanPorts[vid];
+    auto& collectedPorts = _collectedPorts[vid];
+    for (size_t role = 0; role < RolesCount; ++role) {
+        collectedPorts[role] = (vlanPorts.configured[role] & ports) - vlanPorts.programmed[role];
+    }
+
+    _collectedVlans.set(vid);
+}
+
+void VlanLinkStatusHandling::collectProgrammedPorts(const VlanId vid, const PortBitmap& ports) {
+    const auto& vlanPorts = _vlanPorts[vid];
+    auto& collectedPorts = _collectedPorts[vid];
+    for (size_t role = 0; role < RolesCount; ++role) {
+        collectedPorts[role] = vlanPorts.programmed[role] & ports;
+    }
+
+    _collectedVlans.set(vid);
+}
+
+Result::Value VlanLinkStatusHandling::addCollectedPorts() {
+    const int hwUnit = Asic::getDefaultHwUnit();
+    Result::Value result = Result::Value::Success;
+    for (const auto vid : _collectedVlans) {
+        auto& collectedPorts = _collectedPorts[vid];
+        PortBitmap ports {};
+        for (const auto& rolePorts : collectedPorts) {
+            ports |= rolePorts;
+        }
+
+        if (ports.empty()) {
+            continue;
+        }
+
+        // Adding of tagged role mustn't re-tag port which is already untagged member by its other role
+        auto& vlanPorts = _vlanPorts[vid];
+        const PortBitmap programmedUntaggedPorts { getUntaggedPorts(vlanPorts.programmed) };
+        const PortBitmap untaggedPorts { getUntaggedPorts(collectedPorts) | (programmedUntaggedPorts & ports) };
+        // Tagged member which gets untagged role is re-tagged
+        PortBitmap programmedPorts {};
+        for (const auto& rolePorts : vlanPorts.programmed) {
+            programmedPorts |= rolePorts;
+        }
+
+        const PortBitmap retaggedPorts { (untaggedPorts & programmedPorts) - programmedUntaggedPorts };
+
+        opennsl_pbmp_t hwPorts;
+        opennsl_pbmp_t hwUntaggedPorts;
+        opennsl_pbmp_t hwRetaggedPorts;
+        HwVlanMemberPortsSetting::toHwPortBitmap(ports, hwPorts);
+        HwVlanMemberPortsSetting::toHwPortBitmap(untaggedPorts, hwUntaggedPorts);
+        HwVlanMemberPortsSetting::toHwPortBitmap(retaggedPorts, hwRetaggedPorts);
+        const bool retaggingInPlace = HwVlanPortRetagging::isInPlace(hwUnit);
+        int rv = OPENNSL_E_NONE;
+        if ((not retaggedPorts.empty()) && (not retaggingInPlace)) {
+            rv = opennsl_vlan_port_remove(hwUnit, vid, hwRetaggedPorts);
+            countSdkCall(rv);
+        }
+
+        if (OPENNSL_SUCCESS(rv)) {
+            rv = opennsl_vlan_port_add(hwUnit, vid, hwPorts, hwUntaggedPorts);
+            countSdkCall(rv);
+        }
+
+        if (OPENNSL_SUCCESS(rv) && (not retaggedPorts.empty()) && retaggingInPlace) {
+            rv = HwVlanPortRetagging::verifyInPlace(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+        }
+
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to add ports to VLAN %hu: %s (%d)", vid, opennsl_errmsg(rv), rv));
+            result = Result::Value::Fail;
+            continue;
+        }
+
+        for (const auto portNo : collectedPorts[toIndex(VlanPortRole::NativeTagged)]) {
+            rv = opennsl_port_untagged_vlan_set(hwUnit, HwPort::Mapping::panelPortToHwPort(portNo), vid);
+            countSdkCall(rv);
+            if (OPENNSL_FAILURE(rv)) {
+                ERROR_LOG(stringFormat("Failed to set native VLAN %hu of port %hu: %s (%d)", vid, portNo, opennsl_errmsg(rv), rv));
+                result = Result::Value::Fail;
+            }
+        }
+
+        for (size_t role = 0; role < RolesCount; ++role) {
+            vlanPorts.programmed[role] |= collectedPorts[role];
+        }
+
+        for (const auto portNo : ports) {
+            _programmedVlansOfPort[portNo].set(vid);
+        }
+
+        ++_statistics.reprogrammedVlans;
+    }
+
+    _collectedVlans.clear();
+    return result;
+}
+
+Result::Value VlanLinkStatusHandling::removeCollectedPorts() {
+    const int hwUnit = Asic::getDefaultHwUnit();
+    Result::Value result = Result::Value::Success;
+    for (const auto vid : _collectedVlans) {
+        auto& collectedPorts = _collectedPorts[vid];
+        auto& vlanPorts = _vlanPorts[vid];
+        PortBitmap ports {};
+        for (size_t role = 0; role < RolesCount; ++role) {
+            vlanPorts.programmed[role].subtract(collectedPorts[role]);
+            ports |= collectedPorts[role];
+        }
+
+        if (ports.empty()) {
+            continue;
+        }
+
+        // Port can stay member of VLAN by its other role (e.g. subinterface)
+        PortBitmap stillProgrammedPorts {};
+        for (const auto& programmedPorts : vlanPorts.programmed) {
+            stillProgrammedPorts |= programmedPorts;
+        }
+
+        for (const auto portNo : collectedPorts[toIndex(VlanPortRole::NativeTagged)]) {
+            const int rv = opennsl_port_untagged_vlan_set(hwUnit, HwPort::Mapping::panelPortToHwPort(portNo), OPENNSL_VLAN_DEFAULT);
+            countSdkCall(rv);
+            if (OPENNSL_FAILURE(rv)) {
+                ERROR_LOG(stringFormat("Failed to clear native VLAN of port %hu: %s (%d)", portNo, opennsl_errmsg(rv), rv));
+                result = Result::Value::Fail;
+            }
+        }
+
+        // Port which has lost its untagged role and stays member only by tagged roles has to be re-tagged
+        const PortBitmap retaggedPorts { (getUntaggedPorts(collectedPorts) & stillProgrammedPorts) - getUntaggedPorts(vlanPorts.programmed) };
+        if (not retaggedPorts.empty()) {
+            opennsl_pbmp_t hwRetaggedPorts;
+            opennsl_pbmp_t hwUntaggedPorts;
+            HwVlanMemberPortsSetting::toHwPortBitmap(retaggedPorts, hwRetaggedPorts);
+            OPENNSL_PBMP_CLEAR(hwUntaggedPorts);
+            const int rv = HwVlanPortRetagging::retag(hwUnit, vid, hwRetaggedPorts, hwUntaggedPorts);
+            countSdkCall(rv);
+            if (OPENNSL_FAILURE(rv)) {
+                ERROR_LOG(stringFormat("Failed to re-tag ports of VLAN %hu: %s (%d)", vid, opennsl_errmsg(rv), rv));
+                result = Result::Value::Fail;
+            }
+        }
+
+        ports.subtract(stillProgrammedPorts);
+        for (const auto portNo : ports) {
+            _programmedVlansOfPort[portNo].reset(vid);
+        }
+
+        ++_statistics.reprogrammedVlans;
+        if (ports.empty()) {
+            continue;
+        }
+
+        opennsl_pbmp_t hwPorts;
+        HwVlanMemberPortsSetting::toHwPortBitmap(ports, hwPorts);
+        const int rv = opennsl_vlan_port_remove(hwUnit, vid, hwPorts);
+        countSdkCall(rv);
+        if (OPENNSL_FAILURE(rv)) {
+            ERROR_LOG(stringFormat("Failed to remove ports from VLAN %hu: %s (%d)", vid, opennsl_errmsg(rv), rv));
+            result = Result::Value::Fail;
+        }
+    }
+
+    _collectedVlans.clear();
+    return result;
+}
+
+PortBitmap VlanLinkStatusHandling::getUntaggedPorts(const PortsByRole& portsByRole) {
+    return portsByRole[toIndex(VlanPortRole::Access)] | portsByRole[toIndex(VlanPortRole::NativeUntagged)];
+}
+
+void VlanLinkStatusHandling::countSdkCall(const int rv) {
+    ++_statistics.sdkCalls;
+    if (OPENNSL_FAILURE(rv)) {
+        ++_statistics.failedSdkCalls;
+    }
+}
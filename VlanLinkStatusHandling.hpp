@@ -0,0 +1,123 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "HwCommandProcessor.hpp"
+#include "HwVlan.hpp"
+#include "Observer.hpp"
+#include "VlanMembership.hpp"
+
+#include <array>
+#include <vector>
+
+/// Role of port in VLAN. Access, Trunk, NativeTagged and NativeUntagged exclude each other,
+/// Subinterface can be combined with any of them.
+enum class VlanPortRole : uint8_t {
+    Access,         // Untagged member
+    Trunk,          // Tagged member
+    NativeTagged,   // Tagged member and VLAN is also port's native VLAN
+    NativeUntagged, // Untagged member, VLAN is native VLAN of trunk
+    Subinterface,   // Tagged member used by L3 subinterface
+    Count
+};
+
+/// Keeps ports programmed in ASIC VLANs only while their link is up. Configured VLANs of each port
+/// are indexed by role, so link change visits only VLANs the port belongs to. Ports from one link
+/// event are gathered per VLAN, so each VLAN is programmed by one SDK call regardless of number
+/// of ports which changed link status.
+/// Access and trunk roles follow member ports committed by VlanManager, other roles are configured
+/// directly. All ASIC changes are done in ASIC thread: link events are passed there by update() and
+/// VlanManager applies its commits there, so ASIC and handling are never out of sync.
+class VlanLinkStatusHandling final : public Observer, public std::enable_shared_from_this<VlanLinkStatusHandling> {
+  public:
+    using Handle = std::shared_ptr<VlanLinkStatusHandling>;
+    struct Statistics {
+        uint64_t linkEvents;
+        uint64_t reprogrammedVlans;
+        uint64_t sdkCalls;
+        uint64_t failedSdkCalls;
+    };
+
+    explicit VlanLinkStatusHandling(HwCommandProcessor::Handle hwCommandProcessor);
+    virtual ~VlanLinkStatusHandling() override = default;
+    virtual ObserverId hash() override;
+    virtual void update(const ObservedSubjectHandle& subject, const UpdateReason updateReason) override;
+    /// Queues reconfiguration of VLANs to ASIC thread, doesn't wait for it
+    virtual void updateLinkStatus(const ObservedSubjectHandle& subject, const LinkEventBatch::Handle& linkEvents) override;
+    /// Queues reading of link status of all ports to ASIC thread, doesn't wait for it.
+    /// Link events report only changes, so this has to be done once when handling starts.
+    void syncLinkStatus();
+
+    // Methods below program ASIC, so they have to be called in ASIC thread (see HwCommandProcessor)
+
+    /// Ports are programmed only into created VLANs
+    /// @note Has to be called with @p created equal to false before VLAN is destroyed in ASIC
+    Result::Value setVlanCreated(const VlanId vid, const bool created);
+    Result::Value addPortRole(const VlanId vid, const PortId portNo, const VlanPortRole role);
+    Result::Value removePortRole(const VlanId vid, const PortId portNo, const VlanPortRole role);
+    /// Removes ports which link went down from their VLANs and adds to VLANs ports which link went up
+    Result::Value reconfigureOnLinkChange(const PortBitmap& linkedUpPorts, const PortBitmap& linkedDownPorts);
+    /// Reads link status of ports from ASIC and reconfigures VLANs of ports which link is up
+    Result::Value reconfigureOnLinkStatus();
+    /// Takes over VLANs and member ports which ASIC has just programmed by VLAN commit, then removes
+    /// ports which link is down and adds ports of other roles into created VLANs.
+    /// Untagged member ports get access role and tagged ones trunk role.
+    /// @param memberPortsSetting can be null if commit hasn't changed any member ports
+    Result::Value setCommitted(const VlanBitmap& createdVlans, const HwVlanMemberPortsSetting::Handle& memberPortsSetting,
+                               const VlanBitmap& destroyedVlans);
+    /// The same as setCommitted() once ASIC has reverted the commit
+    Result::Value setReverted(const VlanBitmap& createdVlans, const HwVlanMemberPortsSetting::Handle& memberPortsSetting,
+                              const VlanBitmap& destroyedVlans);
+
+    const VlanBitmap& getConfiguredVlansOfPort(const PortId portNo, const VlanPortRole role) const;
+    bool isPortProgrammed(const VlanId vid, const PortId portNo, const VlanPortRole role) const;
+    /// VLAN commit programs only these ports, see HwVlanMemberPortsSetting::setLinkedUpPorts()
+    const PortBitmap& getLinkedUpPorts() const { return _linkedUpPorts; }
+    Statistics getStatistics() const { return _statistics; }
+
+  private:
+    static constexpr size_t RolesCount = static_cast<size_t>(VlanPortRole::Count);
+    using PortsByRole = std::array<PortBitmap, RolesCount>;
+    struct VlanPorts {
+        PortsByRole configured;
+        PortsByRole programmed;
+    };
+
+    /// @param createdVlans VLANs which ASIC has created, @p destroyedVlans these which it has destroyed
+    /// @param programmedPorts ports which member ports setting has programmed, others are only configured
+    Result::Value applyCommit(const VlanBitmap& createdVlans, const std::vector<HwVlanMemberPortsSetting::Change>& changes,
+                              const PortBitmap& programmedPorts, const bool reverted, const VlanBitmap& destroyedVlans);
+    /// ASIC has removed ports which aren't members anymore, added new and re-tagged members of @p programmedPorts
+    void setMemberPorts(const VlanId vid, const VlanMemberPorts& from, const VlanMemberPorts& to, const PortBitmap& programmedPorts);
+    void setConfiguredPorts(const VlanId vid, const VlanPortRole role, const PortBitmap& ports);
+    void collectPortsToAdd(const VlanId vid, const PortBitmap& ports);
+    void collectProgrammedPorts(const VlanId vid, const PortBitmap& ports);
+    /// Programs ports collected in _collectedPorts with one SDK call per VLAN
+    Result::Value addCollectedPorts();
+    Result::Value removeCollectedPorts();
+    void countSdkCall(const int rv);
+    /// Port of untagged role is untagged member of VLAN, port of other roles only is tagged member
+    static PortBitmap getUntaggedPorts(const PortsByRole& portsByRole);
+
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    std::vector<VlanPorts> _vlanPorts; // Indexed by VID
+    std::vector<std::array<VlanBitmap, RolesCount>> _configuredVlansOfPort; // Indexed by port no.
+    std::vector<VlanBitmap> _programmedVlansOfPort; // Indexed by port no.
+    VlanBitmap _createdVlans;
+    PortBitmap _linkedUpPorts;
+    std::vector<PortsByRole> _collectedPorts; // Indexed by VID, valid only for VIDs in _collectedVlans
+    VlanBitmap _collectedVlans;
+    Statistics _statistics;
+};
@@ -14,84 +14,233 @@
 
 #include "VlanManager.hpp"
 
-#define OPS_VLAN_MIN       0
-#define OPS_VLAN_MAX       4095
-#define OPS_VLAN_COUNT     (OPS_VLAN_MAX - OPS_VLAN_MIN + 1)
-#define OPS_VLAN_VALID(v)  ((v)>OPS_VLAN_MIN && (v)<OPS_VLAN_MAX)
-
-VlanManager::VlanManager(PortManager::Handle& portManager, LagManager::Handle& lagManager)
-    : _portManager { portManager }, _lagManager { lagManager } {
-    /* Nothing more to do */
+#include "LoggingFacility.hpp"
+
+namespace {
+
+/// Programs VLAN commit and passes it to link status handling by one run of ASIC thread, so link
+/// events handled in between never see VLANs which differ from ASIC
+class LinkStatusSyncedCommit final : public UndoableCommand {
+  public:
+    LinkStatusSyncedCommit(CommitScheduler::Handle commitScheduler, VlanLinkStatusHandling::Handle linkStatusHandling,
+                           const VlanBitmap& createdVlans, HwVlanMemberPortsSetting::Handle memberPortsSetting,
+                           const VlanBitmap& destroyedVlans)
+        : _commitScheduler { std::move(commitScheduler) }, _linkStatusHandling { std::move(linkStatusHandling) },
+          _createdVlans { createdVlans }, _memberPortsSetting { std::move(memberPortsSetting) }, _destroyedVlans { destroyedVlans } {
+        // Nothing more to do
+    }
+
+    virtual ~LinkStatusSyncedCommit() override = default;
+    virtual size_t getCommitOrderingResolve() const override { return CommitOrderingResolve::Unordered; }
+    /// Whole commit is reverted if ports can't be reconfigured by link status
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override {
+        setLinkedUpPorts();
+        if (Result::Failed(_commitScheduler->execute())) {
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        if (Result::Failed(_linkStatusHandling->setCommitted(_createdVlans, _memberPortsSetting, _destroyedVlans))) {
+            ERROR_LOG("Failed to reconfigure VLANs by link status");
+            undo();
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override {
+        // Links could change since commit, ASIC has only ports which are linked up now
+        setLinkedUpPorts();
+        if (Result::Failed(_commitScheduler->undo())) {
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        // Macro evaluates its argument more than once, so handling mustn't be updated inside it
+        const auto result = _linkStatusHandling->setReverted(_createdVlans, _memberPortsSetting, _destroyedVlans);
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+    }
+
+  private:
+    void setLinkedUpPorts() {
+        if (_memberPortsSetting) {
+            _memberPortsSetting->setLinkedUpPorts(_linkStatusHandling->getLinkedUpPorts());
+        }
+    }
+
+    CommitScheduler::Handle _commitScheduler;
+    VlanLinkStatusHandling::Handle _linkStatusHandling;
+    VlanBitmap _createdVlans;
+    HwVlanMemberPortsSetting::Handle _memberPortsSetting;
+    VlanBitmap _destroyedVlans;
+};
+
+} // namespace
+
+VlanManager::VlanManager(PortManager::Handle& portManager, LagManager::Handle& lagManager, HwCommandProcessor::Handle hwCommandProcessor,
+                         EventBus::Handle eventBus)
+    : _portManager { portManager }, _lagManager { lagManager }, _hwCommandProcessor { hwCommandProcessor },
+      _memberPortManager { std::make_shared<VlanMemberPortManager>(hwCommandProcessor) },
+      _linkStatusHandling { std::make_shared<VlanLinkStatusHandling>(hwCommandProcessor) } {
+    Observer::Handle linkStatusObserver { _linkStatusHandling };
+    _portManager->addLinkStatusObserver(linkStatusObserver, eventBus);
+    // Ports could link up before observer was added, their events won't come again
+    _linkStatusHandling->syncLinkStatus();
+}
+
+Result::Value VlanManager::addRange(const VlanBitmap& vids) {
+    // Default VLAN always exists in ASIC, creating it would fail whole range
+    if (vids.test(DefaultVid)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    _toRemoving.subtract(vids);
+    _toAdding |= vids - _configured;
+    return Result::Value::Success;
 }
 
-void
-vlan_reconfig_on_link_change(int unit, opennsl_port_t hw_port, int link_is_up)
-{
-    int vid, count;
-    opennsl_pbmp_t pbm;
-    ops_vlan_data_t *vlanp;
-
-    OPENNSL_PBMP_CLEAR(pbm);
-    OPENNSL_PBMP_PORT_ADD(pbm, hw_port);
-
-    for (vid=0, count=0; vid<OPS_VLAN_COUNT && count<ops_vlan_count; vid++) {
-        if (ops_vlans[vid] != NULL) {
-            count++;
-            vlanp = ops_vlans[vid];
-            if (vlanp->hw_created) {
-                if (link_is_up) {
-                    // Link has come up.
-                    if (OPENNSL_PBMP_MEMBER(vlanp->cfg_access_ports[unit], hw_port)) {
-                        hw_add_ports_to_vlan(unit, pbm, pbm, vid, 1);
-                        OPENNSL_PBMP_OR(vlanp->hw_access_ports[unit], pbm);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->cfg_trunk_ports[unit], hw_port)) {
-                        hw_add_ports_to_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_OR(vlanp->hw_trunk_ports[unit], pbm);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->cfg_native_tag_ports[unit], hw_port)) {
-                        hw_add_ports_to_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_OR(vlanp->hw_native_tag_ports[unit], pbm);
-                        native_vlan_set(unit, vid, pbm, 0);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->cfg_native_untag_ports[unit], hw_port)) {
-                        hw_add_ports_to_vlan(unit, pbm, pbm, vid, 0);
-                        OPENNSL_PBMP_OR(vlanp->hw_native_untag_ports[unit], pbm);
-
-                    }
-
-                    if (OPENNSL_PBMP_MEMBER(vlanp->cfg_subinterface_ports[unit], hw_port)) {
-                        hw_add_ports_to_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_OR(vlanp->hw_subinterface_ports[unit], pbm);
-                    }
-                } else {
-                    // Link has gone down.
-                    if (OPENNSL_PBMP_MEMBER(vlanp->hw_access_ports[unit], hw_port)) {
-                        hw_del_ports_from_vlan(unit, pbm, pbm, vid, 1);
-                        OPENNSL_PBMP_PORT_REMOVE(vlanp->hw_access_ports[unit], hw_port);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->hw_trunk_ports[unit], hw_port)) {
-                        hw_del_ports_from_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_PORT_REMOVE(vlanp->hw_trunk_ports[unit], hw_port);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->hw_native_tag_ports[unit], hw_port)) {
-                        hw_del_ports_from_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_PORT_REMOVE(vlanp->hw_native_tag_ports[unit], hw_port);
-                        native_vlan_clear(unit, pbm, 0);
-
-                    } else if (OPENNSL_PBMP_MEMBER(vlanp->hw_native_untag_ports[unit], hw_port)) {
-                        hw_del_ports_from_vlan(unit, pbm, pbm, vid, 0);
-                        OPENNSL_PBMP_PORT_REMOVE(vlanp->hw_native_untag_ports[unit], hw_port);
-
-                    }
-
-                    if (OPENNSL_PBMP_MEMBER(vlanp->hw_subinterface_ports[unit], hw_port)) {
-                        hw_del_ports_from_vlan(unit, pbm, g_empty_pbm, vid, 0);
-                        OPENNSL_PBMP_PORT_REMOVE(vlanp->hw_subinterface_ports[unit], hw_port);
-                    }
-                }
+Result::Value VlanManager::removeRange(const VlanBitmap& vids) {
+    _toAdding.subtract(vids);
+    _toRemoving |= vids & _configured;
+    return Result::Value::Success;
+}
+
+Result::Value VlanManager::addRangeMemberPorts(const VlanBitmap& vids, const VlanMemberPorts& ports) {
+    return _memberPortManager->addMemberPorts(vids, ports);
+}
+
+Result::Value VlanManager::removeRangeMemberPorts(const VlanBitmap& vids, const PortBitmap& ports) {
+    return _memberPortManager->removeMemberPorts(vids, ports);
+}
+
+Result::Value VlanManager::execute(ResultCallback::Handle& callback) {
+    _mementoCommit.reset();
+    _mementoMemberPortsSetting.reset();
+    const VlanBitmap vidsToCreate { _toAdding };
+    const VlanBitmap vidsToDestroy { _toRemoving };
+    // Member ports of destroyed VLANs are removed by the same commit, so VLAN created again starts empty
+    PortBitmap allPorts {};
+    allPorts.setRange(0, static_cast<PortId>(MaxPorts - 1));
+    _memberPortManager->removeMemberPorts(vidsToDestroy, allPorts);
+    auto memberPortsSetting = _memberPortManager->takePendingChanges();
+    auto commitScheduler = std::make_shared<CommitScheduler>();
+    if (not vidsToCreate.empty()) {
+        commitScheduler->addCommand(std::make_shared<HwVlanRangeSetting>(HwVlanRangeSetting::Action::Create, vidsToCreate));
+    }
+
+    if (memberPortsSetting) {
+        commitScheduler->addCommand(memberPortsSetting);
+    }
+
+    if (not vidsToDestroy.empty()) {
+        commitScheduler->addCommand(std::make_shared<HwVlanRangeSetting>(HwVlanRangeSetting::Action::Destroy, vidsToDestroy));
+    }
+
+    // Only mementos of previous commit are cleared, so there is nothing to be undone
+    if ((not memberPortsSetting) && vidsToCreate.empty() && vidsToDestroy.empty()) {
+        const auto result = CommandManager::execute(gNullResultCallback);
+        CALL_CALLBACK_AND_RETURN_RESULT_IF_FAIL_OR_SUCCESS(result, callback);
+    }
+
+    // Scheduler reverts commands it has already executed if any of them fails, so on failure
+    // ASIC is left as it was and software state is not touched
+    UndoableCommand::Handle commit = std::make_shared<LinkStatusSyncedCommit>(commitScheduler, _linkStatusHandling, vidsToCreate,
+                                                                               memberPortsSetting, vidsToDestroy);
+    if (Result::Failed(_hwCommandProcessor->executeAndWait(commit))) {
+        ERROR_LOG("Failed to program VLANs");
+        // ASIC is left as it was, so whole configuration stays pending for next commit
+        if (memberPortsSetting) {
+            _memberPortManager->restorePendingChanges(*memberPortsSetting);
+        }
+
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    // ASIC is programmed, software follows it
+    for (const auto vid : vidsToDestroy) {
+        if (auto vlan = get(getHandle(vid))) {
+            vlan->destroy();
+        }
+    }
+
+    // On failure base class has already restored VLAN objects by undo(), which has no memento of
+    // this commit yet, so only ASIC and VLANs which haven't been removed are left to be reverted
+    if (Result::Failed(CommandManager::execute(gNullResultCallback))) {
+        if (Result::Failed(_hwCommandProcessor->undoAndWait(commit))) {
+            ERROR_LOG("Failed to revert VLANs in ASIC");
+        }
+
+        for (const auto vid : vidsToDestroy) {
+            auto vlan = get(getHandle(vid));
+            if (vlan && (not vlan->isCreated())) {
+                vlan->create();
             }
         }
+
+        // Base class has cleared pending VLANs
+        _toAdding = vidsToCreate;
+        _toRemoving = vidsToDestroy;
+        if (memberPortsSetting) {
+            _memberPortManager->restorePendingChanges(*memberPortsSetting);
+        }
+
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    if (memberPortsSetting) {
+        _memberPortManager->setCommitted(*memberPortsSetting);
     }
 
-} // vlan_reconfig_on_link_change
+    for (const auto vid : _mementoAdded) {
+        get(getHandle(vid))->create();
+    }
+
+    _mementoCommit = std::move(commit);
+    _mementoMemberPortsSetting = std::move(memberPortsSetting);
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+Result::Value VlanManager::undo(ResultCallback::Handle& callback) {
+    Result::Value result = Result::Value::Success;
+    if (_mementoCommit) {
+        // Software follows ASIC only if whole commit has been reverted there
+        if (Result::Failed(_hwCommandProcessor->undoAndWait(_mementoCommit))) {
+            ERROR_LOG("Failed to revert VLANs in ASIC");
+            _mementoCommit.reset();
+            _mementoMemberPortsSetting.reset();
+            CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+        }
+
+        if (_mementoMemberPortsSetting) {
+            _memberPortManager->setReverted(*_mementoMemberPortsSetting);
+        }
+    }
+
+    _mementoCommit.reset();
+    _mementoMemberPortsSetting.reset();
+    if (Result::Failed(restoreVlans())) {
+        result = Result::Value::Fail;
+    }
+
+    callback->onCommandResult(result);
+    return result;
+}
+
+Result::Value VlanManager::restoreVlans() {
+    // Base undo() clears mementos
+    const VlanBitmap createdVlans { _mementoAdded };
+    const VlanBitmap destroyedVlans { _mementoRemoved };
+    for (const auto vid : createdVlans) {
+        if (auto vlan = get(getHandle(vid))) {
+            vlan->destroy();
+        }
+    }
+
+    const Result::Value result = CommandManager::undo(gNullResultCallback);
+    for (const auto vid : destroyedVlans) {
+        if (auto vlan = get(getHandle(vid))) {
+            vlan->create();
+        }
+    }
+
+    return result;
+}
@@ -15,15 +15,57 @@
 #pragma once
 
 #include "Command.hpp"
+#include "CommitScheduler.hpp"
+#include "EventBus.hpp"
+#include "HwCommandProcessor.hpp"
 #include "LagManager.hpp"
 #include "PortManager.hpp"
 #include "Vlan.hpp"
+#include "VlanLinkStatusHandling.hpp"
+#include "VlanMemberPortManager.hpp"
 
-class VlanManager final : public CommandManager<Vlan, Vlan::Id, Vlan::Handle> {
+/// Besides per-VID add() and remove() VLANs and their member ports can be configured in ranges, like
+/// "vlan 2-4000 on ports 1-64 tagged". Whatever is configured until execute() is programmed by one
+/// commit: all created VLANs by one command, member ports by one command and all destroyed VLANs
+/// by one command. CommitScheduler orders them and the whole commit is passed to ASIC thread by one
+/// queue operation. The same run of ASIC thread passes the commit to link status handling, which
+/// keeps member ports in ASIC VLANs only while their link is up.
+class VlanManager final : public CommandManager<Vlan, Vlan::Id, DenseCommandStorage<MaxVlans>> {
   public:
-    inline VlanManager(PortManager::Handle& portManager, LagManager::Handle& lagManager);
+    using Handle = std::shared_ptr<VlanManager>;
+    /// Exists in ASIC since its initialization, it is never created nor destroyed
+    static constexpr VlanId DefaultVid = 1;
+    /// Link status handling is updated by workers of @p eventBus if passed, otherwise by link scan notifier
+    VlanManager(PortManager::Handle& portManager, LagManager::Handle& lagManager, HwCommandProcessor::Handle hwCommandProcessor,
+                EventBus::Handle eventBus = nullptr);
+    /// Schedules creation of all VLANs of @p vids, VLANs which already exist are skipped
+    /// @retval Result::Value::AlreadyExists if @p vids contain default VLAN, then nothing is scheduled
+    Result::Value addRange(const VlanBitmap& vids);
+    /// Schedules destruction of all VLANs of @p vids, VLANs which don't exist are skipped
+    Result::Value removeRange(const VlanBitmap& vids);
+    /// Adds @p ports to all VLANs of @p vids. Tagging mode of ports which are already members is replaced.
+    Result::Value addRangeMemberPorts(const VlanBitmap& vids, const VlanMemberPorts& ports);
+    Result::Value removeRangeMemberPorts(const VlanBitmap& vids, const PortBitmap& ports);
+    /// Programs the commit in ASIC thread and waits for the result. VLAN objects and committed member
+    /// ports are changed only after ASIC has been programmed. Member ports of destroyed VLANs are
+    /// removed before VLANs are destroyed in ASIC. On failure the configuration stays pending, so
+    /// it can be executed again.
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override;
+    VlanMemberPortManager::Handle& getMemberPortManager() { return _memberPortManager; }
+    VlanLinkStatusHandling::Handle& getLinkStatusHandling() { return _linkStatusHandling; }
 
   private:
+    /// Reverts VLAN objects created and destroyed by last execute(), ASIC is left untouched
+    Result::Value restoreVlans();
+
     PortManager::Handle _portManager;
     LagManager::Handle _lagManager;
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    VlanMemberPortManager::Handle _memberPortManager;
+    /// Adds ports into ASIC VLANs when their link goes up and removes them when link goes down
+    VlanLinkStatusHandling::Handle _linkStatusHandling;
+    /// Memento of last commit, which has been programmed in ASIC
+    UndoableCommand::Handle _mementoCommit;
+    HwVlanMemberPortsSetting::Handle _mementoMemberPortsSetting;
 };
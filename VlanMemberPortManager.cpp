@@ -0,0 +1,164 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "VlanMemberPortManager.hpp"
+
+VlanMemberPortManager::VlanMemberPortManager(HwCommandProcessor::Handle hwCommandProcessor)
+    : _hwCommandProcessor { hwCommandProcessor }, _pendingMemberPorts(MaxVlans) {
+    // Nothing more to do
+}
+
+Result::Value VlanMemberPortManager::addMemberPort(const VlanId vid, const PortId portNo, const bool tagged) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if (not PortBitmap::isValid(portNo)) {
+        return Result::Value::PortNotExists;
+    }
+
+    auto& memberPorts = getPendingMemberPorts(vid);
+    auto& addTo = tagged ? memberPorts.tagged : memberPorts.untagged;
+    if (addTo.test(portNo)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    addTo.set(portNo);
+    (tagged ? memberPorts.untagged : memberPorts.tagged).reset(portNo);
+    return Result::Value::Success;
+}
+
+Result::Value VlanMemberPortManager::removeMemberPort(const VlanId vid, const PortId portNo) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    auto& memberPorts = getPendingMemberPorts(vid);
+    if (not (memberPorts.tagged.test(portNo) || memberPorts.untagged.test(portNo))) {
+        return Result::Value::PortInVlanNotExists;
+    }
+
+    memberPorts.tagged.reset(portNo);
+    memberPorts.untagged.reset(portNo);
+    return Result::Value::Success;
+}
+
+Result::Value VlanMemberPortManager::addMemberPorts(const VlanBitmap& vids, const VlanMemberPorts& ports) {
+    // Tagged wins if caller passed port in both bitmaps
+    const PortBitmap untagged { ports.untagged - ports.tagged };
+    for (const auto vid : vids) {
+        auto& memberPorts = getPendingMemberPorts(vid);
+        memberPorts.tagged.subtract(untagged) |= ports.tagged;
+        memberPorts.untagged.subtract(ports.tagged) |= untagged;
+    }
+
+    return Result::Value::Success;
+}
+
+Result::Value VlanMemberPortManager::removeMemberPorts(const VlanBitmap& vids, const PortBitmap& ports) {
+    for (const auto vid : vids) {
+        auto& memberPorts = getPendingMemberPorts(vid);
+        memberPorts.tagged.subtract(ports);
+        memberPorts.untagged.subtract(ports);
+    }
+
+    return Result::Value::Success;
+}
+
+size_t VlanMemberPortManager::getCommitOrderingResolve() const {
+    return CommitOrderingResolve::VlanAddMemberPorts;
+}
+
+Result::Value VlanMemberPortManager::execute(ResultCallback::Handle& callback) {
+    _mementoSetting.reset();
+    auto hwVlanMemberPortsSetting = takePendingChanges();
+    if (not hwVlanMemberPortsSetting) {
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+    if (Result::Failed(_hwCommandProcessor->executeAndWait(hwVlanMemberPortsSetting))) {
+        ERROR_LOG("Failed to program VLAN member ports");
+        restorePendingChanges(*hwVlanMemberPortsSetting);
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    setCommitted(*hwVlanMemberPortsSetting);
+    _mementoSetting = std::move(hwVlanMemberPortsSetting);
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+Result::Value VlanMemberPortManager::undo(ResultCallback::Handle& callback) {
+    _pendingVlans.clear();
+    if (not _mementoSetting) {
+        CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+    }
+
+    // Setting restores all VLANs it can even if some of them fail, so ASIC matches table only on success
+    if (Result::Failed(_hwCommandProcessor->undoAndWait(_mementoSetting))) {
+        ERROR_LOG("Failed to restore VLAN member ports");
+        CALL_CALLBACK_AND_RETURN_RESULT_FAIL(callback);
+    }
+
+    setReverted(*_mementoSetting);
+    _mementoSetting.reset();
+    CALL_CALLBACK_AND_RETURN_RESULT_SUCCESS(callback);
+}
+
+HwVlanMemberPortsSetting::Handle VlanMemberPortManager::takePendingChanges() {
+    std::vector<HwVlanMemberPortsSetting::Change> changes {};
+    changes.reserve(_pendingVlans.size());
+    for (const auto vid : _pendingVlans) {
+        const auto& committedMemberPorts = _committedMemberPorts.getMemberPorts(vid);
+        if (committedMemberPorts != _pendingMemberPorts[vid]) {
+            changes.push_back({ vid, committedMemberPorts, _pendingMemberPorts[vid] });
+        }
+    }
+
+    _pendingVlans.clear();
+    if (changes.empty()) {
+        return nullptr;
+    }
+
+    return std::make_shared<HwVlanMemberPortsSetting>(std::move(changes));
+}
+
+void VlanMemberPortManager::restorePendingChanges(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting) {
+    for (const auto& change : hwVlanMemberPortsSetting.getChanges()) {
+        if (not _pendingVlans.test(change.vid)) {
+            _pendingMemberPorts[change.vid] = change.after;
+            _pendingVlans.set(change.vid);
+        }
+    }
+}
+
+void VlanMemberPortManager::setCommitted(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting) {
+    for (const auto& change : hwVlanMemberPortsSetting.getChanges()) {
+        _committedMemberPorts.setMemberPorts(change.vid, change.after);
+    }
+}
+
+void VlanMemberPortManager::setReverted(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting) {
+    for (const auto& change : hwVlanMemberPortsSetting.getChanges()) {
+        _committedMemberPorts.setMemberPorts(change.vid, change.before);
+    }
+}
+
+VlanMemberPorts& VlanMemberPortManager::getPendingMemberPorts(const VlanId vid) {
+    if (not _pendingVlans.test(vid)) {
+        _pendingMemberPorts[vid] = _committedMemberPorts.getMemberPorts(vid);
+        _pendingVlans.set(vid);
+    }
+
+    return _pendingMemberPorts[vid];
+}
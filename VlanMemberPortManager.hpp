@@ -0,0 +1,65 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Command.hpp"
+#include "HwCommandProcessor.hpp"
+#include "HwVlan.hpp"
+#include "VlanMembership.hpp"
+
+#include <vector>
+
+/// Collects changes of VLAN member ports and commits them to ASIC. Changes are applied to the
+/// target membership of touched VLANs, so adding and then removing the same port before commit
+/// costs nothing in ASIC. Only VLANs whose membership really changed are programmed, each of them
+/// by at most one SDK call per direction (see HwVlanMemberPortsSetting). Committed member ports
+/// follow ASIC: they are changed only after ASIC thread has programmed the changes.
+class VlanMemberPortManager final : public UndoableCommand {
+  public:
+    using Handle = std::shared_ptr<VlanMemberPortManager>;
+    explicit VlanMemberPortManager(HwCommandProcessor::Handle hwCommandProcessor);
+    virtual ~VlanMemberPortManager() override = default;
+    Result::Value addMemberPort(const VlanId vid, const PortId portNo, const bool tagged);
+    Result::Value removeMemberPort(const VlanId vid, const PortId portNo);
+    /// Adds @p ports to all VLANs of @p vids. Tagging mode of ports which are already members is replaced.
+    Result::Value addMemberPorts(const VlanBitmap& vids, const VlanMemberPorts& ports);
+    Result::Value removeMemberPorts(const VlanBitmap& vids, const PortBitmap& ports);
+    virtual size_t getCommitOrderingResolve() const override;
+    /// Programs pending changes in ASIC thread and waits for the result. If ASIC fails, the setting
+    /// reverts already programmed VLANs and committed member ports are left unchanged.
+    virtual Result::Value execute(ResultCallback::Handle& callback = gNullResultCallback) override;
+    virtual Result::Value undo(ResultCallback::Handle& callback = gNullResultCallback) override;
+    const VlanMembershipTable& getCommittedMemberPorts() const { return _committedMemberPorts; }
+    /// Moves pending changes into setting, which is not passed to ASIC thread. Committed member ports
+    /// aren't changed until setCommitted() is called for the setting.
+    /// @return nullptr if membership of none of VLANs has changed
+    HwVlanMemberPortsSetting::Handle takePendingChanges();
+    /// Makes changes of @p hwVlanMemberPortsSetting pending again once ASIC has failed to program them,
+    /// so they are programmed by next commit. VLANs changed since the setting was taken keep newer changes.
+    void restorePendingChanges(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting);
+    /// Makes changes of @p hwVlanMemberPortsSetting committed once ASIC has programmed them
+    void setCommitted(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting);
+    /// Restores member ports committed before @p hwVlanMemberPortsSetting once ASIC has reverted it
+    void setReverted(const HwVlanMemberPortsSetting& hwVlanMemberPortsSetting);
+
+  private:
+    VlanMemberPorts& getPendingMemberPorts(const VlanId vid);
+
+    HwCommandProcessor::Handle _hwCommandProcessor;
+    VlanMembershipTable _committedMemberPorts;
+    std::vector<VlanMemberPorts> _pendingMemberPorts; // Indexed by VID, valid only for VIDs in _pendingVlans
+    VlanBitmap _pendingVlans;
+    HwVlanMemberPortsSetting::Handle _mementoSetting;
+};
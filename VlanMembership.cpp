@@ -0,0 +1,163 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "VlanMembership.hpp"
+
+VlanMembershipTable::VlanMembershipTable()
+    : _memberPorts(MaxVlans), _vlansOfPort(MaxPorts) {
+    // Nothing more to do
+}
+
+Result::Value VlanMembershipTable::addMemberPort(const VlanId vid, const PortId portNo, const bool tagged) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if (not PortBitmap::isValid(portNo)) {
+        return Result::Value::PortNotExists;
+    }
+
+    auto& memberPorts = _memberPorts[vid];
+    auto& addTo = tagged ? memberPorts.tagged : memberPorts.untagged;
+    auto& removeFrom = tagged ? memberPorts.untagged : memberPorts.tagged;
+    if (addTo.test(portNo)) {
+        return Result::Value::AlreadyExists;
+    }
+
+    addTo.set(portNo);
+    removeFrom.reset(portNo);
+    _vlansOfPort[portNo].set(vid);
+    _vlansWithMemberPorts.set(vid);
+    return Result::Value::Success;
+}
+
+Result::Value VlanMembershipTable::removeMemberPort(const VlanId vid, const PortId portNo) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    if (not isMemberPort(vid, portNo)) {
+        return Result::Value::PortInVlanNotExists;
+    }
+
+    auto& memberPorts = _memberPorts[vid];
+    memberPorts.tagged.reset(portNo);
+    memberPorts.untagged.reset(portNo);
+    _vlansOfPort[portNo].reset(vid);
+    if (memberPorts.empty()) {
+        _vlansWithMemberPorts.reset(vid);
+    }
+
+    return Result::Value::Success;
+}
+
+Result::Value VlanMembershipTable::addMemberPorts(const VlanId vid, const VlanMemberPorts& ports) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    VlanMemberPorts memberPorts { _memberPorts[vid] };
+    memberPorts.tagged.subtract(ports.untagged) |= ports.tagged;
+    memberPorts.untagged.subtract(ports.tagged) |= ports.untagged;
+    return setMemberPorts(vid, memberPorts);
+}
+
+Result::Value VlanMembershipTable::removeMemberPorts(const VlanId vid, const PortBitmap& ports) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    VlanMemberPorts memberPorts { _memberPorts[vid] };
+    memberPorts.tagged.subtract(ports);
+    memberPorts.untagged.subtract(ports);
+    return setMemberPorts(vid, memberPorts);
+}
+
+Result::Value VlanMembershipTable::setMemberPorts(const VlanId vid, const VlanMemberPorts& ports) {
+    if (not VlanBitmap::isValid(vid)) {
+        return Result::Value::VlanNotExists;
+    }
+
+    auto& memberPorts = _memberPorts[vid];
+    const PortBitmap membersBefore { memberPorts.getMembers() };
+    memberPorts = ports;
+    // Tagged wins if caller passed port in both bitmaps
+    memberPorts.untagged.subtract(memberPorts.tagged);
+    updateVlansOfPorts(vid, membersBefore, memberPorts.getMembers());
+    return Result::Value::Success;
+}
+
+void VlanMembershipTable::removePortFromAllVlans(const PortId portNo) {
+    if (not PortBitmap::isValid(portNo)) {
+        return;
+    }
+
+    for (const auto vid : _vlansOfPort[portNo]) {
+        auto& memberPorts = _memberPorts[vid];
+        memberPorts.tagged.reset(portNo);
+        memberPorts.untagged.reset(portNo);
+        if (memberPorts.empty()) {
+            _vlansWithMemberPorts.reset(vid);
+        }
+    }
+
+    _vlansOfPort[portNo].clear();
+}
+
+void VlanMembershipTable::clear() {
+    for (const auto vid : _vlansWithMemberPorts) {
+        _memberPorts[vid] = VlanMemberPorts {};
+    }
+
+    for (auto& vlans : _vlansOfPort) {
+        vlans.clear();
+    }
+
+    _vlansWithMemberPorts.clear();
+}
+
+bool VlanMembershipTable::isMemberPort(const VlanId vid, const PortId portNo) const {
+    if (not VlanBitmap::isValid(vid)) {
+        return false;
+    }
+
+    const auto& memberPorts = _memberPorts[vid];
+    return memberPorts.tagged.test(portNo) || memberPorts.untagged.test(portNo);
+}
+
+const VlanMemberPorts& VlanMembershipTable::getMemberPorts(const VlanId vid) const {
+    static const VlanMemberPorts noMemberPorts {};
+    return VlanBitmap::isValid(vid) ? _memberPorts[vid] : noMemberPorts;
+}
+
+const VlanBitmap& VlanMembershipTable::getVlansOfPort(const PortId portNo) const {
+    static const VlanBitmap noVlans {};
+    return PortBitmap::isValid(portNo) ? _vlansOfPort[portNo] : noVlans;
+}
+
+void VlanMembershipTable::updateVlansOfPorts(const VlanId vid, const PortBitmap& membersBefore, const PortBitmap& membersAfter) {
+    for (const auto portNo : membersAfter - membersBefore) {
+        _vlansOfPort[portNo].set(vid);
+    }
+
+    for (const auto portNo : membersBefore - membersAfter) {
+        _vlansOfPort[portNo].reset(vid);
+    }
+
+    if (membersAfter.empty()) {
+        _vlansWithMemberPorts.reset(vid);
+    } else {
+        _vlansWithMemberPorts.set(vid);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright 2020 - Present | Pawel Maslanka (pawmas.pawelmaslanka@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Bitmap.hpp"
+#include "Types.hpp"
+
+#include <vector>
+
+using PortBitmap = Bitmap<MaxPorts, PortId>;
+using VlanBitmap = Bitmap<MaxVlans, VlanId>;
+
+/// Member ports of VLAN. Port is either tagged or untagged member, so both bitmaps are disjoint.
+/// When programmed by opennsl_vlan_port_add(), getMembers() is passed as pbmp and untagged as ubmp.
+struct VlanMemberPorts {
+    PortBitmap tagged;
+    PortBitmap untagged;
+
+    PortBitmap getMembers() const { return tagged | untagged; }
+    bool empty() const { return tagged.empty() && untagged.empty(); }
+    bool operator==(const VlanMemberPorts& other) const { return (tagged == other.tagged) && (untagged == other.untagged); }
+    bool operator!=(const VlanMemberPorts& other) const { return not (*this == other); }
+};
+
+/// Membership of ports in all VLANs. Member ports are kept in dense table indexed by VID and each port
+/// has its reverse bitmap of VLANs, so "ports of VLAN" and "VLANs of port" are answered without search,
+/// and bulk changes are applied word by word.
+class VlanMembershipTable final {
+  public:
+    VlanMembershipTable();
+    /// Adds port to VLAN or changes its tagging mode
+    /// @retval Result::Value::AlreadyExists if port is already member with the same tagging mode
+    Result::Value addMemberPort(const VlanId vid, const PortId portNo, const bool tagged);
+    Result::Value removeMemberPort(const VlanId vid, const PortId portNo);
+    /// Adds ports to VLAN. Tagging mode of ports which are already members is replaced.
+    Result::Value addMemberPorts(const VlanId vid, const VlanMemberPorts& ports);
+    Result::Value removeMemberPorts(const VlanId vid, const PortBitmap& ports);
+    /// Replaces all member ports of VLAN
+    Result::Value setMemberPorts(const VlanId vid, const VlanMemberPorts& ports);
+    void removePortFromAllVlans(const PortId portNo);
+    void clear();
+
+    bool isMemberPort(const VlanId vid, const PortId portNo) const;
+    const VlanMemberPorts& getMemberPorts(const VlanId vid) const;
+    const VlanBitmap& getVlansOfPort(const PortId portNo) const;
+    const VlanBitmap& getVlansWithMemberPorts() const { return _vlansWithMemberPorts; }
+
+  private:
+    void updateVlansOfPorts(const VlanId vid, const PortBitmap& membersBefore, const PortBitmap& membersAfter);
+
+    std::vector<VlanMemberPorts> _memberPorts; // Indexed by VID
+    std::vector<VlanBitmap> _vlansOfPort; // Indexed by port no.
+    VlanBitmap _vlansWithMemberPorts;
+};